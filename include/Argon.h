@@ -58,6 +58,12 @@ struct array {
   size_t size;
 };
 
+struct dictionary {
+  ArgonObject **keys;
+  ArgonObject **values;
+  size_t size;
+};
+
 struct ArgonNativeAPI {
   void (*register_ArgonObject)(ArgonObjectRegister *reg, char *name,
                                ArgonObject *obj);
@@ -144,6 +150,17 @@ struct ArgonNativeAPI {
   void (*remove_from_hashmap_string_key)(ArgonHashmap *hashmap, char *key);
 
   ArgonObject *(*create_argon_array)(ArgonObject ** array, size_t size);
+
+  // entries in insertion order
+  struct dictionary (*argon_to_dictionary)(ArgonObject *, ArgonError *);
+  // parses a decimal literal such as "-1.5e3" into an exact number
+  ArgonObject *(*string_to_number)(struct string, ArgonError *);
+  ArgonObject *(*repr)(ArgonObject *, ArgonError *, ArgonState *);
+  // a buffer over memory the module allocated itself, such as a mapping.
+  // release is called with the same data and size once it is collected.
+  ArgonObject *(*create_argon_buffer_external)(void *data, size_t size,
+                                               void (*release)(void *data,
+                                                               size_t size));
 };
 
 #define ARGON_STRING_FROM_C_STRING(str)                                        \
@@ -34,6 +34,10 @@ typedef enum ArgonType {
   TYPE_TUPLE_ITERATOR,
   TYPE_DICTIONARY_ITERATOR,
   TYPE_SLICE,
+  TYPE_STRING_BUILDER,
+  TYPE_TYPED_ARRAY,
+  TYPE_TYPED_ARRAY_ITERATOR,
+  TYPE_LAZY_ITERATOR,
 } ArgonType;
 
 #ifdef __cplusplus
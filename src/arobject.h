@@ -94,7 +94,19 @@
   X(starts_with)                                                               \
   X(ends_with)                                                                 \
   X(from_byte)                                                                 \
-  X(to_byte)
+  X(to_byte)                                                                   \
+  X(builder)                                                                   \
+  X(i64)                                                                       \
+  X(f64)                                                                       \
+  X(u8)                                                                        \
+  X(sum)                                                                       \
+  X(min)                                                                       \
+  X(max)                                                                       \
+  X(dot)                                                                       \
+  X(to_buffer)                                                                 \
+  X(parallel_map)                                                              \
+  X(parallel_filter)                                                           \
+  X(parallel_reduce)
 
 typedef enum {
 #define X(name) name,
@@ -154,6 +166,8 @@ struct string_struct {
   uint64_t hash;
   char *data;
   size_t length;
+  // set when data is the start of a growable concatenation buffer
+  struct string_buffer *buffer;
 };
 
 typedef struct Stack {
@@ -172,6 +186,10 @@ struct argon_function_struct {
   uint8_t *bytecode;
   size_t bytecode_length;
   Stack *stack;
+  // table of contents in the constant arena, the parameter names below are
+  // only decoded from it on the first call. NULL once decoded, and only set
+  // to NULL (with release ordering) after the fields below are filled in.
+  _Atomic(uint8_t *) toc;
   size_t number_of_parameters;
   struct string_struct *parameters;
   size_t number_of_default_parameters;
@@ -229,6 +247,53 @@ struct as_dictionary_iterator {
   struct node_GC **array;
 };
 
+// element kinds of a typed array, ordered so the wider kind compares greater.
+typedef enum {
+  TYPED_ARRAY_U8,
+  TYPED_ARRAY_I64,
+  TYPED_ARRAY_F64,
+} typed_array_kind;
+
+// raw machine values, boxed only when an element is read.
+struct typed_array {
+  typed_array_kind kind;
+  size_t length;
+  size_t capacity;
+  void *data;         // may be shared with a buffer
+  ArgonObject *owner; // the buffer data came from, kept alive with it
+};
+
+struct as_typed_array_iterator {
+  size_t current;
+  ArgonObject *array;
+};
+
+// the stages of a lazy iterator pipeline, see iter.map and friends.
+typedef enum {
+  LAZY_MAP,
+  LAZY_FILTER,
+  LAZY_TAKE,
+  LAZY_SKIP,
+  LAZY_ZIP,
+  LAZY_ENUMERATE,
+  LAZY_CHAIN,
+  LAZY_CHUNK,
+  LAZY_WINDOW,
+} lazy_iterator_kind;
+
+struct as_lazy_iterator {
+  lazy_iterator_kind kind;
+  bool done;
+  ArgonObject *fn;
+  size_t source_count;
+  size_t current_source;
+  ArgonObject **sources; // iterators, already past __iter__
+  ArgonObject **nexts;   // their __next__, for sources without a fast path
+  int64_t count;         // items left, items to skip, next index or size
+  ArgonObject **window;
+  size_t window_length;
+};
+
 struct tuple_struct {
   size_t size;
   ArgonObject *data[];
@@ -256,8 +321,12 @@ struct ArgonObject {
     struct as_tuple_iterator *as_tuple_iterator;
     struct as_dictionary_iterator *as_dictionary_iterator;
     struct string_struct *as_str;
+    ArgonObject *as_string_builder;
     struct tuple_struct as_tuple;
     struct buffer *as_buffer;
+    struct typed_array *as_typed_array;
+    struct as_typed_array_iterator *as_typed_array_iterator;
+    struct as_lazy_iterator *as_lazy_iterator;
     darray_armem *as_array;
     native_fn native_fn;
     struct argon_function_struct *argon_fn;
@@ -17,8 +17,10 @@
 #include "runtime/objects/dictionary/dictionary.h"
 #include "runtime/objects/exceptions/exceptions.h"
 #include "runtime/objects/literals/literals.h"
+#include "runtime/objects/object.h"
 #include "runtime/objects/string/string.h"
 #include "runtime/runtime.h"
+#include "snapshot.h"
 #include "translator/translator.h"
 #include <limits.h>
 #include <stdbool.h>
@@ -110,7 +112,7 @@ ArgonObject *EXC_ARGON;
 const char CACHE_FOLDER[] = "__arcache__";
 const char FILE_IDENTIFIER[] = "ARBI";
 #define BYTECODE_EXTENTION "bin"
-const uint32_t bytecode_version_number = 5;
+const uint32_t bytecode_version_number = 8;
 
 bool file_exists(const char *path) {
   struct stat st;
@@ -318,6 +320,11 @@ Translated load_argon_file(char *path, ArErr *err) {
       snprintf(cache_file_path, sizeof(cache_file_path),
                "%s/%s." BYTECODE_EXTENTION, cache_folder_path, basename);
   bool can_use_cache = written > 0 && written < (int)sizeof(cache_file_path);
+
+  Translated translated;
+  if (snapshot_load_module(&translated, path) == 0)
+    goto LOADED;
+
   FILE *file = fopen(path, "r");
   if (!file) {
     *err = create_err(FileError, "Unable to open file '%s'", path);
@@ -336,92 +343,39 @@ Translated load_argon_file(char *path, ArErr *err) {
   uint64_t hash = XXH3_64bits_digest(hash_state);
   XXH3_freeState(hash_state);
 
-  Translated translated;
-
   if (can_use_cache &&
       load_cache(&translated, cache_file_path, hash, path) != 0) {
 
+    // lex, parse and translate one top level statement at a time, so peak
+    // memory is bounded by the largest statement rather than the whole file
     DArray tokens;
     darray_init(&tokens, sizeof(Token));
-
-    // Seek to end to get file size
-    if (fseek(file, 0, SEEK_END) != 0) {
-      *err =
-          create_err(FileError, "Unable determine the files size: fseek", path);
-      fclose(file);
-      return (Translated){};
-    }
-
-    long size = ftell(file);
-    if (size < 0) {
-      *err =
-          create_err(FileError, "Unable determine the files size: ftell", path);
-      fclose(file);
-      return (Translated){};
-    }
-    rewind(file); // go back to the beginning
-                  // Allocate buffer (+1 for NUL terminator)
-    char *buffer = malloc(size + 1);
-    if (!buffer) {
-      *err = create_err(FileError, "Unable determine the files content: malloc",
-                        path);
-      fclose(file);
-      return (Translated){};
-    }
-
-    // Read the file
-    size_t read = fread(buffer, 1, size, file);
-    if (read != (size_t)size) {
-      *err = create_err(FileError, "Unable determine the files content: fread",
-                        path);
-      free(buffer);
-      fclose(file);
-      return (Translated){};
-    }
-    buffer[size] = '\0'; // NUL terminate
-    fclose(file);
-
-    LexerState state = {path, buffer, 0, 0, {}, -1, &tokens};
-#ifdef ARGON_DEBUG
-    start = clock();
-#endif
-    *err = lexer(state);
-    if (is_error(err)) {
-      free(buffer);
-      darray_free(&tokens, free_token);
-      return (Translated){};
-    }
-#ifdef ARGON_DEBUG
-    end = clock();
-    time_spent = (double)(end - start) / CLOCKS_PER_SEC;
-    fprintf(stderr, "Lexer time taken: %f seconds\n", time_spent);
-#endif
-    free(buffer);
-
     DArray ast;
-
     darray_init(&ast, sizeof(ParsedValue));
 
 #ifdef ARGON_DEBUG
     start = clock();
 #endif
-    *err = parser(path, &ast, &tokens, false);
-    darray_free(&tokens, free_token);
-    if (is_error(err)) {
+    translated = init_translator(path);
+    LexerStream stream;
+    lexer_stream_init(&stream, path, file, &tokens);
+    while (!stream.finished) {
+      *err = lexer_stream_next(&stream);
+      if (!is_error(err))
+        *err = parser(path, &ast, &tokens, false);
+      darray_free(&tokens, free_token);
+      darray_init(&tokens, sizeof(Token));
+      if (!is_error(err))
+        *err = translate(&translated, &ast);
       darray_free(&ast, (void (*)(void *))free_parsed);
-      return (Translated){};
+      darray_init(&ast, sizeof(ParsedValue));
+      if (is_error(err))
+        break;
     }
-#ifdef ARGON_DEBUG
-    end = clock();
-    time_spent = (double)(end - start) / CLOCKS_PER_SEC;
-    fprintf(stderr, "Parser time taken: %f seconds\n", time_spent);
-
-    start = clock();
-#endif
-
-    translated = init_translator(path);
-    *err = translate(&translated, &ast);
-    darray_free(&ast, (void (*)(void *))free_parsed);
+    lexer_stream_free(&stream);
+    darray_free(&tokens, free_token);
+    darray_free(&ast, NULL);
+    fclose(file);
     if (is_error(err)) {
       darray_free(&translated.bytecode, NULL);
       free(translated.constants.data);
@@ -431,7 +385,7 @@ Translated load_argon_file(char *path, ArErr *err) {
 #ifdef ARGON_DEBUG
     end = clock();
     time_spent = (double)(end - start) / CLOCKS_PER_SEC;
-    fprintf(stderr, "Translation time taken: %f seconds\n", time_spent);
+    fprintf(stderr, "Compile time taken: %f seconds\n", time_spent);
 #endif
 #if defined(__linux__)
     malloc_trim(0);
@@ -479,6 +433,8 @@ Translated load_argon_file(char *path, ArErr *err) {
       }
     }
   }
+  snapshot_record_module(path, hash, &translated);
+LOADED:;
   char path_length = strlen(translated.path) + 1;
   char *path_alloc = ar_alloc_atomic(path_length);
   memcpy(path_alloc, translated.path, path_length);
@@ -608,8 +564,17 @@ Stack *ar_import(char *current_directory, char *path_relative, ArErr *err,
   char path_c[PATH_MAX];
   bool found = false;
 
+  // 0. Reuse the resolution recorded in a snapshot
+  char *snapshot_resolved =
+      snapshot_lookup_resolution(current_directory, path_relative);
+  if (snapshot_resolved && strlen(snapshot_resolved) < PATH_MAX) {
+    strcpy(path_c, snapshot_resolved);
+    found = true;
+  }
+
   // 1. Check relative to importing file
-  if (try_patterns(current_directory, path_relative, LOCAL_PATTERNS,
+  if (!found &&
+      try_patterns(current_directory, path_relative, LOCAL_PATTERNS,
                    sizeof(LOCAL_PATTERNS) / sizeof(PathPattern), path_c)) {
     found = true;
   }
@@ -650,6 +615,7 @@ Stack *ar_import(char *current_directory, char *path_relative, ArErr *err,
     *err = create_err(FileError, "Unable to find file '%s'", path_relative);
     return NULL;
   }
+  snapshot_record_resolution(current_directory, path_relative, path_c);
   uint64_t hash = siphash64_bytes(path_c, strlen(path_c), siphash_key_fixed);
   Stack *scope;
   if ((scope = hashmap_lookup_GC(imported_hash_table, hash)) != NULL) {
@@ -698,6 +664,10 @@ Stack *ar_import(char *current_directory, char *path_relative, ArErr *err,
                  new_string_object_null_terminated(current_directory));
   add_to_hashmap(program, "cwd", CWD_ARGON);
   add_to_hashmap(program, "exc", EXC_ARGON);
+  if (is_main)
+    add_to_hashmap(program, "ready",
+                   create_argon_native_function("ready",
+                                                ARGON_FUNC_ARGON_PROGRAM_READY));
 
   add_to_scope(program_scope, "program", create_dictionary(program));
   Stack *main_scope = create_scope(program_scope
@@ -15,6 +15,7 @@ extern ArgonObject *CWD_ARGON;
 extern ArgonObject *EXC_ARGON;
 extern int g_argc;
 extern char **g_argv;
+extern const uint32_t bytecode_version_number;
 
 int get_executable_path(char *path, size_t size);
 
@@ -11,6 +11,7 @@
 #include "lex.yy.h"
 #include "token.h"
 #include <stddef.h>
+#include <stdlib.h>
 
 size_t count_newlines(const char *str, size_t len) {
   size_t count = 0;
@@ -32,6 +33,31 @@ size_t chars_after_last_newline(const char *str, size_t len) {
   return len - (last_newline + 1);
 }
 
+static void advance_position(LexerState *state, int token,
+                             yyscan_t yyscanner) {
+  if (token == TOKEN_NEW_LINE) {
+    state->current_line += 1;
+    state->current_column = 0;
+  } else {
+    size_t newlines =
+        count_newlines(yyget_text(yyscanner), yyget_leng(yyscanner));
+    if (newlines) {
+      state->current_line += newlines;
+      state->current_column = chars_after_last_newline(yyget_text(yyscanner),
+                                                       yyget_leng(yyscanner));
+    } else {
+      state->current_column += yyget_leng(yyscanner);
+    }
+  }
+}
+
+static ArErr invalid_token_err(LexerState *state, yyscan_t yyscanner) {
+  return path_specific_create_err(
+      state->current_line + 1, state->current_column + 1,
+      yyget_leng(yyscanner), state->path, SyntaxError, "Invalid Token '%s'",
+      yyget_text(yyscanner));
+}
+
 ArErr lexer(LexerState state) {
 
   yyscan_t yyscanner;
@@ -45,10 +71,7 @@ ArErr lexer(LexerState state) {
   int token;
   while ((token = yylex(yyscanner)) != 0) {
     if (token == TOKEN_INVALID) {
-      ArErr err = path_specific_create_err(
-          state.current_line + 1, state.current_column + 1,
-          yyget_leng(yyscanner), state.path, SyntaxError,
-          "Invalid Token '%s'", yyget_text(yyscanner));
+      ArErr err = invalid_token_err(&state, yyscanner);
       yylex_destroy(yyscanner);
       return err;
     }
@@ -56,20 +79,128 @@ ArErr lexer(LexerState state) {
         (Token){token, state.current_line + 1, state.current_column + 1,
                 yyget_leng(yyscanner), cloneString(yyget_text(yyscanner))};
     darray_push(state.tokens, &token_struct);
-    if (token == TOKEN_NEW_LINE) {
-      state.current_line += 1;
-      state.current_column = 0;
-    } else {
-      size_t newlines =
-          count_newlines(yyget_text(yyscanner), yyget_leng(yyscanner));
-      if (newlines) {
-        state.current_line +=newlines;
-        state.current_column = chars_after_last_newline(yyget_text(yyscanner), yyget_leng(yyscanner));
-      } else {
-        state.current_column += yyget_leng(yyscanner);
-      }
-    }
+    advance_position(&state, token, yyscanner);
   }
   yylex_destroy(yyscanner);
   return no_err;
-}
\ No newline at end of file
+}
+
+void lexer_stream_init(LexerStream *stream, char *path, FILE *file,
+                       DArray *tokens) {
+  *stream = (LexerStream){0};
+  stream->state = (LexerState){path, NULL, 0, 0, {}, -1, tokens};
+  stream->last_significant = TOKEN_NEW_LINE;
+  yylex_init((yyscan_t *)&stream->scanner);
+  yyset_extra(&stream->state, stream->scanner);
+  yyset_in(file, stream->scanner);
+}
+
+void lexer_stream_free(LexerStream *stream) {
+  if (stream->has_pending) {
+    free(stream->pending.value);
+    stream->has_pending = false;
+  }
+  yylex_destroy(stream->scanner);
+}
+
+// tokens that can finish a statement, so a newline after them at the top
+// level is a statement boundary rather than a continuation.
+static bool ends_statement(int token) {
+  switch (token) {
+  case TOKEN_IDENTIFIER:
+  case TOKEN_NUMBER:
+  case TOKEN_STRING:
+  case TOKEN_TRUE:
+  case TOKEN_FALSE:
+  case TOKEN_NULL:
+  case TOKEN_RPAREN:
+  case TOKEN_RBRACKET:
+  case TOKEN_RBRACE:
+  case TOKEN_TEMPLATE_END:
+  case TOKEN_BREAK:
+  case TOKEN_CONTINUE:
+  case TOKEN_RETURN:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// tokens that begin a new statement at column 0. anything else, such as
+// `else` or `catch`, may continue the previous one.
+static bool starts_statement(int token) {
+  switch (token) {
+  case TOKEN_IDENTIFIER:
+  case TOKEN_LET:
+  case TOKEN_IF:
+  case TOKEN_WHILE:
+  case TOKEN_FOREVER:
+  case TOKEN_FOR:
+  case TOKEN_CLASS:
+  case TOKEN_IMPORT:
+  case TOKEN_TRY:
+  case TOKEN_THROW:
+  case TOKEN_DELETE:
+    return true;
+  default:
+    return false;
+  }
+}
+
+static void track_token(LexerStream *stream, int token) {
+  switch (token) {
+  case TOKEN_LPAREN:
+  case TOKEN_LBRACKET:
+  case TOKEN_LBRACE:
+  case TOKEN_TEMPLATE_START:
+  case TOKEN_TEMPLATE_EXPR_START:
+    stream->depth++;
+    break;
+  case TOKEN_RPAREN:
+  case TOKEN_RBRACKET:
+  case TOKEN_RBRACE:
+  case TOKEN_TEMPLATE_END:
+  case TOKEN_TEMPLATE_EXPR_END:
+    if (stream->depth)
+      stream->depth--;
+    break;
+  default:
+    break;
+  }
+  if (token == TOKEN_NEW_LINE) {
+    stream->after_new_line = true;
+    return;
+  }
+  stream->after_new_line = false;
+  if (token != TOKEN_INDENT)
+    stream->last_significant = token;
+}
+
+ArErr lexer_stream_next(LexerStream *stream) {
+  if (stream->has_pending) {
+    darray_push(stream->state.tokens, &stream->pending);
+    track_token(stream, stream->pending.type);
+    stream->has_pending = false;
+  }
+  int token;
+  while ((token = yylex(stream->scanner)) != 0) {
+    if (token == TOKEN_INVALID)
+      return invalid_token_err(&stream->state, stream->scanner);
+    Token token_struct = (Token){token, stream->state.current_line + 1,
+                                 stream->state.current_column + 1,
+                                 yyget_leng(stream->scanner),
+                                 cloneString(yyget_text(stream->scanner))};
+    advance_position(&stream->state, token, stream->scanner);
+    if (stream->depth == 0 && stream->after_new_line &&
+        ends_statement(stream->last_significant) && starts_statement(token) &&
+        stream->state.tokens->size) {
+      stream->pending = token_struct;
+      stream->has_pending = true;
+      return no_err;
+    }
+    darray_push(stream->state.tokens, &token_struct);
+    track_token(stream, token);
+  }
+  stream->finished = true;
+  return no_err;
+}
@@ -9,6 +9,8 @@
 
 #include "../arobject.h"
 #include "../dynamic_array/darray.h"
+#include "token.h"
+#include <stdbool.h>
 #include <stdio.h>
 #define TEMPLATE_STACK_MAX 64
 
@@ -25,4 +27,26 @@ typedef struct {
 
 ArErr lexer(LexerState state);
 
+// pulls tokens from a file one top level statement at a time, so the whole
+// source and token list never have to be held in memory at once.
+typedef struct {
+  LexerState state;
+  void *scanner;
+  Token pending;
+  bool has_pending;
+  bool finished;
+  size_t depth;
+  bool after_new_line;
+  int last_significant;
+} LexerStream;
+
+void lexer_stream_init(LexerStream *stream, char *path, FILE *file,
+                       DArray *tokens);
+
+// appends the tokens of the next top level statement to stream->state.tokens,
+// setting stream->finished once the end of the file is reached.
+ArErr lexer_stream_next(LexerStream *stream);
+
+void lexer_stream_free(LexerStream *stream);
+
 #endif // LEXER_H
\ No newline at end of file
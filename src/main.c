@@ -15,6 +15,7 @@
 #include "runtime/objects/string/string.h"
 #include "runtime/runtime.h"
 #include "shell.h"
+#include "snapshot.h"
 #include "version.h"
 
 #include <locale.h>
@@ -61,11 +62,49 @@ int main(int argc, char *argv[]) {
     printf("%s\n", VERSION);
     return 0;
   }
+  char *snapshot_file = NULL;
+  bool from_snapshot = false;
+  bool until_ready = false;
+  if (argc >= 2 && (strcmp(argv[1], "--snapshot") == 0 ||
+                    strcmp(argv[1], "--from-snapshot") == 0)) {
+    from_snapshot = strcmp(argv[1], "--from-snapshot") == 0;
+    if (argc < (from_snapshot ? 3 : 4)) {
+      fprintf(stderr, "usage: %s --snapshot <out.arsnap> <file> "
+                      "[--until-ready] [args...]\n"
+                      "       %s --from-snapshot <file.arsnap> [args...]\n",
+              argv[0], argv[0]);
+      return 1;
+    }
+    snapshot_file = argv[2];
+    // drop the snapshot flags so the program sees the usual `argon <file>`
+    // style arguments, with the main file filled in below for a replay
+    int skip = from_snapshot ? 1 : 2;
+    if (!from_snapshot && argc >= 5 && strcmp(argv[4], "--until-ready") == 0) {
+      until_ready = true;
+      argv[4] = argv[3];
+      skip = 3;
+    }
+    argv[skip] = argv[0];
+    argv += skip;
+    argc -= skip;
+    g_argc = argc;
+    g_argv = argv;
+  }
   setlocale(LC_ALL, "");
   ar_memory_init();
   // generate_siphash_key(siphash_key);
   init_built_in_field_hashes();
   bootstrap_types();
+  if (from_snapshot) {
+    ArErr err = {.ptr = ARGON_NULL};
+    argv[1] = snapshot_begin_replay(snapshot_file, &err);
+    if (is_error(&err)) {
+      output_err(&err);
+      return 1;
+    }
+  } else if (snapshot_file) {
+    snapshot_begin_record(snapshot_file, argv[1], until_ready);
+  }
   bootstrap_globals();
 
   imported_hash_table = createHashmap_GC();
@@ -95,6 +134,10 @@ int main(int argc, char *argv[]) {
     output_err(&err);
     return 1;
   }
+  if (snapshot_mode == SNAPSHOT_RECORD && snapshot_write() != 0) {
+    fprintf(stderr, "unable to write snapshot '%s'\n", snapshot_file);
+    return 1;
+  }
   ar_memory_shutdown();
   // Your main thread code
   return 0;
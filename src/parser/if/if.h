@@ -16,6 +16,8 @@ typedef struct {
 
 ParsedValueReturn parse_if(char *file, DArray *tokens, size_t *index);
 
+void free_conditional(void *ptr);
+
 void free_parsed_if(void *ptr);
 
 #endif // iF_H
\ No newline at end of file
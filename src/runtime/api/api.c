@@ -8,6 +8,7 @@
 #include "../../err.h"
 #include "../../hash_data/hash_data.h"
 #include "../../memory.h"
+#include "../../parser/number/number.h"
 #include "../call/call.h"
 #include "../objects/buffer/buffer.h"
 #include "../objects/array/array.h"
@@ -148,6 +149,52 @@ struct array argon_to_array(ArgonObject *obj, ArErr *err) {
   return (struct array){NULL, 0};
 }
 
+struct dictionary argon_to_dictionary(ArgonObject *obj, ArErr *err) {
+  if (obj->type != TYPE_DICTIONARY) {
+    throw_argon_error(err, RuntimeError, "expected dictionary");
+    return (struct dictionary){NULL, NULL, 0};
+  }
+  size_t length;
+  struct node_GC **nodes =
+      hashmap_GC_to_array(obj->value.as_hashmap, &length);
+  ArgonObject **keys = ar_alloc(length * 2 * sizeof(ArgonObject *));
+  ArgonObject **values = keys + length;
+  for (size_t i = 0; i < length; i++) {
+    keys[i] = nodes[i]->key;
+    values[i] = nodes[i]->val;
+  }
+  return (struct dictionary){keys, values, length};
+}
+
+ArgonObject *string_to_number(struct string str, ArErr *err) {
+  mpq_t r;
+  mpq_init(r);
+  if (mpq_set_decimal_str_exp(r, str.data, str.length) != 0) {
+    mpq_clear(r);
+    throw_argon_error(err, RuntimeError, "Unable to parse number");
+    return ARGON_NULL;
+  }
+  ArgonObject *object = new_number_object(r);
+  mpq_clear(r);
+  return object;
+}
+
+ArgonObject *api_repr(ArgonObject *obj, ArErr *err, RuntimeState *state) {
+  ArgonObject *repr_method = GET_METHOD_OF_OBJECT(obj, __repr__);
+  if (!repr_method) {
+    throw_argon_error(err, RuntimeError, "unable to get __repr__ from object");
+    return ARGON_NULL;
+  }
+  ArgonObject *result = argon_call(repr_method, 0, NULL, NULL, err, state);
+  if (is_error(err))
+    return ARGON_NULL;
+  if (result->type != TYPE_STRING) {
+    throw_argon_error(err, TypeError, "__repr__ returned non-string");
+    return ARGON_NULL;
+  }
+  return result;
+}
+
 int register_thread() {
   struct GC_stack_base sb;
   atomic_fetch_add(&thread_count, 1);
@@ -282,5 +329,10 @@ ArgonNativeAPI native_api = {
     .remove_from_hashmap_string_key = api_remove_entry_from_hashmap_string_key,
     .remove_from_hashmap = api_remove_entry_from_hashmap,
 
-    .create_argon_array = create_array
+    .create_argon_array = create_array,
+
+    .argon_to_dictionary = argon_to_dictionary,
+    .string_to_number = string_to_number,
+    .repr = api_repr,
+    .create_argon_buffer_external = create_ARGON_BUFFER_external,
 };
\ No newline at end of file
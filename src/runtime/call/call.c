@@ -10,6 +10,7 @@
 #include "../api/api.h"
 #include "../objects/dictionary/dictionary.h"
 #include "../objects/exceptions/exceptions.h"
+#include "../objects/functions/functions.h"
 #include "../objects/string/string.h"
 #include "../objects/tuple/tuple.h"
 #include <inttypes.h>
@@ -114,6 +115,7 @@ void run_call(ArgonObject *original_object, size_t argc, ArgonObject **argv,
   }
   switch (object->type) {
   case TYPE_FUNCTION: {
+    load_function_parameters(object->value.argon_fn);
     // ── build a "bound" bitset to track which parameters have been filled ──
     size_t n_params = object->value.argon_fn->number_of_parameters;
     bool *bound = checked_malloc(n_params * sizeof(bool));
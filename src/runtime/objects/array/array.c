@@ -13,6 +13,7 @@
 #include "../exceptions/exceptions.h"
 #include "../literals/literals.h"
 #include "../number/number.h"
+#include "parallel.h"
 #include "../slice/slice.h"
 #include "../string/string.h"
 #include <inttypes.h>
@@ -586,149 +587,311 @@ ARGON_METHOD(ARRAY_TYPE, filter, {
   return object;
 })
 
-static int argon_array_compare(ArgonObject **a, ArgonObject **b,
-                               ArgonObject *callback, ArgonNativeAPI *api,
-                               ArErr *err, void *state) {
-  ArgonObject *args[] = {*a, *b};
-  ArgonObject *result = api->call(callback, 2, args, NULL, err, state);
-  if (api->is_error(err))
-    return 0;
+/*
+ * sort is a stable adaptive merge sort in the style of timsort. natural runs
+ * are found first, strictly descending ones are reversed in place, short runs
+ * are padded out with a binary insertion sort, and runs are merged off a stack
+ * that keeps the merges balanced. already sorted input costs n - 1 compares.
+ *
+ * with key= each key is computed once and sorted alongside its value. with no
+ * comparator, keys that are all numbers or all strings are compared in C and
+ * anything else goes through __less_than__, so most sorts never call back
+ * into argon at all.
+ */
 
-  // Expect the callback to return a number (like JS: negative, 0, positive)
-  // Adjust this depending on how your numeric type works
-  if (result->type == TYPE_NUMBER) {
-    int64_t result_i64 = api->argon_to_i64(result, err);
-    return (result_i64 < 0) ? -1 : (result_i64 > 0) ? 1 : 0;
+typedef enum {
+  SORT_NUMBERS,
+  SORT_STRINGS,
+  SORT_LESS_THAN,
+  SORT_CALLBACK,
+} sort_mode;
+
+typedef struct {
+  ArgonObject *key;
+  ArgonObject *value;
+} sort_item;
+
+typedef struct {
+  size_t start;
+  size_t length;
+} sort_run;
+
+typedef struct {
+  sort_mode mode;
+  bool reverse;
+  ArgonObject *callback;
+  sort_item *buffer;
+  sort_run runs[128]; // enough for any length, the run lengths grow like fib
+  size_t run_count;
+  ArgonNativeAPI *api;
+  ArErr *err;
+  void *state;
+} sort_context;
+
+static int compare_numbers(struct as_number *a, struct as_number *b) {
+  if (a->is_int64 && b->is_int64)
+    return (a->n.i64 > b->n.i64) - (a->n.i64 < b->n.i64);
+  if (!a->is_int64 && !b->is_int64)
+    return mpq_cmp(*a->n.mpq, *b->n.mpq);
+  mpq_t other;
+  mpq_init(other);
+  int result;
+  if (a->is_int64) {
+    mpq_set_si64(other, a->n.i64, 1);
+    result = mpq_cmp(other, *b->n.mpq);
+  } else {
+    mpq_set_si64(other, b->n.i64, 1);
+    result = mpq_cmp(*a->n.mpq, other);
   }
+  mpq_clear(other);
+  return result;
+}
 
-  return 0;
+static int compare_strings(struct string_struct *a, struct string_struct *b) {
+  size_t length = a->length < b->length ? a->length : b->length;
+  int result = length ? memcmp(a->data, b->data, length) : 0;
+  if (result)
+    return result;
+  return (a->length > b->length) - (a->length < b->length);
 }
-static void argon_insertion_sort(ArgonObject **arr, size_t lo, size_t hi,
-                                 ArgonObject *callback, ArgonNativeAPI *api,
-                                 ArErr *err, void *state) {
-  for (size_t i = lo + 1; i <= hi; i++) {
-    ArgonObject *key = arr[i];
-    size_t j = i;
-    while (j > lo && argon_array_compare(&arr[j - 1], &key, callback, api, err,
-                                         state) > 0) {
-      if (api->is_error(err))
-        return;
-      arr[j] = arr[j - 1];
-      j--;
-    }
-    arr[j] = key;
+
+// the comparator returns a number, negative when a comes first.
+static int argon_array_compare(ArgonObject *a, ArgonObject *b,
+                               sort_context *ctx) {
+  ArgonObject *args[] = {a, b};
+  ArgonObject *result =
+      ctx->api->call(ctx->callback, 2, args, NULL, ctx->err, ctx->state);
+  if (ctx->api->is_error(ctx->err) || result->type != TYPE_NUMBER)
+    return 0;
+  if (result->value.as_number->is_int64) {
+    int64_t i64 = result->value.as_number->n.i64;
+    return (i64 > 0) - (i64 < 0);
   }
+  return mpq_sgn(*result->value.as_number->n.mpq);
 }
 
-static void argon_qsort(ArgonObject **arr, size_t lo, size_t hi,
-                        ArgonObject *callback, ArgonNativeAPI *api, ArErr *err,
-                        void *state) {
-  if (api->is_error(err))
-    return;
-
-  // Use insertion sort for small subarrays — also sidesteps the n<3 edge case
-  if (hi - lo < 16) {
-    argon_insertion_sort(arr, lo, hi, callback, api, err, state);
-    return;
+// true if a must come before b. everything the merge sort does is phrased in
+// terms of this, so equal keys are never moved past each other.
+static bool sort_less(sort_context *ctx, sort_item *a, sort_item *b) {
+  if (ctx->api->is_error(ctx->err))
+    return false;
+  if (ctx->reverse) {
+    sort_item *swap = a;
+    a = b;
+    b = swap;
+  }
+  switch (ctx->mode) {
+  case SORT_NUMBERS:
+    return compare_numbers(a->key->value.as_number,
+                           b->key->value.as_number) < 0;
+  case SORT_STRINGS:
+    return compare_strings(a->key->value.as_str, b->key->value.as_str) < 0;
+  case SORT_CALLBACK:
+    return argon_array_compare(a->key, b->key, ctx) < 0;
+  case SORT_LESS_THAN: {
+    ArgonObject *less_than = get_builtin_field_for_class(
+        get_builtin_field(a->key, __class__), __less_than__, a->key);
+    if (!less_than) {
+      ctx->api->throw_argon_error(ctx->err, TypeError,
+                                  "cannot sort values without __less_than__, "
+                                  "pass a comparator or key");
+      return false;
+    }
+    ArgonObject *result =
+        argon_call(less_than, 1, &b->key, NULL, ctx->err, ctx->state);
+    return !ctx->api->is_error(ctx->err) && result->as_bool;
   }
+  }
+  return false;
+}
 
-  // Median-of-three is now safe since we have at least 16 elements
-  size_t mid = lo + (hi - lo) / 2;
-  if (argon_array_compare(&arr[lo], &arr[mid], callback, api, err, state) > 0) {
-    ArgonObject *tmp = arr[lo];
-    arr[lo] = arr[mid];
-    arr[mid] = tmp;
+// sorts items[lo, hi) given that items[lo, start) is already sorted.
+static void binary_insertion_sort(sort_item *items, size_t lo, size_t start,
+                                  size_t hi, sort_context *ctx) {
+  for (size_t i = start; i < hi; i++) {
+    sort_item pivot = items[i];
+    size_t left = lo;
+    size_t right = i;
+    while (left < right) {
+      size_t mid = left + (right - left) / 2;
+      if (sort_less(ctx, &pivot, &items[mid]))
+        right = mid;
+      else
+        left = mid + 1;
+    }
+    memmove(&items[left + 1], &items[left], (i - left) * sizeof(sort_item));
+    items[left] = pivot;
   }
-  if (argon_array_compare(&arr[lo], &arr[hi], callback, api, err, state) > 0) {
-    ArgonObject *tmp = arr[lo];
-    arr[lo] = arr[hi];
-    arr[hi] = tmp;
+}
+
+// the length of the run at lo. a strictly descending run is reversed, which
+// keeps the sort stable since it has no equal neighbours.
+static size_t count_run(sort_item *items, size_t lo, size_t hi,
+                        sort_context *ctx) {
+  size_t i = lo + 1;
+  if (i == hi)
+    return 1;
+  if (sort_less(ctx, &items[i], &items[lo])) {
+    while (i + 1 < hi && sort_less(ctx, &items[i + 1], &items[i]))
+      i++;
+    for (size_t a = lo, b = i; a < b; a++, b--) {
+      sort_item swap = items[a];
+      items[a] = items[b];
+      items[b] = swap;
+    }
+  } else {
+    while (i + 1 < hi && !sort_less(ctx, &items[i + 1], &items[i]))
+      i++;
   }
-  if (argon_array_compare(&arr[mid], &arr[hi], callback, api, err, state) > 0) {
-    ArgonObject *tmp = arr[mid];
-    arr[mid] = arr[hi];
-    arr[hi] = tmp;
+  return i + 1 - lo;
+}
+
+// timsort's choice, between 32 and 64 so n / min_run is close to a power of 2.
+static size_t min_run_length(size_t n) {
+  size_t r = 0;
+  while (n >= 64) {
+    r |= n & 1;
+    n >>= 1;
   }
+  return n + r;
+}
 
-  if (api->is_error(err))
+static void merge_at(sort_item *items, sort_context *ctx, size_t at) {
+  sort_run *left = &ctx->runs[at];
+  sort_run *right = &ctx->runs[at + 1];
+  size_t lo = left->start;
+  size_t mid = right->start;
+  size_t hi = right->start + right->length;
+  left->length += right->length;
+  memmove(right, right + 1, (ctx->run_count - at - 2) * sizeof(sort_run));
+  ctx->run_count--;
+
+  // runs that are already in order need no merge
+  if (!sort_less(ctx, &items[mid], &items[mid - 1]))
     return;
+  memcpy(ctx->buffer, items + lo, (mid - lo) * sizeof(sort_item));
+  size_t i = 0;
+  size_t left_length = mid - lo;
+  size_t j = mid;
+  size_t k = lo;
+  while (i < left_length && j < hi) {
+    if (sort_less(ctx, &items[j], &ctx->buffer[i]))
+      items[k++] = items[j++];
+    else
+      items[k++] = ctx->buffer[i++];
+  }
+  memcpy(items + k, ctx->buffer + i, (left_length - i) * sizeof(sort_item));
+}
 
-  // Place pivot at hi-1 (safe: hi >= lo+16, so hi-1 > mid > lo)
-  ArgonObject *pivot = arr[mid];
-  {
-    ArgonObject *tmp = arr[mid];
-    arr[mid] = arr[hi - 1];
-    arr[hi - 1] = tmp;
-  }
-
-  size_t i = lo;     // will be pre-incremented before first compare
-  size_t j = hi - 1; // will be pre-decremented before first compare
-
-  for (;;) {
-    while (argon_array_compare(&arr[++i], &pivot, callback, api, err, state) <
-               0 &&
-           !api->is_error(err))
-      ;
-    while (j > lo &&
-           argon_array_compare(&pivot, &arr[--j], callback, api, err, state) <
-               0 &&
-           !api->is_error(err))
-      ;
-    if (api->is_error(err) || i >= j)
+// keeps each run longer than the two above it, so merges stay balanced.
+static void merge_collapse(sort_item *items, sort_context *ctx) {
+  sort_run *runs = ctx->runs;
+  while (ctx->run_count > 1) {
+    size_t n = ctx->run_count - 2;
+    if ((n > 0 && runs[n - 1].length <= runs[n].length + runs[n + 1].length) ||
+        (n > 1 && runs[n - 2].length <= runs[n - 1].length + runs[n].length)) {
+      if (runs[n - 1].length < runs[n + 1].length)
+        n--;
+    } else if (runs[n].length > runs[n + 1].length) {
       break;
-    ArgonObject *tmp = arr[i];
-    arr[i] = arr[j];
-    arr[j] = tmp;
+    }
+    merge_at(items, ctx, n);
   }
+}
 
-  // Restore pivot to its final position
-  {
-    ArgonObject *tmp = arr[i];
-    arr[i] = arr[hi - 1];
-    arr[hi - 1] = tmp;
+static void merge_sort(sort_item *items, size_t n, sort_context *ctx) {
+  size_t min_run = min_run_length(n);
+  ctx->run_count = 0;
+  for (size_t lo = 0; lo < n;) {
+    size_t run = count_run(items, lo, n, ctx);
+    if (run < min_run) {
+      size_t forced = min_run < n - lo ? min_run : n - lo;
+      binary_insertion_sort(items, lo, lo + run, lo + forced, ctx);
+      run = forced;
+    }
+    ctx->runs[ctx->run_count++] = (sort_run){lo, run};
+    merge_collapse(items, ctx);
+    lo += run;
   }
-
-  if (!api->is_error(err)) {
-    if (i > 0 && i - 1 > lo)
-      argon_qsort(arr, lo, i - 1, callback, api, err, state);
-    if (i + 1 < hi)
-      argon_qsort(arr, i + 1, hi, callback, api, err, state);
+  while (ctx->run_count > 1) {
+    size_t n = ctx->run_count - 2;
+    if (n > 0 && ctx->runs[n - 1].length < ctx->runs[n + 1].length)
+      n--;
+    merge_at(items, ctx, n);
   }
 }
 
+// sort(comparator?, key=, reverse=)
 ARGON_METHOD(ARRAY_TYPE, sort, {
-  if (api->fix_to_arg_size(2, argc, err))
-    return api->ARGON_NULL;
+  if (argc != 1 && argc != 2) {
+    *err = create_err(RuntimeError,
+                      "sort expects 1 or 2 arguments, got %" PRIu64, argc);
+    return ARGON_NULL;
+  }
   GET_SELF(TYPE_ARRAY)
 
+  sort_context ctx = {
+      .mode = SORT_CALLBACK,
+      .reverse = false,
+      .callback = argc == 2 && argv[1] != ARGON_NULL ? argv[1] : NULL,
+      .api = api,
+      .err = err,
+      .state = state,
+  };
+  ArgonObject *key = NULL;
+  if (kwargs) {
+    key = api->get_from_hashmap_string_key(kwargs, "key");
+    if (key == ARGON_NULL)
+      key = NULL;
+    ArgonObject *reverse = api->get_from_hashmap_string_key(kwargs, "reverse");
+    ctx.reverse = reverse && reverse->as_bool;
+  }
+
   size_t n = self->value.as_array->size;
   if (n <= 1)
     return self; // nothing to do
 
-  // Build a flat C array of pointers for easy swapping
-  ArgonObject **arr = malloc(n * sizeof(ArgonObject *));
-  if (!arr) {
-    // set OOM error via your api if you have that
-    return api->ARGON_NULL;
+  // collector visible, since computed keys are only referenced from here
+  sort_item *items = ar_alloc(n * sizeof(sort_item));
+  ctx.buffer = ar_alloc(n * sizeof(sort_item));
+  ArgonObject **values =
+      (ArgonObject **)darray_armem_get(self->value.as_array, 0);
+  for (size_t i = 0; i < n; i++) {
+    items[i].value = values[i];
+    items[i].key = values[i];
+  }
+  // copied out first: a key callback may resize the array under values
+  if (key) {
+    for (size_t i = 0; i < n; i++) {
+      items[i].key = api->call(key, 1, &items[i].value, NULL, err, state);
+      if (api->is_error(err))
+        return ARGON_NULL;
+    }
   }
 
-  memcpy(arr, self->value.as_array->data, n * sizeof(ArgonObject *));
-  for (size_t i = 0; i < n; i++)
-    arr[i] = *(ArgonObject **)darray_armem_get(self->value.as_array, i);
-
-  argon_qsort(arr, 0, n - 1, argv[1], api, err, state);
-
-  if (api->is_error(err)) {
-    free(arr);
-    return api->ARGON_NULL;
+  if (!ctx.callback) {
+    ArgonType first = items[0].key->type;
+    ctx.mode = first == TYPE_NUMBER   ? SORT_NUMBERS
+               : first == TYPE_STRING ? SORT_STRINGS
+                                      : SORT_LESS_THAN;
+    for (size_t i = 1; i < n && ctx.mode != SORT_LESS_THAN; i++) {
+      if (items[i].key->type != first)
+        ctx.mode = SORT_LESS_THAN;
+    }
   }
 
-  // Write sorted pointers back — sort in place like JS Array.prototype.sort
-  memcpy(self->value.as_array->data, arr, n * sizeof(ArgonObject *));
-  for (size_t i = 0; i < n; i++)
-    *(ArgonObject **)darray_armem_get(self->value.as_array, i) = arr[i];
+  merge_sort(items, n, &ctx);
+  if (api->is_error(err))
+    return ARGON_NULL;
 
-  free(arr);
+  // the callbacks may have resized the array, so write back what still fits
+  if (self->value.as_array->size < n)
+    n = self->value.as_array->size;
+  if (!n)
+    return self;
+  values = (ArgonObject **)darray_armem_get(self->value.as_array, 0);
+  for (size_t i = 0; i < n; i++)
+    values[i] = items[i].value;
   return self; // JS sort mutates and returns self
 })
 
@@ -860,6 +1023,9 @@ void init_array_type() {
   MOUNT_ARGON_METHOD(ARRAY_TYPE, map)
   MOUNT_ARGON_METHOD(ARRAY_TYPE, filter)
   MOUNT_ARGON_METHOD(ARRAY_TYPE, sort)
+  MOUNT_ARGON_METHOD(ARRAY_TYPE, parallel_map)
+  MOUNT_ARGON_METHOD(ARRAY_TYPE, parallel_filter)
+  MOUNT_ARGON_METHOD(ARRAY_TYPE, parallel_reduce)
   MOUNT_ARGON_METHOD(ARRAY_TYPE, __getitem__)
   MOUNT_ARGON_METHOD(ARRAY_TYPE, __setitem__)
   MOUNT_ARGON_METHOD(ARRAY_TYPE, __delitem__)
@@ -0,0 +1,401 @@
+/*
+ * SPDX-FileCopyrightText: 2026 William Bell
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "parallel.h"
+#include "../../../RWLock.h"
+#include "../../../err.h"
+#include "../../../memory.h"
+#include "../../api/api.h"
+#include "../../call/call.h"
+#include "../exceptions/exceptions.h"
+#include "../literals/literals.h"
+#include "array.h"
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/*
+ * a fixed pool of worker threads, started on first use with one per core
+ * less the caller, which works through the chunks as well. each worker runs
+ * its own RuntimeState and registers with the collector through the native
+ * api hook only while it holds a job, so the runtime's locks go back to
+ * being skipped once the pool is idle. chunks are claimed off an atomic
+ * counter and results land in per-item slots, so they come back in order.
+ */
+
+#define MAX_WORKERS 64
+#define CHUNKS_PER_THREAD 4
+
+#ifdef _WIN32
+typedef SRWLOCK pool_mutex;
+typedef CONDITION_VARIABLE pool_cond;
+#define POOL_MUTEX_INIT SRWLOCK_INIT
+#define POOL_COND_INIT CONDITION_VARIABLE_INIT
+#else
+typedef pthread_mutex_t pool_mutex;
+typedef pthread_cond_t pool_cond;
+#define POOL_MUTEX_INIT PTHREAD_MUTEX_INITIALIZER
+#define POOL_COND_INIT PTHREAD_COND_INITIALIZER
+#endif
+
+typedef enum {
+  PARALLEL_MAP,
+  PARALLEL_FILTER,
+  PARALLEL_REDUCE,
+} parallel_kind;
+
+typedef struct {
+  parallel_kind kind;
+  ArgonObject *fn;
+  ArgonObject **items; // snapshot, so the callback may change the array
+  size_t length;
+  size_t chunk;
+  size_t chunk_count;
+  ArgonObject **results; // map: one per item, reduce: one per chunk
+  bool *keep;            // filter: one per item
+  atomic_size_t next_chunk;
+  atomic_bool failed;
+  // guarded by the pool lock
+  size_t error_chunk;
+  ArErr err;
+  size_t workers_inside;
+} parallel_job;
+
+static struct {
+  pool_mutex lock;
+  pool_cond wake;
+  pool_cond idle;
+  bool started;
+  size_t worker_count;
+  parallel_job *job;
+  uint64_t generation;
+} pool = {POOL_MUTEX_INIT, POOL_COND_INIT, POOL_COND_INIT, false, 0, NULL, 0};
+
+#ifdef _WIN32
+static void pool_lock(void) { AcquireSRWLockExclusive(&pool.lock); }
+static void pool_unlock(void) { ReleaseSRWLockExclusive(&pool.lock); }
+static void pool_wait(pool_cond *cond) {
+  SleepConditionVariableSRW(cond, &pool.lock, INFINITE, 0);
+}
+static void pool_broadcast(pool_cond *cond) { WakeAllConditionVariable(cond); }
+static size_t cpu_count(void) {
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors;
+}
+#else
+static void pool_lock(void) { pthread_mutex_lock(&pool.lock); }
+static void pool_unlock(void) { pthread_mutex_unlock(&pool.lock); }
+static void pool_wait(pool_cond *cond) { pthread_cond_wait(cond, &pool.lock); }
+static void pool_broadcast(pool_cond *cond) { pthread_cond_broadcast(cond); }
+static size_t cpu_count(void) {
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (size_t)count : 1;
+}
+#endif
+
+static bool is_truthy(ArgonObject *value, ArErr *err, RuntimeState *state) {
+  if (value == ARGON_TRUE)
+    return true;
+  if (value == ARGON_FALSE)
+    return false;
+  if (value->type != TYPE_OBJECT)
+    return value->as_bool;
+  ArgonObject *args[] = {ARGON_BOOL_TYPE, value};
+  return ARGON_FUNC_ARGON_BOOL_TYPE___new__(2, args, NULL, err, state, NULL) ==
+         ARGON_TRUE;
+}
+
+static void run_chunk(parallel_job *job, size_t chunk, ArErr *err,
+                      RuntimeState *state) {
+  size_t start = chunk * job->chunk;
+  size_t end = start + job->chunk < job->length ? start + job->chunk
+                                                : job->length;
+  switch (job->kind) {
+  case PARALLEL_MAP:
+    for (size_t i = start; i < end; i++) {
+      job->results[i] =
+          argon_call(job->fn, 1, &job->items[i], NULL, err, state);
+      if (is_error(err))
+        return;
+    }
+    return;
+  case PARALLEL_FILTER:
+    for (size_t i = start; i < end; i++) {
+      ArgonObject *value =
+          argon_call(job->fn, 1, &job->items[i], NULL, err, state);
+      if (is_error(err))
+        return;
+      job->keep[i] = is_truthy(value, err, state);
+      if (is_error(err))
+        return;
+    }
+    return;
+  case PARALLEL_REDUCE: {
+    ArgonObject *accumulator = job->items[start];
+    for (size_t i = start + 1; i < end; i++) {
+      ArgonObject *args[] = {accumulator, job->items[i]};
+      accumulator = argon_call(job->fn, 2, args, NULL, err, state);
+      if (is_error(err))
+        return;
+    }
+    job->results[chunk] = accumulator;
+    return;
+  }
+  }
+}
+
+static void run_chunks(parallel_job *job, RuntimeState *state) {
+  while (!atomic_load(&job->failed)) {
+    size_t chunk = atomic_fetch_add(&job->next_chunk, 1);
+    if (chunk >= job->chunk_count)
+      return;
+    ArErr err = no_err;
+    run_chunk(job, chunk, &err, state);
+    if (is_error(&err)) {
+      // keep the error from the earliest chunk, like a sequential run would
+      pool_lock();
+      if (!atomic_load(&job->failed) || chunk < job->error_chunk) {
+        job->err = err;
+        job->error_chunk = chunk;
+      }
+      atomic_store(&job->failed, true);
+      pool_unlock();
+    }
+  }
+}
+
+static void worker_loop(void) {
+  uint64_t seen = 0;
+  pool_lock();
+  while (true) {
+    while (!pool.job || pool.generation == seen)
+      pool_wait(&pool.wake);
+    seen = pool.generation;
+    parallel_job *job = pool.job;
+    job->workers_inside++;
+    pool_unlock();
+
+    native_api.register_thread();
+    ArgonObject *registers = NULL;
+    RuntimeState *state = native_api.new_state(&registers);
+    run_chunks(job, state);
+    native_api.unregister_thread();
+
+    pool_lock();
+    if (--job->workers_inside == 0)
+      pool_broadcast(&pool.idle);
+  }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI worker_main(LPVOID arg) {
+  (void)arg;
+  worker_loop();
+  return 0;
+}
+
+static bool spawn_worker(void) {
+  HANDLE handle = CreateThread(NULL, 0, worker_main, NULL, 0, NULL);
+  if (!handle)
+    return false;
+  CloseHandle(handle);
+  return true;
+}
+#else
+static void *worker_main(void *arg) {
+  (void)arg;
+  worker_loop();
+  return NULL;
+}
+
+static bool spawn_worker(void) {
+  pthread_t thread;
+  if (pthread_create(&thread, NULL, worker_main, NULL) != 0)
+    return false;
+  pthread_detach(thread);
+  return true;
+}
+#endif
+
+static size_t start_pool(void) {
+  pool_lock();
+  if (!pool.started) {
+    pool.started = true;
+    size_t wanted = cpu_count() - 1;
+    if (wanted > MAX_WORKERS)
+      wanted = MAX_WORKERS;
+    while (pool.worker_count < wanted && spawn_worker())
+      pool.worker_count++;
+  }
+  size_t workers = pool.worker_count;
+  pool_unlock();
+  return workers;
+}
+
+static void run_job(parallel_job *job, RuntimeState *state) {
+  bool shared = false;
+  if (job->chunk_count > 1 && start_pool()) {
+    // counted as a thread first, so the runtime's locks are on before any
+    // worker touches shared objects
+    atomic_fetch_add(&thread_count, 1);
+    pool_lock();
+    // a pool already running a job (nested, or another thread's) is left
+    // alone and the caller does every chunk itself
+    if (!pool.job) {
+      pool.job = job;
+      pool.generation++;
+      shared = true;
+      pool_broadcast(&pool.wake);
+    }
+    pool_unlock();
+    if (!shared)
+      atomic_fetch_sub(&thread_count, 1);
+  }
+
+  run_chunks(job, state);
+
+  if (shared) {
+    pool_lock();
+    pool.job = NULL;
+    while (job->workers_inside)
+      pool_wait(&pool.idle);
+    pool_unlock();
+    atomic_fetch_sub(&thread_count, 1);
+  }
+}
+
+static bool prepare_job(parallel_job *job, parallel_kind kind,
+                        ArgonObject *self, ArgonObject *fn,
+                        ArgonHashmap *kwargs, ArErr *err,
+                        ArgonNativeAPI *api) {
+  darray_armem *array = self->value.as_array;
+  *job = (parallel_job){.kind = kind, .fn = fn, .length = array->size};
+  atomic_init(&job->next_chunk, 0);
+  atomic_init(&job->failed, false);
+  job->err = no_err;
+
+  if (job->length) {
+    job->items = ar_alloc(job->length * sizeof(ArgonObject *));
+    memcpy(job->items, darray_armem_get(array, 0),
+           job->length * sizeof(ArgonObject *));
+  }
+
+  ArgonObject *chunk = kwargs ? api->get_from_hashmap_string_key(kwargs, "chunk")
+                              : NULL;
+  if (chunk && chunk != ARGON_NULL) {
+    int64_t size = api->argon_to_i64(chunk, err);
+    if (api->is_error(err))
+      return false;
+    if (size < 1) {
+      api->throw_argon_error(err, ValueError,
+                             "chunk must be at least 1, got %" PRId64, size);
+      return false;
+    }
+    job->chunk = (size_t)size;
+  } else {
+    size_t threads = start_pool() + 1;
+    job->chunk = job->length / (threads * CHUNKS_PER_THREAD);
+    if (job->chunk < 1)
+      job->chunk = 1;
+  }
+  job->chunk_count = (job->length + job->chunk - 1) / job->chunk;
+  return true;
+}
+
+// parallel_map(fn, chunk=) -> array
+ARGON_METHOD(ARRAY_TYPE, parallel_map, {
+  if (argc != 2) {
+    *err = create_err(RuntimeError,
+                      "parallel_map expects 2 arguments, got %" PRIu64, argc);
+    return ARGON_NULL;
+  }
+  GET_SELF(TYPE_ARRAY)
+  parallel_job job;
+  if (!prepare_job(&job, PARALLEL_MAP, self, argv[1], kwargs, err, api))
+    return ARGON_NULL;
+  if (job.length)
+    job.results = ar_alloc(job.length * sizeof(ArgonObject *));
+  run_job(&job, state);
+  if (is_error(&job.err)) {
+    *err = job.err;
+    return ARGON_NULL;
+  }
+  return create_array(job.results, job.length);
+})
+
+// parallel_filter(fn, chunk=) -> array
+ARGON_METHOD(ARRAY_TYPE, parallel_filter, {
+  if (argc != 2) {
+    *err = create_err(RuntimeError,
+                      "parallel_filter expects 2 arguments, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  GET_SELF(TYPE_ARRAY)
+  parallel_job job;
+  if (!prepare_job(&job, PARALLEL_FILTER, self, argv[1], kwargs, err, api))
+    return ARGON_NULL;
+  if (job.length)
+    job.keep = ar_alloc_atomic(job.length * sizeof(bool));
+  run_job(&job, state);
+  if (is_error(&job.err)) {
+    *err = job.err;
+    return ARGON_NULL;
+  }
+  size_t kept = 0;
+  for (size_t i = 0; i < job.length; i++) {
+    if (job.keep[i])
+      job.items[kept++] = job.items[i];
+  }
+  return create_array(job.items, kept);
+})
+
+// parallel_reduce(fn, initial?, chunk=) -> value. fn has to be associative,
+// since each chunk is folded on its own before the chunks are combined in
+// order.
+ARGON_METHOD(ARRAY_TYPE, parallel_reduce, {
+  if (argc != 2 && argc != 3) {
+    *err = create_err(RuntimeError,
+                      "parallel_reduce expects 2 or 3 arguments, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  GET_SELF(TYPE_ARRAY)
+  parallel_job job;
+  if (!prepare_job(&job, PARALLEL_REDUCE, self, argv[1], kwargs, err, api))
+    return ARGON_NULL;
+  if (!job.length) {
+    if (argc == 3)
+      return argv[2];
+    return api->throw_argon_error(
+        err, ValueError, "parallel_reduce of an empty array with no initial "
+                         "value");
+  }
+  job.results = ar_alloc(job.chunk_count * sizeof(ArgonObject *));
+  run_job(&job, state);
+  if (is_error(&job.err)) {
+    *err = job.err;
+    return ARGON_NULL;
+  }
+  ArgonObject *accumulator = argc == 3 ? argv[2] : job.results[0];
+  for (size_t i = argc == 3 ? 0 : 1; i < job.chunk_count; i++) {
+    ArgonObject *args[] = {accumulator, job.results[i]};
+    accumulator = argon_call(job.fn, 2, args, NULL, err, state);
+    if (is_error(err))
+      return ARGON_NULL;
+  }
+  return accumulator;
+})
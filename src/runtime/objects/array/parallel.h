@@ -0,0 +1,15 @@
+/*
+ * SPDX-FileCopyrightText: 2026 William Bell
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef ARRAY_PARALLEL_H
+#define ARRAY_PARALLEL_H
+#include "../object.h"
+
+EXPOSE_ARGON_METHOD(ARRAY_TYPE, parallel_map)
+EXPOSE_ARGON_METHOD(ARRAY_TYPE, parallel_filter)
+EXPOSE_ARGON_METHOD(ARRAY_TYPE, parallel_reduce)
+
+#endif // ARRAY_PARALLEL_H
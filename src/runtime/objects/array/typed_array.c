@@ -0,0 +1,980 @@
+/*
+ * SPDX-FileCopyrightText: 2026 William Bell
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "typed_array.h"
+#include "../../../../include/ArgonTypes.h"
+#include "../../../err.h"
+#include "../../../memory.h"
+#include "../../call/call.h"
+#include "../buffer/buffer.h"
+#include "../exceptions/exceptions.h"
+#include "../literals/literals.h"
+#include "../number/number.h"
+#include "../slice/slice.h"
+#include "../string/string.h"
+#include "array.h"
+#include <inttypes.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * array.u8, array.i64 and array.f64 hold raw machine values in one atomic
+ * allocation, so the collector never scans them and a million i64s cost 8MB
+ * instead of a million boxed numbers. elements are only boxed when read. the
+ * bulk operations are plain loops over restrict pointers, one per operator,
+ * so they vectorise at -O3 without any intrinsics.
+ */
+
+ArgonObject *TYPED_ARRAY_TYPE;
+ArgonObject *TYPED_ARRAY_ITERATOR_TYPE;
+
+static ArgonObject *kind_classes[3];
+static const char *kind_names[] = {"u8", "i64", "f64"};
+static const size_t element_sizes[] = {sizeof(uint8_t), sizeof(int64_t),
+                                       sizeof(double)};
+
+typedef enum {
+  OP_ADD,
+  OP_SUBTRACT,
+  OP_MULTIPLY,
+  OP_DIVIDE,
+} elementwise_op;
+
+static ArgonObject *alloc_typed_array(typed_array_kind kind, size_t length) {
+  ArgonObject *object =
+      new_instance(kind_classes[kind], sizeof(struct typed_array));
+  object->type = TYPE_TYPED_ARRAY;
+  object->value.as_typed_array =
+      (struct typed_array *)((char *)object + sizeof(ArgonObject));
+  struct typed_array *array = object->value.as_typed_array;
+  array->kind = kind;
+  array->length = length;
+  array->capacity = length;
+  array->data = length ? ar_alloc_atomic(length * element_sizes[kind]) : NULL;
+  array->owner = NULL;
+  return object;
+}
+
+ArgonObject *create_typed_array(typed_array_kind kind, size_t length) {
+  ArgonObject *object = alloc_typed_array(kind, length);
+  if (length)
+    memset(object->value.as_typed_array->data, 0,
+           length * element_sizes[kind]);
+  return object;
+}
+
+// grows into a fresh allocation rather than reallocating, since the old data
+// may still be shared with a buffer.
+static void reserve(struct typed_array *array, size_t capacity) {
+  if (capacity <= array->capacity)
+    return;
+  size_t new_capacity = array->capacity ? array->capacity * 2 : 8;
+  while (new_capacity < capacity)
+    new_capacity *= 2;
+  void *data = ar_alloc_atomic(new_capacity * element_sizes[array->kind]);
+  if (array->length)
+    memcpy(data, array->data, array->length * element_sizes[array->kind]);
+  array->data = data;
+  array->capacity = new_capacity;
+}
+
+static bool kind_of_class(ArgonObject *cls, typed_array_kind *kind) {
+  for (; cls; cls = get_builtin_field(cls, __base__)) {
+    for (typed_array_kind k = TYPED_ARRAY_U8; k <= TYPED_ARRAY_F64; k++) {
+      if (cls == kind_classes[k]) {
+        *kind = k;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+static ArgonObject *box_double(double value, ArErr *err) {
+  if (!isfinite(value)) {
+    *err = create_err(ValueError, "f64 value %g is not a finite number",
+                      value);
+    return ARGON_NULL;
+  }
+  return new_number_object_from_double(value);
+}
+
+static ArgonObject *box_element(struct typed_array *array, size_t index,
+                                ArErr *err) {
+  switch (array->kind) {
+  case TYPED_ARRAY_U8:
+    return new_number_object_from_int64(((uint8_t *)array->data)[index]);
+  case TYPED_ARRAY_I64:
+    return new_number_object_from_int64(((int64_t *)array->data)[index]);
+  case TYPED_ARRAY_F64:
+    return box_double(((double *)array->data)[index], err);
+  }
+  return ARGON_NULL;
+}
+
+static double number_to_double(struct as_number *number) {
+  if (number->is_int64)
+    return (double)number->n.i64;
+  return mpq_get_d(*number->n.mpq);
+}
+
+static bool store_element(struct typed_array *array, size_t index,
+                          ArgonObject *value, ArErr *err) {
+  if (value->type != TYPE_NUMBER) {
+    *err = create_err(TypeError, "%s elements must be numbers",
+                      kind_names[array->kind]);
+    return false;
+  }
+  struct as_number *number = value->value.as_number;
+  switch (array->kind) {
+  case TYPED_ARRAY_U8:
+    if (!number->is_int64 || number->n.i64 < 0 || number->n.i64 > UINT8_MAX) {
+      *err = create_err(ValueError,
+                        "u8 elements must be integers from 0 to 255");
+      return false;
+    }
+    ((uint8_t *)array->data)[index] = (uint8_t)number->n.i64;
+    return true;
+  case TYPED_ARRAY_I64:
+    if (!number->is_int64) {
+      *err = create_err(ValueError,
+                        "i64 elements must be integers that fit in 64 bits");
+      return false;
+    }
+    ((int64_t *)array->data)[index] = number->n.i64;
+    return true;
+  case TYPED_ARRAY_F64:
+    ((double *)array->data)[index] = number_to_double(number);
+    return true;
+  }
+  return false;
+}
+
+static bool append_element(struct typed_array *array, ArgonObject *value,
+                           ArErr *err) {
+  reserve(array, array->length + 1);
+  if (!store_element(array, array->length, value, err))
+    return false;
+  array->length++;
+  return true;
+}
+
+// the elements as a kind at least as wide, only copying if the kinds differ.
+static void *widened(struct typed_array *array, typed_array_kind kind) {
+  if (array->kind == kind)
+    return array->data;
+  size_t n = array->length;
+  void *out = ar_alloc_atomic(n ? n * element_sizes[kind] : 1);
+  if (kind == TYPED_ARRAY_I64) {
+    int64_t *restrict o = out;
+    const uint8_t *in = array->data;
+    for (size_t i = 0; i < n; i++)
+      o[i] = in[i];
+  } else if (array->kind == TYPED_ARRAY_U8) {
+    double *restrict o = out;
+    const uint8_t *in = array->data;
+    for (size_t i = 0; i < n; i++)
+      o[i] = in[i];
+  } else {
+    double *restrict o = out;
+    const int64_t *in = array->data;
+    for (size_t i = 0; i < n; i++)
+      o[i] = (double)in[i];
+  }
+  return out;
+}
+
+ARGON_METHOD(TYPED_ARRAY_TYPE, __new__, {
+  if (argc != 2) {
+    *err = create_err(RuntimeError, "__new__ expects 2 arguments, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  typed_array_kind kind;
+  if (!kind_of_class(argv[0], &kind))
+    return api->throw_argon_error(
+        err, TypeError, "use array.u8, array.i64 or array.f64 to make a typed "
+                        "array");
+  ArgonObject *source = argv[1];
+  size_t width = element_sizes[kind];
+
+  switch (source->type) {
+  case TYPE_NUMBER: {
+    struct as_number *number = source->value.as_number;
+    if (!number->is_int64 || number->n.i64 < 0)
+      return api->throw_argon_error(
+          err, ValueError, "typed array length must be a non-negative integer");
+    if ((uint64_t)number->n.i64 > SIZE_MAX / width)
+      return api->throw_argon_error(err, ValueError,
+                                    "typed array length is too large");
+    return create_typed_array(kind, (size_t)number->n.i64);
+  }
+  case TYPE_BUFFER: {
+    // shares the buffer's bytes, so writes through either are seen by both
+    struct buffer *buffer = source->value.as_buffer;
+    if (buffer->size % width)
+      return api->throw_argon_error(
+          err, ValueError,
+          "buffer of %" PRIu64 " bytes does not hold a whole number of %s "
+          "elements",
+          (uint64_t)buffer->size, kind_names[kind]);
+    ArgonObject *object = alloc_typed_array(kind, 0);
+    struct typed_array *array = object->value.as_typed_array;
+    array->data = buffer->data;
+    array->owner = source;
+    array->length = array->capacity = buffer->size / width;
+    return object;
+  }
+  case TYPE_TYPED_ARRAY: {
+    struct typed_array *other = source->value.as_typed_array;
+    ArgonObject *object = alloc_typed_array(kind, other->length);
+    struct typed_array *array = object->value.as_typed_array;
+    if (other->kind <= kind) {
+      if (other->length)
+        memcpy(array->data, widened(other, kind), other->length * width);
+      return object;
+    }
+    // narrowing checks every element
+    for (size_t i = 0; i < other->length; i++) {
+      ArgonObject *item = box_element(other, i, err);
+      if (is_error(err) || !store_element(array, i, item, err))
+        return ARGON_NULL;
+    }
+    return object;
+  }
+  case TYPE_ARRAY: {
+    darray_armem *items = source->value.as_array;
+    ArgonObject *object = alloc_typed_array(kind, items->size);
+    for (size_t i = 0; i < items->size; i++) {
+      if (!store_element(object->value.as_typed_array, i,
+                         *(ArgonObject **)darray_armem_get(items, i), err))
+        return ARGON_NULL;
+    }
+    return object;
+  }
+  default:
+    break;
+  }
+
+  ArgonObject *iter_method = get_builtin_field_for_class(
+      get_builtin_field(source, __class__), __iter__, source);
+  if (!iter_method)
+    return api->throw_argon_error(err, RuntimeError,
+                                  "Object doesn't have __iter__ method");
+  ArgonObject *iter_obj = argon_call(iter_method, 0, NULL, NULL, err, state);
+  if (api->is_error(err))
+    return ARGON_NULL;
+
+  ArgonObject *next_method = get_builtin_field_for_class(
+      get_builtin_field(iter_obj, __class__), __next__, iter_obj);
+  if (!next_method)
+    return api->throw_argon_error(
+        err, RuntimeError, "Iterator object doesn't have __next__ method");
+
+  ArgonObject *object = create_typed_array(kind, 0);
+  while (true) {
+    ArgonObject *item = argon_call(next_method, 0, NULL, NULL, err, state);
+    if (err->ptr == StopIteration_instance) {
+      err->ptr = ARGON_NULL;
+      break;
+    } else if (api->is_error(err)) {
+      return ARGON_NULL;
+    }
+    if (!append_element(object->value.as_typed_array, item, err))
+      return ARGON_NULL;
+  }
+  return object;
+})
+
+// the shortest of %.15g and %.17g that reads back as the same double.
+static int format_double(char *out, double value) {
+  int length = sprintf(out, "%.15g", value);
+  if (strtod(out, NULL) != value)
+    length = sprintf(out, "%.17g", value);
+  return length;
+}
+
+ARGON_METHOD(TYPED_ARRAY_TYPE, __string__, {
+  (void)state;
+  if (argc != 1) {
+    *err = create_err(RuntimeError,
+                      "__string__ expects 1 argument, got %" PRIu64, argc);
+    return ARGON_NULL;
+  }
+  GET_SELF(TYPE_TYPED_ARRAY)
+  struct typed_array *array = self->value.as_typed_array;
+
+  // every element fits in 24 bytes plus the ", " separator
+  char *string = checked_malloc(16 + array->length * 26);
+  size_t length =
+      (size_t)sprintf(string, "array.%s([", kind_names[array->kind]);
+  for (size_t i = 0; i < array->length; i++) {
+    if (i) {
+      string[length++] = ',';
+      string[length++] = ' ';
+    }
+    switch (array->kind) {
+    case TYPED_ARRAY_U8:
+      length += sprintf(string + length, "%u",
+                        (unsigned)((uint8_t *)array->data)[i]);
+      break;
+    case TYPED_ARRAY_I64:
+      length +=
+          sprintf(string + length, "%" PRId64, ((int64_t *)array->data)[i]);
+      break;
+    case TYPED_ARRAY_F64:
+      length += format_double(string + length, ((double *)array->data)[i]);
+      break;
+    }
+  }
+  string[length++] = ']';
+  string[length++] = ')';
+
+  ArgonObject *result = new_string_object(string, length, 0);
+  free(string);
+  return result;
+})
+
+ARGON_METHOD(TYPED_ARRAY_TYPE, get_length, {
+  (void)state;
+  if (argc != 1) {
+    *err = create_err(RuntimeError,
+                      "get_length expects 1 argument, got %" PRIu64, argc);
+    return ARGON_NULL;
+  }
+  GET_SELF(TYPE_TYPED_ARRAY)
+  return new_number_object_from_int64(self->value.as_typed_array->length);
+})
+
+ARGON_METHOD(TYPED_ARRAY_TYPE, set_length, {
+  (void)api;
+  (void)state;
+  (void)argv;
+  if (argc != 2) {
+    *err = create_err(RuntimeError,
+                      "set_length expects 2 arguments, got %" PRIu64, argc);
+    return ARGON_NULL;
+  }
+
+  *err = create_err(RuntimeError, "attribute 'length' is immutable");
+  return ARGON_NULL;
+})
+
+ARGON_METHOD(TYPED_ARRAY_TYPE, append, {
+  (void)state;
+  if (argc < 1) {
+    *err = create_err(RuntimeError,
+                      "append expects at least 1 argument, got %" PRIu64, argc);
+    return ARGON_NULL;
+  }
+  GET_SELF(TYPE_TYPED_ARRAY)
+  struct typed_array *array = self->value.as_typed_array;
+  reserve(array, array->length + argc - 1);
+  for (size_t i = 1; i < argc; i++) {
+    if (!append_element(array, argv[i], err))
+      return ARGON_NULL;
+  }
+  return self;
+})
+
+ARGON_METHOD(TYPED_ARRAY_TYPE, __getitem__, {
+  (void)state;
+  if (argc != 2) {
+    *err = create_err(RuntimeError,
+                      "__getitem__ expects 2 arguments, got %" PRIu64, argc);
+    return ARGON_NULL;
+  }
+  GET_SELF(TYPE_TYPED_ARRAY)
+  struct typed_array *array = self->value.as_typed_array;
+  if (argv[1]->type == TYPE_SLICE) {
+    SliceIndices indices;
+    if (slice_indices(argv[1], array->length, &indices, err, api) != 0)
+      return ARGON_NULL;
+
+    int64_t size = 0;
+    if (indices.step > 0 && indices.stop > indices.start)
+      size = (indices.stop - indices.start + indices.step - 1) / indices.step;
+    else if (indices.step < 0 && indices.stop < indices.start)
+      size =
+          (indices.start - indices.stop - indices.step - 1) / (-indices.step);
+
+    ArgonObject *slice = alloc_typed_array(array->kind, size);
+    size_t width = element_sizes[array->kind];
+    char *from = (char *)array->data;
+    char *to = (char *)slice->value.as_typed_array->data;
+    if (indices.step == 1 && size) {
+      memcpy(to, from + indices.start * width, size * width);
+    } else {
+      for (int64_t i = 0; i < size; i++)
+        memcpy(to + i * width, from + (indices.start + i * indices.step) * width,
+               width);
+    }
+    return slice;
+  }
+  int64_t index = api->argon_to_i64(argv[1], err);
+  if (api->is_error(err))
+    return ARGON_NULL;
+  if (index < 0)
+    index += array->length;
+  if (index >= (int64_t)array->length || index < 0)
+    return api->throw_argon_error(err, IndexError, "index out of range");
+  return box_element(array, index, err);
+})
+
+ARGON_METHOD(TYPED_ARRAY_TYPE, __setitem__, {
+  (void)state;
+  if (argc != 3) {
+    *err = create_err(RuntimeError,
+                      "__setitem__ expects 3 arguments, got %" PRIu64, argc);
+    return ARGON_NULL;
+  }
+  GET_SELF(TYPE_TYPED_ARRAY)
+  struct typed_array *array = self->value.as_typed_array;
+  int64_t index = api->argon_to_i64(argv[1], err);
+  if (api->is_error(err))
+    return ARGON_NULL;
+  if (index < 0)
+    index += array->length;
+  if (index >= (int64_t)array->length || index < 0)
+    return api->throw_argon_error(err, IndexError, "index out of range");
+  if (!store_element(array, index, argv[2], err))
+    return ARGON_NULL;
+  return argv[2];
+})
+
+// one loop per operator and operand shape, so each of them vectorises. the
+// integer kinds go through unsigned arithmetic and wrap like the machine type.
+#define ELEMENTWISE_LOOP(T, U, OPERATOR)                                       \
+  if (b)                                                                       \
+    for (size_t i = 0; i < n; i++)                                             \
+      out[i] = (T)((U)a[i] OPERATOR (U)b[i]);                                  \
+  else                                                                         \
+    for (size_t i = 0; i < n; i++)                                             \
+      out[i] = (T)((U)a[i] OPERATOR (U)scalar);
+
+#define ELEMENTWISE_LOOPS(T, U)                                                \
+  case OP_ADD:                                                                 \
+    ELEMENTWISE_LOOP(T, U, +)                                                  \
+    break;                                                                     \
+  case OP_SUBTRACT:                                                            \
+    ELEMENTWISE_LOOP(T, U, -)                                                  \
+    break;                                                                     \
+  case OP_MULTIPLY:                                                            \
+    ELEMENTWISE_LOOP(T, U, *)                                                  \
+    break;
+
+// division always gives f64, so only elementwise_f64 has a loop for it.
+static void elementwise_u8(elementwise_op op, uint8_t *restrict out,
+                           const uint8_t *a, const uint8_t *b, uint8_t scalar,
+                           size_t n) {
+  switch (op) {
+    ELEMENTWISE_LOOPS(uint8_t, unsigned)
+  case OP_DIVIDE:
+    break;
+  }
+}
+
+static void elementwise_i64(elementwise_op op, int64_t *restrict out,
+                            const int64_t *a, const int64_t *b, int64_t scalar,
+                            size_t n) {
+  switch (op) {
+    ELEMENTWISE_LOOPS(int64_t, uint64_t)
+  case OP_DIVIDE:
+    break;
+  }
+}
+
+static void elementwise_f64(elementwise_op op, double *restrict out,
+                            const double *a, const double *b, double scalar,
+                            size_t n) {
+  switch (op) {
+    ELEMENTWISE_LOOPS(double, double)
+  case OP_DIVIDE:
+    ELEMENTWISE_LOOP(double, double, /)
+    break;
+  }
+}
+
+#undef ELEMENTWISE_LOOPS
+#undef ELEMENTWISE_LOOP
+
+/*
+ * the result takes the wider of the two kinds, with u8 < i64 < f64. a number
+ * keeps the array's kind when it fits in it, and division always gives f64.
+ */
+static ArgonObject *elementwise(ArgonObject *self, ArgonObject *other,
+                                elementwise_op op, ArErr *err) {
+  struct typed_array *a = self->value.as_typed_array;
+  struct typed_array *b = NULL;
+  typed_array_kind kind = a->kind;
+  int64_t scalar_i64 = 0;
+  double scalar_f64 = 0;
+
+  if (other->type == TYPE_TYPED_ARRAY) {
+    b = other->value.as_typed_array;
+    if (b->length != a->length) {
+      *err = create_err(ValueError,
+                        "typed arrays have different lengths, %" PRIu64
+                        " and %" PRIu64,
+                        (uint64_t)a->length, (uint64_t)b->length);
+      return ARGON_NULL;
+    }
+    if (b->kind > kind)
+      kind = b->kind;
+  } else if (other->type == TYPE_NUMBER) {
+    struct as_number *number = other->value.as_number;
+    if (!number->is_int64)
+      kind = TYPED_ARRAY_F64;
+    else if (kind == TYPED_ARRAY_U8 &&
+             (number->n.i64 < 0 || number->n.i64 > UINT8_MAX))
+      kind = TYPED_ARRAY_I64;
+    scalar_i64 = number->is_int64 ? number->n.i64 : 0;
+    scalar_f64 = number_to_double(number);
+  } else {
+    *err = create_err(TypeError,
+                      "typed arrays can only be combined with typed arrays or "
+                      "numbers");
+    return ARGON_NULL;
+  }
+  if (op == OP_DIVIDE)
+    kind = TYPED_ARRAY_F64;
+
+  size_t n = a->length;
+  const void *left = widened(a, kind);
+  const void *right = b ? widened(b, kind) : NULL;
+
+  if (op == OP_DIVIDE) {
+    size_t zeros = 0;
+    if (right) {
+      const double *divisor = right;
+      for (size_t i = 0; i < n; i++)
+        zeros += divisor[i] == 0;
+    } else {
+      zeros = scalar_f64 == 0;
+    }
+    if (zeros) {
+      *err = create_err(ZeroDivisionError, "division by zero");
+      return ARGON_NULL;
+    }
+  }
+
+  ArgonObject *result = alloc_typed_array(kind, n);
+  void *out = result->value.as_typed_array->data;
+  switch (kind) {
+  case TYPED_ARRAY_U8:
+    elementwise_u8(op, out, left, right, (uint8_t)scalar_i64, n);
+    break;
+  case TYPED_ARRAY_I64:
+    elementwise_i64(op, out, left, right, scalar_i64, n);
+    break;
+  case TYPED_ARRAY_F64:
+    elementwise_f64(op, out, left, right, scalar_f64, n);
+    break;
+  }
+  return result;
+}
+
+ARGON_METHOD(TYPED_ARRAY_TYPE, __add__, {
+  (void)state;
+  if (argc != 2) {
+    *err = create_err(RuntimeError, "__add__ expects 2 arguments, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  GET_SELF(TYPE_TYPED_ARRAY)
+  return elementwise(self, argv[1], OP_ADD, err);
+})
+
+ARGON_METHOD(TYPED_ARRAY_TYPE, __subtract__, {
+  (void)state;
+  if (argc != 2) {
+    *err = create_err(RuntimeError,
+                      "__subtract__ expects 2 arguments, got %" PRIu64, argc);
+    return ARGON_NULL;
+  }
+  GET_SELF(TYPE_TYPED_ARRAY)
+  return elementwise(self, argv[1], OP_SUBTRACT, err);
+})
+
+ARGON_METHOD(TYPED_ARRAY_TYPE, __multiply__, {
+  (void)state;
+  if (argc != 2) {
+    *err = create_err(RuntimeError,
+                      "__multiply__ expects 2 arguments, got %" PRIu64, argc);
+    return ARGON_NULL;
+  }
+  GET_SELF(TYPE_TYPED_ARRAY)
+  return elementwise(self, argv[1], OP_MULTIPLY, err);
+})
+
+ARGON_METHOD(TYPED_ARRAY_TYPE, __division__, {
+  (void)state;
+  if (argc != 2) {
+    *err = create_err(RuntimeError,
+                      "__division__ expects 2 arguments, got %" PRIu64, argc);
+    return ARGON_NULL;
+  }
+  GET_SELF(TYPE_TYPED_ARRAY)
+  return elementwise(self, argv[1], OP_DIVIDE, err);
+})
+
+// exact sums and dot products of i64s carry on in rationals after the first
+// overflow, so they never silently wrap.
+static ArgonObject *exact_i64_tail(int64_t total, const int64_t *a,
+                                   const int64_t *b, size_t i, size_t n) {
+  mpq_t exact, x, y;
+  mpq_init(exact);
+  mpq_init(x);
+  mpq_init(y);
+  mpq_set_si64(exact, total, 1);
+  for (; i < n; i++) {
+    mpq_set_si64(x, a[i], 1);
+    if (b) {
+      mpq_set_si64(y, b[i], 1);
+      mpq_mul(x, x, y);
+    }
+    mpq_add(exact, exact, x);
+  }
+  ArgonObject *result = new_number_object(exact);
+  mpq_clear(exact);
+  mpq_clear(x);
+  mpq_clear(y);
+  return result;
+}
+
+static ArgonObject *sum_i64(const int64_t *data, size_t n) {
+  int64_t total = 0;
+  for (size_t i = 0; i < n; i++) {
+    int64_t next;
+    if (__builtin_add_overflow(total, data[i], &next))
+      return exact_i64_tail(total, data, NULL, i, n);
+    total = next;
+  }
+  return new_number_object_from_int64(total);
+}
+
+static ArgonObject *dot_i64(const int64_t *a, const int64_t *b, size_t n) {
+  int64_t total = 0;
+  for (size_t i = 0; i < n; i++) {
+    int64_t product, next;
+    if (__builtin_mul_overflow(a[i], b[i], &product) ||
+        __builtin_add_overflow(total, product, &next))
+      return exact_i64_tail(total, a, b, i, n);
+    total = next;
+  }
+  return new_number_object_from_int64(total);
+}
+
+// four running sums break the dependency chain so the loop vectorises
+// without reassociating a single accumulator.
+static double sum_f64(const double *a, const double *b, size_t n) {
+  double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  size_t i = 0;
+  if (b) {
+    for (; i + 4 <= n; i += 4) {
+      s0 += a[i] * b[i];
+      s1 += a[i + 1] * b[i + 1];
+      s2 += a[i + 2] * b[i + 2];
+      s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < n; i++)
+      s0 += a[i] * b[i];
+  } else {
+    for (; i + 4 <= n; i += 4) {
+      s0 += a[i];
+      s1 += a[i + 1];
+      s2 += a[i + 2];
+      s3 += a[i + 3];
+    }
+    for (; i < n; i++)
+      s0 += a[i];
+  }
+  return (s0 + s1) + (s2 + s3);
+}
+
+ARGON_METHOD(TYPED_ARRAY_TYPE, sum, {
+  (void)state;
+  if (argc != 1) {
+    *err = create_err(RuntimeError, "sum expects 1 argument, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  GET_SELF(TYPE_TYPED_ARRAY)
+  struct typed_array *array = self->value.as_typed_array;
+  size_t n = array->length;
+  switch (array->kind) {
+  case TYPED_ARRAY_U8: {
+    const uint8_t *data = array->data;
+    uint64_t total = 0; // cannot overflow below 2^56 elements
+    for (size_t i = 0; i < n; i++)
+      total += data[i];
+    return new_number_object_from_int64((int64_t)total);
+  }
+  case TYPED_ARRAY_I64:
+    return sum_i64(array->data, n);
+  case TYPED_ARRAY_F64:
+    return box_double(sum_f64(array->data, NULL, n), err);
+  }
+  return ARGON_NULL;
+})
+
+#define EXTREME_LOOP(T, CMP)                                                   \
+  {                                                                            \
+    const T *data = array->data;                                               \
+    T best = data[0];                                                          \
+    for (size_t i = 1; i < array->length; i++)                                 \
+      best = data[i] CMP best ? data[i] : best;                                \
+    result = best;                                                             \
+  }
+
+static ArgonObject *extreme(ArgonObject *self, bool largest, ArErr *err) {
+  struct typed_array *array = self->value.as_typed_array;
+  if (!array->length) {
+    *err = create_err(ValueError, "%s of an empty typed array",
+                      largest ? "max" : "min");
+    return ARGON_NULL;
+  }
+  switch (array->kind) {
+  case TYPED_ARRAY_U8: {
+    uint8_t result;
+    if (largest)
+      EXTREME_LOOP(uint8_t, >)
+    else
+      EXTREME_LOOP(uint8_t, <)
+    return new_number_object_from_int64(result);
+  }
+  case TYPED_ARRAY_I64: {
+    int64_t result;
+    if (largest)
+      EXTREME_LOOP(int64_t, >)
+    else
+      EXTREME_LOOP(int64_t, <)
+    return new_number_object_from_int64(result);
+  }
+  case TYPED_ARRAY_F64: {
+    double result;
+    if (largest)
+      EXTREME_LOOP(double, >)
+    else
+      EXTREME_LOOP(double, <)
+    return box_double(result, err);
+  }
+  }
+  return ARGON_NULL;
+}
+
+#undef EXTREME_LOOP
+
+ARGON_METHOD(TYPED_ARRAY_TYPE, min, {
+  (void)state;
+  if (argc != 1) {
+    *err = create_err(RuntimeError, "min expects 1 argument, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  GET_SELF(TYPE_TYPED_ARRAY)
+  return extreme(self, false, err);
+})
+
+ARGON_METHOD(TYPED_ARRAY_TYPE, max, {
+  (void)state;
+  if (argc != 1) {
+    *err = create_err(RuntimeError, "max expects 1 argument, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  GET_SELF(TYPE_TYPED_ARRAY)
+  return extreme(self, true, err);
+})
+
+ARGON_METHOD(TYPED_ARRAY_TYPE, dot, {
+  (void)state;
+  if (argc != 2) {
+    *err = create_err(RuntimeError, "dot expects 2 arguments, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  GET_SELF(TYPE_TYPED_ARRAY)
+  if (argv[1]->type != TYPE_TYPED_ARRAY)
+    return api->throw_argon_error(err, TypeError,
+                                  "dot expects a typed array");
+  struct typed_array *a = self->value.as_typed_array;
+  struct typed_array *b = argv[1]->value.as_typed_array;
+  if (a->length != b->length)
+    return api->throw_argon_error(
+        err, ValueError,
+        "typed arrays have different lengths, %" PRIu64 " and %" PRIu64,
+        (uint64_t)a->length, (uint64_t)b->length);
+  typed_array_kind kind = a->kind > b->kind ? a->kind : b->kind;
+  size_t n = a->length;
+  switch (kind) {
+  case TYPED_ARRAY_U8: {
+    // 255 * 255 * n stays well inside 64 bits for any array that fits
+    const uint8_t *x = a->data;
+    const uint8_t *y = b->data;
+    uint64_t total = 0;
+    for (size_t i = 0; i < n; i++)
+      total += (uint32_t)x[i] * y[i];
+    return new_number_object_from_int64((int64_t)total);
+  }
+  case TYPED_ARRAY_I64:
+    return dot_i64(widened(a, kind), widened(b, kind), n);
+  case TYPED_ARRAY_F64:
+    return box_double(sum_f64(widened(a, kind), widened(b, kind), n), err);
+  }
+  return ARGON_NULL;
+})
+
+static int compare_i64(const void *a, const void *b) {
+  int64_t x = *(const int64_t *)a;
+  int64_t y = *(const int64_t *)b;
+  return (x > y) - (x < y);
+}
+
+// NaN compares false against everything, which would leave qsort without a
+// consistent order. it sorts after every number instead.
+static int compare_f64(const void *a, const void *b) {
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+  int x_nan = isnan(x) != 0;
+  int y_nan = isnan(y) != 0;
+  if (x_nan || y_nan)
+    return x_nan - y_nan;
+  return (x > y) - (x < y);
+}
+
+ARGON_METHOD(TYPED_ARRAY_TYPE, sort, {
+  (void)state;
+  if (argc != 1) {
+    *err = create_err(RuntimeError, "sort expects 1 argument, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  GET_SELF(TYPE_TYPED_ARRAY)
+  struct typed_array *array = self->value.as_typed_array;
+  if (!array->length)
+    return self;
+  switch (array->kind) {
+  case TYPED_ARRAY_U8: {
+    // a counting sort, there are only 256 keys
+    uint8_t *data = array->data;
+    size_t counts[256] = {0};
+    for (size_t i = 0; i < array->length; i++)
+      counts[data[i]]++;
+    size_t at = 0;
+    for (unsigned value = 0; value < 256; value++) {
+      memset(data + at, (int)value, counts[value]);
+      at += counts[value];
+    }
+    break;
+  }
+  case TYPED_ARRAY_I64:
+    qsort(array->data, array->length, sizeof(int64_t), compare_i64);
+    break;
+  case TYPED_ARRAY_F64:
+    qsort(array->data, array->length, sizeof(double), compare_f64);
+    break;
+  }
+  return self; // sorts in place like array.sort
+})
+
+ARGON_METHOD(TYPED_ARRAY_TYPE, to_buffer, {
+  (void)state;
+  if (argc != 1) {
+    *err = create_err(RuntimeError,
+                      "to_buffer expects 1 argument, got %" PRIu64, argc);
+    return ARGON_NULL;
+  }
+  GET_SELF(TYPE_TYPED_ARRAY)
+  struct typed_array *array = self->value.as_typed_array;
+  if (!array->data)
+    return create_ARGON_BUFFER_object(0);
+  // no copy, the buffer and the array share the bytes until either regrows
+  return create_ARGON_BUFFER_view(
+      array->data, array->length * element_sizes[array->kind], self);
+})
+
+ARGON_METHOD(TYPED_ARRAY_TYPE, __iter__, {
+  (void)api;
+  (void)state;
+  if (argc != 1) {
+    *err = create_err(RuntimeError, "__iter__ expects 1 argument, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  ArgonObject *iterator = new_instance(TYPED_ARRAY_ITERATOR_TYPE,
+                                       sizeof(struct as_typed_array_iterator));
+  iterator->type = TYPE_TYPED_ARRAY_ITERATOR;
+  iterator->value.as_typed_array_iterator =
+      (struct as_typed_array_iterator *)((char *)iterator +
+                                         sizeof(ArgonObject));
+  iterator->value.as_typed_array_iterator->current = 0;
+  iterator->value.as_typed_array_iterator->array = argv[0];
+  return iterator;
+})
+
+ARGON_METHOD(TYPED_ARRAY_ITERATOR_TYPE, __next__, {
+  (void)api;
+  (void)state;
+  if (argc != 1) {
+    *err = create_err(RuntimeError, "__next__ expects 1 argument, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  struct as_typed_array_iterator *iterator =
+      argv[0]->value.as_typed_array_iterator;
+  struct typed_array *array = iterator->array->value.as_typed_array;
+  if (iterator->current >= array->length) {
+    err->ptr = StopIteration_instance;
+    return ARGON_NULL;
+  }
+  return box_element(array, iterator->current++, err);
+})
+
+void init_typed_array_type() {
+  TYPED_ARRAY_TYPE = new_class();
+  add_builtin_field(TYPED_ARRAY_TYPE, __name__,
+                    new_string_object_null_terminated("typed_array"));
+  MOUNT_ARGON_METHOD(TYPED_ARRAY_TYPE, __new__)
+  MOUNT_ARGON_METHOD(TYPED_ARRAY_TYPE, __string__)
+  MOUNT_ARGON_METHOD(TYPED_ARRAY_TYPE, get_length)
+  MOUNT_ARGON_METHOD(TYPED_ARRAY_TYPE, set_length)
+  MOUNT_ARGON_METHOD(TYPED_ARRAY_TYPE, append)
+  MOUNT_ARGON_METHOD(TYPED_ARRAY_TYPE, __getitem__)
+  MOUNT_ARGON_METHOD(TYPED_ARRAY_TYPE, __setitem__)
+  MOUNT_ARGON_METHOD(TYPED_ARRAY_TYPE, __add__)
+  MOUNT_ARGON_METHOD(TYPED_ARRAY_TYPE, __subtract__)
+  MOUNT_ARGON_METHOD(TYPED_ARRAY_TYPE, __multiply__)
+  MOUNT_ARGON_METHOD(TYPED_ARRAY_TYPE, __division__)
+  MOUNT_ARGON_METHOD(TYPED_ARRAY_TYPE, sum)
+  MOUNT_ARGON_METHOD(TYPED_ARRAY_TYPE, min)
+  MOUNT_ARGON_METHOD(TYPED_ARRAY_TYPE, max)
+  MOUNT_ARGON_METHOD(TYPED_ARRAY_TYPE, dot)
+  MOUNT_ARGON_METHOD(TYPED_ARRAY_TYPE, sort)
+  MOUNT_ARGON_METHOD(TYPED_ARRAY_TYPE, to_buffer)
+  MOUNT_ARGON_METHOD(TYPED_ARRAY_TYPE, __iter__)
+
+  for (typed_array_kind kind = TYPED_ARRAY_U8; kind <= TYPED_ARRAY_F64;
+       kind++) {
+    kind_classes[kind] = new_class();
+    add_builtin_field(kind_classes[kind], __base__, TYPED_ARRAY_TYPE);
+    add_builtin_field(kind_classes[kind], __name__,
+                      new_string_object_null_terminated(
+                          (char *)kind_names[kind]));
+  }
+  add_builtin_field(ARRAY_TYPE, u8, kind_classes[TYPED_ARRAY_U8]);
+  add_builtin_field(ARRAY_TYPE, i64, kind_classes[TYPED_ARRAY_I64]);
+  add_builtin_field(ARRAY_TYPE, f64, kind_classes[TYPED_ARRAY_F64]);
+
+  TYPED_ARRAY_ITERATOR_TYPE = new_class();
+  add_builtin_field(TYPED_ARRAY_ITERATOR_TYPE, __name__,
+                    new_string_object_null_terminated("typed_array_iterator"));
+  MOUNT_ARGON_METHOD(TYPED_ARRAY_ITERATOR_TYPE, __next__)
+}
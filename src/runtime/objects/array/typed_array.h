@@ -0,0 +1,20 @@
+/*
+ * SPDX-FileCopyrightText: 2026 William Bell
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef TYPED_ARRAY_OBJECT
+#define TYPED_ARRAY_OBJECT
+#include "../object.h"
+
+extern ArgonObject *TYPED_ARRAY_TYPE;
+extern ArgonObject *TYPED_ARRAY_ITERATOR_TYPE;
+
+// mounts array.u8, array.i64 and array.f64. needs the array and buffer types.
+void init_typed_array_type();
+
+// a zero filled typed array of the given kind and length.
+ArgonObject *create_typed_array(typed_array_kind kind, size_t length);
+
+#endif // TYPED_ARRAY_OBJECT
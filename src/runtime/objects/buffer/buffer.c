@@ -16,6 +16,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 ArgonObject *ARGON_BUFFER_TYPE = NULL;
@@ -30,6 +31,50 @@ ArgonObject *create_ARGON_BUFFER_object(size_t size) {
   return object;
 }
 
+// a view carries a reference to whatever owns its bytes. as_buffer points at
+// the first member, so the rest of the runtime sees a plain buffer.
+struct buffer_view {
+  struct buffer buffer;
+  ArgonObject *owner;
+};
+
+ArgonObject *create_ARGON_BUFFER_view(void *data, size_t size,
+                                      ArgonObject *owner) {
+  ArgonObject *object =
+      new_instance(ARGON_BUFFER_TYPE, sizeof(struct buffer_view));
+  object->type = TYPE_BUFFER;
+  struct buffer_view *view =
+      (struct buffer_view *)((char *)object + sizeof(ArgonObject));
+  view->buffer.data = data;
+  view->buffer.size = size;
+  view->owner = owner;
+  object->value.as_buffer = &view->buffer;
+  return object;
+}
+
+struct buffer_release {
+  void *data;
+  size_t size;
+  void (*release)(void *data, size_t size);
+};
+
+static void release_external_buffer(void *object, void *client_data) {
+  (void)object;
+  struct buffer_release *external = client_data;
+  external->release(external->data, external->size);
+  free(external);
+}
+
+ArgonObject *create_ARGON_BUFFER_external(void *data, size_t size,
+                                          void (*release)(void *data,
+                                                          size_t size)) {
+  ArgonObject *object = create_ARGON_BUFFER_view(data, size, NULL);
+  struct buffer_release *external = checked_malloc(sizeof(*external));
+  *external = (struct buffer_release){data, size, release};
+  ar_finalizer(object, release_external_buffer, external, NULL, NULL);
+  return object;
+}
+
 ARGON_METHOD(ARGON_BUFFER_TYPE, from_string, {
   (void)state;
   if (api->fix_to_arg_size(1, argc, err))
@@ -260,13 +305,12 @@ void resize_ARGON_BUFFER_object(ArgonObject *obj, ArErr *err, size_t new_size) {
     *err = create_err(RuntimeError, "expected buffer object");
     return;
   }
-  void *new_data = ar_realloc(obj->value.as_buffer->data, new_size);
-  if (!new_data) {
-    *err = create_err(RuntimeError,
-                      "failed to reallocate the buffer to size %" PRIu64,
-                      new_size);
-    return;
-  }
+  // the old bytes may be shared with a typed array, so they are copied
+  // rather than reallocated and left for the collector.
+  void *new_data = ar_alloc(new_size);
+  size_t old_size = obj->value.as_buffer->size;
+  memcpy(new_data, obj->value.as_buffer->data,
+         old_size < new_size ? old_size : new_size);
   obj->value.as_buffer->data = new_data;
   obj->value.as_buffer->size = new_size;
 }
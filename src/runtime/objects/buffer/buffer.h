@@ -12,6 +12,15 @@
 
 extern ArgonObject *ARGON_BUFFER_TYPE;
 ArgonObject *create_ARGON_BUFFER_object(size_t size);
+// wraps existing memory without copying it. owner, if given, is kept alive
+// for as long as the view is.
+ArgonObject *create_ARGON_BUFFER_view(void *data, size_t size,
+                                      ArgonObject *owner);
+// wraps memory from outside the collector, calling release on it once the
+// buffer is collected.
+ArgonObject *create_ARGON_BUFFER_external(void *data, size_t size,
+                                          void (*release)(void *data,
+                                                          size_t size));
 void resize_ARGON_BUFFER_object(ArgonObject *obj, ArErr *err, size_t new_size);
 struct buffer ARGON_BUFFER_to_buffer_struct(ArgonObject *obj,
                                                    ArErr *err);
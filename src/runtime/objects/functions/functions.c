@@ -4,8 +4,14 @@
  * SPDX-License-Identifier: GPL-3.0-or-later
  */
 
+#include "functions.h"
+#include "../../../RWLock.h"
+#include "../../../memory.h"
+#include "../../../translator/translator.h"
+#include "../../runtime.h"
 #include "../object.h"
 #include "../string/string.h"
+#include <stdatomic.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
@@ -19,4 +25,46 @@ ArgonObject *create_argon_native_function(char *name, native_fn native_fn) {
                     new_string_object(name, strlen(name), 0));
   object->value.native_fn = native_fn;
   return object;
-}
\ No newline at end of file
+}
+static uint64_t read_toc_entry(uint8_t *toc, size_t entry) {
+  return bytes_to_uint64(toc + entry * sizeof(uint64_t));
+}
+
+static struct string_struct read_toc_name(struct argon_function_struct *function,
+                                          uint8_t *toc, size_t entry) {
+  return (struct string_struct){
+      .hash = read_toc_entry(toc, entry + 2),
+      .data = arena_get(&function->translated.constants,
+                        read_toc_entry(toc, entry)),
+      .length = read_toc_entry(toc, entry + 1)};
+}
+
+// decoding is done once, under a lock, by whichever thread calls the function
+// first. a thread that sees toc as NULL also sees the parameters it published.
+static RWLock function_parameters_lock = RWLOCK_INIT;
+
+void load_function_parameters(struct argon_function_struct *function) {
+  if (!atomic_load_explicit(&function->toc, memory_order_acquire))
+    return;
+  RWLOCK_WRLOCK(function_parameters_lock, {
+    uint8_t *toc = atomic_load_explicit(&function->toc, memory_order_relaxed);
+    if (toc) {
+      uint64_t flags = read_toc_entry(toc, FUNCTION_TOC_FLAGS);
+      struct string_struct *parameters = NULL;
+      if (function->number_of_parameters)
+        parameters = ar_alloc(function->number_of_parameters *
+                              sizeof(struct string_struct));
+      size_t entry = FUNCTION_TOC_HEADER_SIZE;
+      for (size_t i = 0; i < function->number_of_parameters; i++, entry += 3)
+        parameters[i] = read_toc_name(function, toc, entry);
+      if (flags & FUNCTION_TOC_HAS_VARGS) {
+        function->vargs = read_toc_name(function, toc, entry);
+        entry += 3;
+      }
+      if (flags & FUNCTION_TOC_HAS_KWARGS)
+        function->kwargs = read_toc_name(function, toc, entry);
+      function->parameters = parameters;
+      atomic_store_explicit(&function->toc, NULL, memory_order_release);
+    }
+  });
+}
@@ -10,4 +10,8 @@
 
 extern ArgonObject *ARGON_FUNCTION_TYPE;
 
+// decode the parameter names from the functions table of contents, done on the
+// first call rather than when the function is defined
+void load_function_parameters(struct argon_function_struct *function);
+
 #endif // FUNCTION_H
\ No newline at end of file
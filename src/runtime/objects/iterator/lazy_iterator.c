@@ -0,0 +1,418 @@
+/*
+ * SPDX-FileCopyrightText: 2026 William Bell
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+#include "lazy_iterator.h"
+#include "../../../err.h"
+#include "../../../memory.h"
+#include "../../api/api.h"
+#include "../../call/call.h"
+#include "../../runtime.h"
+#include "../array/array.h"
+#include "../dictionary/dictionary.h"
+#include "../exceptions/exceptions.h"
+#include "../literals/literals.h"
+#include "../number/number.h"
+#include "../string/string.h"
+#include "../tuple/tuple.h"
+#include "range_iterator.h"
+#include <inttypes.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * iter.map, iter.filter and the rest build one lazy iterator each, pulling
+ * from their source only when asked for the next item. a chained pipeline
+ * never holds more than the current item (or the current chunk or window),
+ * and stepping a source that is itself a built in iterator skips the
+ * argon call entirely.
+ */
+
+ArgonObject *LAZY_ITERATOR_TYPE;
+
+ArgonObject *iterator_next(ArgonObject *iterator, ArgonObject *next,
+                           ArErr *err, RuntimeState *state) {
+  switch (iterator->type) {
+  case TYPE_ARRAY_ITERATOR:
+    return ARGON_FUNC_ARRAY_ITERATOR_TYPE___next__(1, &iterator, NULL, err,
+                                                   state, &native_api);
+  case TYPE_RANGE_ITERATOR:
+    return ARGON_FUNC_ARGON_RANGE_ITERATOR_TYPE___next__(1, &iterator, NULL, err,
+                                                         state, &native_api);
+  case TYPE_STRING_ITERATOR:
+    return ARGON_FUNC_ARGON_STRING_ITERATOR_TYPE___next__(
+        1, &iterator, NULL, err, state, &native_api);
+  case TYPE_DICTIONARY_ITERATOR:
+    return ARGON_FUNC_ARGON_DICTIONARY_ITERATOR_TYPE___next__(
+        1, &iterator, NULL, err, state, &native_api);
+  case TYPE_LAZY_ITERATOR:
+    return ARGON_FUNC_LAZY_ITERATOR_TYPE___next__(1, &iterator, NULL, err,
+                                                  state, &native_api);
+  default:
+    return argon_call(next, 0, NULL, NULL, err, state);
+  }
+}
+
+static bool get_iterator(ArgonObject *iterable, ArgonObject **iterator,
+                         ArgonObject **next, ArErr *err, RuntimeState *state) {
+  ArgonObject *iter_method =
+      get_builtin_field_for_class(CLASS_OF(iterable), __iter__, iterable);
+  if (!iter_method) {
+    *err = create_err(TypeError, "object is not iterable");
+    return false;
+  }
+  *iterator = argon_call(iter_method, 0, NULL, NULL, err, state);
+  if (is_error(err))
+    return false;
+  *next = get_builtin_field_for_class(CLASS_OF(*iterator), __next__, *iterator);
+  if (!*next) {
+    *err = create_err(RuntimeError,
+                      "unable to get __next__ from objects iterator class");
+    return false;
+  }
+  return true;
+}
+
+static ArgonObject *create_lazy_iterator(lazy_iterator_kind kind,
+                                         ArgonObject **iterables,
+                                         size_t count, ArErr *err,
+                                         RuntimeState *state) {
+  ArgonObject *object =
+      new_instance(LAZY_ITERATOR_TYPE, sizeof(struct as_lazy_iterator));
+  object->type = TYPE_LAZY_ITERATOR;
+  struct as_lazy_iterator *lazy = object->value.as_lazy_iterator =
+      (struct as_lazy_iterator *)((char *)object + sizeof(ArgonObject));
+  *lazy = (struct as_lazy_iterator){.kind = kind, .source_count = count};
+  lazy->sources = ar_alloc(count * sizeof(ArgonObject *));
+  lazy->nexts = ar_alloc(count * sizeof(ArgonObject *));
+  for (size_t i = 0; i < count; i++) {
+    if (!get_iterator(iterables[i], &lazy->sources[i], &lazy->nexts[i], err,
+                      state))
+      return NULL;
+  }
+  return object;
+}
+
+static bool get_count(ArgonObject *object, const char *name, int64_t minimum,
+                      int64_t *count, ArErr *err) {
+  if (object->type != TYPE_NUMBER || !object->value.as_number->is_int64) {
+    *err = create_err(TypeError, "%s expects an integer", name);
+    return false;
+  }
+  *count = object->value.as_number->n.i64;
+  if (*count < minimum) {
+    *err = create_err(ValueError, "%s must be at least %" PRId64 ", got %" PRId64,
+                      name, minimum, *count);
+    return false;
+  }
+  return true;
+}
+
+static bool is_truthy(ArgonObject *value, ArErr *err, RuntimeState *state) {
+  if (value == ARGON_TRUE)
+    return true;
+  if (value == ARGON_FALSE)
+    return false;
+  if (value->type != TYPE_OBJECT)
+    return value->as_bool;
+  ArgonObject *args[] = {ARGON_BOOL_TYPE, value};
+  return ARGON_FUNC_ARGON_BOOL_TYPE___new__(2, args, NULL, err, state, NULL) ==
+         ARGON_TRUE;
+}
+
+static inline ArgonObject *source_next(struct as_lazy_iterator *lazy,
+                                       size_t index, ArErr *err,
+                                       RuntimeState *state) {
+  return iterator_next(lazy->sources[index], lazy->nexts[index], err, state);
+}
+
+// native sources hand back the shared instance, an argon __next__ usually
+// throws a fresh StopIteration()
+static inline bool is_stop_iteration(ArErr *err) {
+  return is_error(err) && (err->ptr == StopIteration_instance ||
+                           is_instance(err->ptr, StopIteration));
+}
+
+static ArgonObject *stop_iteration(struct as_lazy_iterator *lazy, ArErr *err) {
+  lazy->done = true;
+  err->ptr = StopIteration_instance;
+  return ARGON_NULL;
+}
+
+ARGON_METHOD(LAZY_ITERATOR_TYPE, __iter__, {
+  (void)err;
+  (void)state;
+  (void)api;
+  return argv[0];
+})
+
+ARGON_METHOD(LAZY_ITERATOR_TYPE, __next__, {
+  (void)api;
+  if (argc != 1) {
+    *err = create_err(RuntimeError, "__next__ expects 1 argument, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  struct as_lazy_iterator *lazy = argv[0]->value.as_lazy_iterator;
+  if (lazy->done)
+    return stop_iteration(lazy, err);
+
+  switch (lazy->kind) {
+  case LAZY_MAP: {
+    ArgonObject *item = source_next(lazy, 0, err, state);
+    if (is_error(err))
+      return ARGON_NULL;
+    return argon_call(lazy->fn, 1, &item, NULL, err, state);
+  }
+  case LAZY_FILTER:
+    while (true) {
+      ArgonObject *item = source_next(lazy, 0, err, state);
+      if (is_error(err))
+        return ARGON_NULL;
+      ArgonObject *keep = argon_call(lazy->fn, 1, &item, NULL, err, state);
+      if (is_error(err))
+        return ARGON_NULL;
+      bool truthy = is_truthy(keep, err, state);
+      if (is_error(err))
+        return ARGON_NULL;
+      if (truthy)
+        return item;
+    }
+  case LAZY_TAKE:
+    if (lazy->count == 0)
+      return stop_iteration(lazy, err);
+    lazy->count--;
+    return source_next(lazy, 0, err, state);
+  case LAZY_SKIP:
+    for (; lazy->count > 0; lazy->count--) {
+      source_next(lazy, 0, err, state);
+      if (is_error(err))
+        return ARGON_NULL;
+    }
+    return source_next(lazy, 0, err, state);
+  case LAZY_ZIP: {
+    // the tuple copies the items, so the row is reused
+    ArgonObject **items = lazy->window;
+    for (size_t i = 0; i < lazy->source_count; i++) {
+      items[i] = source_next(lazy, i, err, state);
+      if (is_error(err))
+        return ARGON_NULL;
+    }
+    return ARGON_FUNC_TUPLE_CREATE(lazy->source_count, items, NULL, err, state,
+                                   &native_api);
+  }
+  case LAZY_ENUMERATE: {
+    ArgonObject *items[2];
+    items[1] = source_next(lazy, 0, err, state);
+    if (is_error(err))
+      return ARGON_NULL;
+    items[0] = new_number_object_from_int64(lazy->count++);
+    return ARGON_FUNC_TUPLE_CREATE(2, items, NULL, err, state, &native_api);
+  }
+  case LAZY_CHAIN:
+    while (lazy->current_source < lazy->source_count) {
+      ArgonObject *item = source_next(lazy, lazy->current_source, err, state);
+      if (!is_stop_iteration(err))
+        return item;
+      *err = no_err;
+      // let the finished source be collected while the rest run
+      lazy->sources[lazy->current_source] = NULL;
+      lazy->nexts[lazy->current_source] = NULL;
+      lazy->current_source++;
+    }
+    return stop_iteration(lazy, err);
+  case LAZY_CHUNK: {
+    ArgonObject **items = ar_alloc(lazy->count * sizeof(ArgonObject *));
+    size_t length = 0;
+    while (length < (size_t)lazy->count) {
+      ArgonObject *item = source_next(lazy, 0, err, state);
+      if (is_stop_iteration(err)) {
+        if (!length)
+          return stop_iteration(lazy, err);
+        // a short last chunk, the next call stops
+        *err = no_err;
+        lazy->done = true;
+        break;
+      }
+      if (is_error(err))
+        return ARGON_NULL;
+      items[length++] = item;
+    }
+    return create_array(items, length);
+  }
+  case LAZY_WINDOW: {
+    if (lazy->window_length == (size_t)lazy->count) {
+      memmove(lazy->window, lazy->window + 1,
+              (lazy->window_length - 1) * sizeof(ArgonObject *));
+      lazy->window_length--;
+    }
+    while (lazy->window_length < (size_t)lazy->count) {
+      ArgonObject *item = source_next(lazy, 0, err, state);
+      if (is_stop_iteration(err))
+        return stop_iteration(lazy, err);
+      if (is_error(err))
+        return ARGON_NULL;
+      lazy->window[lazy->window_length++] = item;
+    }
+    return create_array(lazy->window, lazy->window_length);
+  }
+  }
+  return ARGON_NULL;
+})
+
+// iter.map(fn, iterable)
+ARGON_METHOD(iter, map, {
+  (void)api;
+  if (argc != 2) {
+    *err = create_err(RuntimeError, "map expects 2 arguments, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  ArgonObject *object = create_lazy_iterator(LAZY_MAP, argv + 1, 1, err, state);
+  if (!object)
+    return ARGON_NULL;
+  object->value.as_lazy_iterator->fn = argv[0];
+  return object;
+})
+
+// iter.filter(fn, iterable)
+ARGON_METHOD(iter, filter, {
+  (void)api;
+  if (argc != 2) {
+    *err = create_err(RuntimeError, "filter expects 2 arguments, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  ArgonObject *object =
+      create_lazy_iterator(LAZY_FILTER, argv + 1, 1, err, state);
+  if (!object)
+    return ARGON_NULL;
+  object->value.as_lazy_iterator->fn = argv[0];
+  return object;
+})
+
+// iter.take(iterable, n)
+ARGON_METHOD(iter, take, {
+  (void)api;
+  if (argc != 2) {
+    *err = create_err(RuntimeError, "take expects 2 arguments, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  int64_t count;
+  if (!get_count(argv[1], "take", 0, &count, err))
+    return ARGON_NULL;
+  ArgonObject *object = create_lazy_iterator(LAZY_TAKE, argv, 1, err, state);
+  if (!object)
+    return ARGON_NULL;
+  object->value.as_lazy_iterator->count = count;
+  return object;
+})
+
+// iter.skip(iterable, n)
+ARGON_METHOD(iter, skip, {
+  (void)api;
+  if (argc != 2) {
+    *err = create_err(RuntimeError, "skip expects 2 arguments, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  int64_t count;
+  if (!get_count(argv[1], "skip", 0, &count, err))
+    return ARGON_NULL;
+  ArgonObject *object = create_lazy_iterator(LAZY_SKIP, argv, 1, err, state);
+  if (!object)
+    return ARGON_NULL;
+  object->value.as_lazy_iterator->count = count;
+  return object;
+})
+
+// iter.zip(iterables...), stopping with the shortest
+ARGON_METHOD(iter, zip, {
+  (void)api;
+  if (argc < 1) {
+    *err = create_err(RuntimeError,
+                      "zip expects at least 1 argument, got %" PRIu64, argc);
+    return ARGON_NULL;
+  }
+  ArgonObject *object = create_lazy_iterator(LAZY_ZIP, argv, argc, err, state);
+  if (!object)
+    return ARGON_NULL;
+  object->value.as_lazy_iterator->window =
+      ar_alloc(argc * sizeof(ArgonObject *));
+  return object;
+})
+
+// iter.enumerate(iterable, start?)
+ARGON_METHOD(iter, enumerate, {
+  (void)api;
+  if (argc != 1 && argc != 2) {
+    *err = create_err(RuntimeError,
+                      "enumerate expects 1 or 2 arguments, got %" PRIu64, argc);
+    return ARGON_NULL;
+  }
+  int64_t start = 0;
+  if (argc == 2 && !get_count(argv[1], "start", INT64_MIN, &start, err))
+    return ARGON_NULL;
+  ArgonObject *object =
+      create_lazy_iterator(LAZY_ENUMERATE, argv, 1, err, state);
+  if (!object)
+    return ARGON_NULL;
+  object->value.as_lazy_iterator->count = start;
+  return object;
+})
+
+// iter.chain(iterables...)
+ARGON_METHOD(iter, chain, {
+  (void)api;
+  ArgonObject *object =
+      create_lazy_iterator(LAZY_CHAIN, argv, argc, err, state);
+  return object ? object : ARGON_NULL;
+})
+
+// iter.chunk(iterable, size), the last chunk may be short
+ARGON_METHOD(iter, chunk, {
+  (void)api;
+  if (argc != 2) {
+    *err = create_err(RuntimeError, "chunk expects 2 arguments, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  int64_t size;
+  if (!get_count(argv[1], "chunk size", 1, &size, err))
+    return ARGON_NULL;
+  ArgonObject *object = create_lazy_iterator(LAZY_CHUNK, argv, 1, err, state);
+  if (!object)
+    return ARGON_NULL;
+  object->value.as_lazy_iterator->count = size;
+  return object;
+})
+
+// iter.window(iterable, size), each overlapping run of size items
+ARGON_METHOD(iter, window, {
+  (void)api;
+  if (argc != 2) {
+    *err = create_err(RuntimeError, "window expects 2 arguments, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  int64_t size;
+  if (!get_count(argv[1], "window size", 1, &size, err))
+    return ARGON_NULL;
+  ArgonObject *object = create_lazy_iterator(LAZY_WINDOW, argv, 1, err, state);
+  if (!object)
+    return ARGON_NULL;
+  object->value.as_lazy_iterator->count = size;
+  object->value.as_lazy_iterator->window =
+      ar_alloc(size * sizeof(ArgonObject *));
+  return object;
+})
+
+void init_lazy_iterator() {
+  LAZY_ITERATOR_TYPE = new_class();
+  add_builtin_field(LAZY_ITERATOR_TYPE, __name__,
+                    new_string_object_null_terminated("lazy_iterator"));
+  MOUNT_ARGON_METHOD(LAZY_ITERATOR_TYPE, __iter__)
+  MOUNT_ARGON_METHOD(LAZY_ITERATOR_TYPE, __next__)
+}
@@ -0,0 +1,32 @@
+/*
+ * SPDX-FileCopyrightText: 2026 William Bell
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef RUNTIME_LAZY_ITERATOR_H
+#define RUNTIME_LAZY_ITERATOR_H
+#include "../object.h"
+
+extern ArgonObject *LAZY_ITERATOR_TYPE;
+
+void init_lazy_iterator();
+
+// steps any iterator, calling the native __next__ directly for the built in
+// iterator types and going through next otherwise.
+ArgonObject *iterator_next(ArgonObject *iterator, ArgonObject *next,
+                           ArErr *err, RuntimeState *state);
+
+EXPOSE_ARGON_METHOD(LAZY_ITERATOR_TYPE, __next__)
+
+EXPOSE_ARGON_METHOD(iter, map)
+EXPOSE_ARGON_METHOD(iter, filter)
+EXPOSE_ARGON_METHOD(iter, take)
+EXPOSE_ARGON_METHOD(iter, skip)
+EXPOSE_ARGON_METHOD(iter, zip)
+EXPOSE_ARGON_METHOD(iter, enumerate)
+EXPOSE_ARGON_METHOD(iter, chain)
+EXPOSE_ARGON_METHOD(iter, chunk)
+EXPOSE_ARGON_METHOD(iter, window)
+
+#endif // RUNTIME_LAZY_ITERATOR_H
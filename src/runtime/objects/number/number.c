@@ -580,6 +580,12 @@ uint64_t hash_mpq(mpq_t q) {
   return mix64(h);
 }
 
+uint64_t hash_number_object(ArgonObject *object) {
+  if (object->value.as_number->is_int64)
+    return mix64(object->value.as_number->n.i64);
+  return hash_mpq(*object->value.as_number->n.mpq);
+}
+
 ARGON_METHOD(ARGON_NUMBER_TYPE, __hash__, {
   (void)api;
   (void)state;
@@ -587,13 +593,7 @@ ARGON_METHOD(ARGON_NUMBER_TYPE, __hash__, {
     *err = create_err(RuntimeError, "__hash__ expects 1 argument, got %" PRIu64,
                       argc);
   }
-  uint64_t hash;
-  if (argv[0]->value.as_number->is_int64) {
-    hash = mix64(argv[0]->value.as_number->n.i64);
-  } else {
-    hash = hash_mpq(*argv[0]->value.as_number->n.mpq);
-  }
-  return new_number_object_from_int64(hash);
+  return new_number_object_from_int64(hash_number_object(argv[0]));
 })
 
 ARGON_METHOD(ARGON_NUMBER_TYPE, __division__, {
@@ -29,6 +29,8 @@ ArgonObject *new_number_object_from_num_and_den(int64_t n, int64_t d);
 
 ArgonObject *new_number_object_from_int64(int64_t i64);
 
+uint64_t hash_number_object(ArgonObject *object);
+
 void mpq_pow_q(mpq_t rop, const mpq_t e, const mpq_t n);
 
 void mpq_fdiv(mpq_t result, const mpq_t a, const mpq_t b);
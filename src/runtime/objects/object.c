@@ -10,6 +10,10 @@
 #include "../../memory.h"
 #include "../call/call.h"
 #include "exceptions/exceptions.h"
+#include "literals/literals.h"
+#include "number/number.h"
+#include "string/string.h"
+#include "tuple/tuple.h"
 #include "type/type.h"
 #include <gc/gc.h>
 #include <pthread.h>
@@ -101,9 +105,14 @@ static ThreadLocalPool *get_thread_pool(void) {
 void unregister_thread_pool() {
 #ifdef _WIN32
   ThreadLocalPool *pool = (ThreadLocalPool *)TlsGetValue(tls_index);
+  // a thread can register again later, so it must not see the freed pool
+  TlsSetValue(tls_index, NULL);
 #endif
   if (pool)
     GC_free(pool);
+#ifndef _WIN32
+  pool = NULL;
+#endif
 }
 
 ArgonObject *new_small_object(size_t endSize) {
@@ -151,8 +160,30 @@ void init_built_in_field_hashes() {
 }
 
 int64_t hash_object(ArgonObject *object, ArErr *err, RuntimeState *state) {
-  ArgonObject *hash_function = get_builtin_field_for_class(
-      get_builtin_field(object, __class__), __hash__, object);
+  // built in types are hashed directly, the same way their __hash__ would,
+  // so only classes with their own __hash__ pay for a call.
+  ArgonObject *class = get_builtin_field(object, __class__);
+  switch (object->type) {
+  case TYPE_NULL:
+  case TYPE_BOOL:
+    return (int64_t)object;
+  case TYPE_STRING:
+    if (class == ARGON_STRING_TYPE)
+      return hash_string_object(object);
+    break;
+  case TYPE_NUMBER:
+    if (class == ARGON_NUMBER_TYPE)
+      return hash_number_object(object);
+    break;
+  case TYPE_TUPLE:
+    if (class == ARGON_TUPLE_TYPE)
+      return hash_tuple_object(object, err, state);
+    break;
+  default:
+    break;
+  }
+  ArgonObject *hash_function =
+      get_builtin_field_for_class(class, __hash__, object);
   if (!hash_function) {
     return (int64_t)object;
   }
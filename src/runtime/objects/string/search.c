@@ -0,0 +1,183 @@
+/*
+ * SPDX-FileCopyrightText: 2026 William Bell
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "search.h"
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SEARCH_X86
+#elif defined(__GNUC__) && defined(__aarch64__)
+#include <arm_neon.h>
+#define SEARCH_NEON
+#endif
+
+/*
+ * the vector kernels compare a block of candidate starts against the first
+ * and the last byte of the needle at once, and only run memcmp on positions
+ * where both match. each kernel produces a bitmask with BITS bits per
+ * candidate, and the shared drivers below walk it.
+ */
+
+#define FIND_FORWARD(BLOCK, BITS, MASK)                                        \
+  size_t i = 0;                                                                \
+  for (; m <= n && i + m - 1 + BLOCK <= n; i += BLOCK) {                       \
+    uint64_t mask = MASK(h + i, h + i + m - 1);                                \
+    while (mask) {                                                             \
+      unsigned bit = __builtin_ctzll(mask);                                    \
+      const char *at = h + i + bit / BITS;                                     \
+      if (memcmp(at + 1, needle + 1, m - 1) == 0)                              \
+        return at;                                                             \
+      mask &= ~((((uint64_t)1 << BITS) - 1) << (bit - bit % BITS));           \
+    }                                                                          \
+  }                                                                            \
+  return find_scalar(h + i, n - i, needle, m);
+
+#define FIND_BACKWARD(BLOCK, BITS, MASK)                                       \
+  if (m > n)                                                                   \
+    return NULL;                                                               \
+  size_t end = n - m + 1;                                                      \
+  for (; end >= BLOCK; end -= BLOCK) {                                         \
+    size_t base = end - BLOCK;                                                 \
+    uint64_t mask = MASK(h + base, h + base + m - 1);                          \
+    while (mask) {                                                             \
+      unsigned bit = 63 - __builtin_clzll(mask);                               \
+      const char *at = h + base + bit / BITS;                                  \
+      if (memcmp(at + 1, needle + 1, m - 1) == 0)                              \
+        return at;                                                             \
+      mask &= ~((((uint64_t)1 << BITS) - 1) << (bit - bit % BITS));           \
+    }                                                                          \
+  }                                                                            \
+  return find_last_scalar(h, end + m - 1, needle, m);
+
+static const char *find_scalar(const char *h, size_t n, const char *needle,
+                               size_t m) {
+  if (m > n)
+    return NULL;
+  const char *end = h + n - m + 1;
+  const char *p = h;
+  while (p < end) {
+    p = memchr(p, needle[0], end - p);
+    if (!p)
+      return NULL;
+    if (memcmp(p + 1, needle + 1, m - 1) == 0)
+      return p;
+    p++;
+  }
+  return NULL;
+}
+
+static const char *find_last_scalar(const char *h, size_t n,
+                                    const char *needle, size_t m) {
+  if (m > n)
+    return NULL;
+  for (const char *p = h + n - m;; p--) {
+    if (*p == needle[0] && memcmp(p + 1, needle + 1, m - 1) == 0)
+      return p;
+    if (p == h)
+      return NULL;
+  }
+}
+
+#if defined(SEARCH_X86)
+
+#define SSE2_MASK(a, b)                                                        \
+  (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_and_si128(                         \
+      _mm_cmpeq_epi8(first, _mm_loadu_si128((const __m128i *)(a))),            \
+      _mm_cmpeq_epi8(last, _mm_loadu_si128((const __m128i *)(b)))))
+
+#define AVX2_MASK(a, b)                                                        \
+  (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_and_si256(                   \
+      _mm256_cmpeq_epi8(first, _mm256_loadu_si256((const __m256i *)(a))),      \
+      _mm256_cmpeq_epi8(last, _mm256_loadu_si256((const __m256i *)(b)))))
+
+__attribute__((target("sse2"))) static const char *
+find_sse2(const char *h, size_t n, const char *needle, size_t m) {
+  __m128i first = _mm_set1_epi8(needle[0]);
+  __m128i last = _mm_set1_epi8(needle[m - 1]);
+  FIND_FORWARD(16, 1, SSE2_MASK)
+}
+
+__attribute__((target("sse2"))) static const char *
+find_last_sse2(const char *h, size_t n, const char *needle, size_t m) {
+  __m128i first = _mm_set1_epi8(needle[0]);
+  __m128i last = _mm_set1_epi8(needle[m - 1]);
+  FIND_BACKWARD(16, 1, SSE2_MASK)
+}
+
+__attribute__((target("avx2"))) static const char *
+find_avx2(const char *h, size_t n, const char *needle, size_t m) {
+  __m256i first = _mm256_set1_epi8(needle[0]);
+  __m256i last = _mm256_set1_epi8(needle[m - 1]);
+  FIND_FORWARD(32, 1, AVX2_MASK)
+}
+
+__attribute__((target("avx2"))) static const char *
+find_last_avx2(const char *h, size_t n, const char *needle, size_t m) {
+  __m256i first = _mm256_set1_epi8(needle[0]);
+  __m256i last = _mm256_set1_epi8(needle[m - 1]);
+  FIND_BACKWARD(32, 1, AVX2_MASK)
+}
+
+#elif defined(SEARCH_NEON)
+
+// neon has no movemask, narrowing the compare result gives 4 bits per byte.
+#define NEON_MASK(a, b)                                                        \
+  vget_lane_u64(                                                               \
+      vreinterpret_u64_u8(vshrn_n_u16(                                         \
+          vreinterpretq_u16_u8(vandq_u8(                                       \
+              vceqq_u8(first, vld1q_u8((const uint8_t *)(a))),                 \
+              vceqq_u8(last, vld1q_u8((const uint8_t *)(b))))),                \
+          4)),                                                                 \
+      0)
+
+static const char *find_neon(const char *h, size_t n, const char *needle,
+                             size_t m) {
+  uint8x16_t first = vdupq_n_u8((uint8_t)needle[0]);
+  uint8x16_t last = vdupq_n_u8((uint8_t)needle[m - 1]);
+  FIND_FORWARD(16, 4, NEON_MASK)
+}
+
+static const char *find_last_neon(const char *h, size_t n, const char *needle,
+                                  size_t m) {
+  uint8x16_t first = vdupq_n_u8((uint8_t)needle[0]);
+  uint8x16_t last = vdupq_n_u8((uint8_t)needle[m - 1]);
+  FIND_BACKWARD(16, 4, NEON_MASK)
+}
+
+#endif
+
+typedef const char *(*search_fn)(const char *, size_t, const char *, size_t);
+
+static search_fn find_impl = find_scalar;
+static search_fn find_last_impl = find_last_scalar;
+
+void string_search_init(void) {
+#if defined(SEARCH_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    find_impl = find_avx2;
+    find_last_impl = find_last_avx2;
+  } else if (__builtin_cpu_supports("sse2")) {
+    find_impl = find_sse2;
+    find_last_impl = find_last_sse2;
+  }
+#elif defined(SEARCH_NEON)
+  find_impl = find_neon;
+  find_last_impl = find_last_neon;
+#endif
+}
+
+const char *string_search(const char *haystack, size_t haystack_length,
+                          const char *needle, size_t needle_length) {
+  return find_impl(haystack, haystack_length, needle, needle_length);
+}
+
+const char *string_search_last(const char *haystack, size_t haystack_length,
+                               const char *needle, size_t needle_length) {
+  return find_last_impl(haystack, haystack_length, needle, needle_length);
+}
@@ -0,0 +1,25 @@
+/*
+ * SPDX-FileCopyrightText: 2026 William Bell
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef STRING_SEARCH_H
+#define STRING_SEARCH_H
+#include <stddef.h>
+
+// picks the widest search kernels the cpu supports. must run before any
+// other function here.
+void string_search_init(void);
+
+// returns the first occurrence of needle in haystack, or NULL. needle_length
+// must be at least 1.
+const char *string_search(const char *haystack, size_t haystack_length,
+                          const char *needle, size_t needle_length);
+
+// returns the last occurrence of needle in haystack, or NULL. needle_length
+// must be at least 1.
+const char *string_search_last(const char *haystack, size_t haystack_length,
+                               const char *needle, size_t needle_length);
+
+#endif // STRING_SEARCH_H
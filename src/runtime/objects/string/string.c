@@ -6,16 +6,20 @@
 
 #include "string.h"
 #include "../../../err.h"
+#include "../../../hash_data/hash_data.h"
 #include "../../../memory.h"
 #include "../../call/call.h"
+#include "../../internals/hashmap/hashmap.h"
 #include "../array/array.h"
 #include "../exceptions/exceptions.h"
 #include "../literals/literals.h"
 #include "../number/number.h"
 #include "../object.h"
 #include "../slice/slice.h"
+#include "search.h"
 #include <ctype.h>
 #include <inttypes.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -26,6 +30,17 @@
 ArgonObject *ARGON_STRING_TYPE = NULL;
 
 ArgonObject *ARGON_STRING_ITERATOR_TYPE = NULL;
+
+ArgonObject *ARGON_STRING_BUILDER_TYPE = NULL;
+
+// backing store for strings built by concatenation. bytes below `used` are
+// owned by some string and never change, so a string whose end is at `used`
+// can be extended in place by claiming more of the tail.
+struct string_buffer {
+  _Atomic size_t used;
+  size_t capacity;
+  char data[];
+};
 /* Returns the number of bytes consumed, or 0 on invalid UTF-8.
    Writes the decoded codepoint to *cp. */
 static int decode_utf8(const unsigned char *s, size_t len, uint32_t *cp) {
@@ -132,6 +147,9 @@ ARGON_METHOD(ARGON_STRING_TYPE, __equal__, {
     return ARGON_NULL;
   }
 
+  if (argv[0] == argv[1])
+    return ARGON_TRUE;
+
   return (argv[0]->type == TYPE_STRING && argv[1]->type == TYPE_STRING) &&
                  (!argv[0]->value.as_str->hash ||
                   !argv[1]->value.as_str->hash ||
@@ -421,14 +439,13 @@ ARGON_METHOD(ARGON_STRING_TYPE, replace, {
 
   // count occurrences to pre-calculate the result length
   size_t count = 0;
-  for (size_t i = 0; i + old.length <= self.length;) {
-    if (memcmp(self.data + i, old.data, old.length) == 0) {
-      count++;
-      i += old.length;
-    } else {
-      i++;
-    }
-  }
+  const char *end = self.data + self.length;
+  for (const char *match = string_search(self.data, self.length, old.data,
+                                         old.length);
+       match; match = string_search(match + old.length,
+                                    end - (match + old.length), old.data,
+                                    old.length))
+    count++;
 
   if (count == 0)
     return argv[0];
@@ -440,19 +457,19 @@ ARGON_METHOD(ARGON_STRING_TYPE, replace, {
     return ARGON_NULL;
   }
 
-  // build the result
-  size_t src = 0, dst = 0;
-  while (src + old.length <= self.length) {
-    if (memcmp(self.data + src, old.data, old.length) == 0) {
-      memcpy(buf + dst, new.data, new.length);
-      dst += new.length;
-      src += old.length;
-    } else {
-      buf[dst++] = self.data[src++];
-    }
+  // build the result, copying the text between matches in one go
+  const char *src = self.data;
+  size_t dst = 0;
+  for (size_t i = 0; i < count; i++) {
+    const char *match = string_search(src, end - src, old.data, old.length);
+    memcpy(buf + dst, src, match - src);
+    dst += match - src;
+    memcpy(buf + dst, new.data, new.length);
+    dst += new.length;
+    src = match + old.length;
   }
   // copy any remaining tail
-  memcpy(buf + dst, self.data + src, self.length - src);
+  memcpy(buf + dst, src, end - src);
   buf[new_len] = '\0';
 
   struct string result = {.data = buf, .length = new_len};
@@ -540,6 +557,13 @@ ARGON_METHOD(ARGON_STRING_TYPE, __getitem__, {
     if (slice_indices(argv[1], self.length, &indices, err, api) != 0)
       return ARGON_NULL;
 
+    // contiguous slices share the parent's bytes
+    if (indices.step == 1)
+      return new_string_view(argv[0], indices.start,
+                             indices.stop > indices.start
+                                 ? indices.stop - indices.start
+                                 : 0);
+
     int64_t size = 0;
     if (indices.step > 0 && indices.stop > indices.start)
       size = (indices.stop - indices.start + indices.step - 1) / indices.step;
@@ -640,27 +664,21 @@ ARGON_METHOD(ARGON_STRING_TYPE, split, {
 
   size_t splits = 0;
 
-  while (p <= end - dlen && splits < max_splits) {
-    if (memcmp(p, delim.data, dlen) == 0) {
-      ArgonObject *item =
-          api->string_to_argon((struct string){start, p - start});
-
-      darray_armem_insert(object->value.as_array,
-                          object->value.as_array->size,
-                          &item);
+  while (splits < max_splits &&
+         (p = (char *)string_search(p, end - p, delim.data, dlen))) {
+    ArgonObject *item = new_string_view(argv[0], start - s.data, p - start);
 
-      p += dlen;
-      start = p;
-      splits++;
-      continue;
-    }
+    darray_armem_insert(object->value.as_array,
+                        object->value.as_array->size,
+                        &item);
 
-    p++;
+    p += dlen;
+    start = p;
+    splits++;
   }
 
   /* Final segment */
-  ArgonObject *item =
-      api->string_to_argon((struct string){start, end - start});
+  ArgonObject *item = new_string_view(argv[0], start - s.data, end - start);
 
   darray_armem_insert(object->value.as_array,
                       object->value.as_array->size,
@@ -684,29 +702,30 @@ ARGON_METHOD(ARGON_STRING_TYPE, strip, {
   if (api->is_error(err))
     return ARGON_NULL;
 
-  // Empty string or no strip chars: return a copy as-is
+  // Empty string or no strip chars: strings are immutable, return it as-is
   if (s.length == 0 || s.data == NULL || chars.length == 0 ||
       chars.data == NULL) {
-    return api->string_to_argon((struct string){s.data, s.length});
+    return argv[0];
   }
 
+  // classify each byte once instead of scanning chars for every position
+  bool strip_set[256] = {false};
+  for (size_t i = 0; i < chars.length; i++)
+    strip_set[(unsigned char)chars.data[i]] = true;
+
   char *start = s.data;
   char *end = s.data + s.length - 1; // points to last char
 
   // Strip from the left
-  while (start <= end &&
-         memchr(chars.data, (unsigned char)*start, chars.length) != NULL) {
+  while (start <= end && strip_set[(unsigned char)*start])
     start++;
-  }
 
   // Strip from the right
-  while (end >= start &&
-         memchr(chars.data, (unsigned char)*end, chars.length) != NULL) {
+  while (end >= start && strip_set[(unsigned char)*end])
     end--;
-  }
 
   // end is now pointing at the last kept char, so length = end - start + 1
-  return api->string_to_argon((struct string){start, end - start + 1});
+  return new_string_view(argv[0], start - s.data, end - start + 1);
 })
 
 ARGON_METHOD(ARGON_STRING_TYPE, __contains__, {
@@ -732,28 +751,9 @@ ARGON_METHOD(ARGON_STRING_TYPE, __contains__, {
   if (slice.length == 0)
     return ARGON_TRUE;
 
-  // Boyer-Moore-Horspool: build bad character skip table
-  size_t skip[256];
-  for (size_t i = 0; i < 256; i++)
-    skip[i] = slice.length;
-  for (size_t i = 0; i < slice.length - 1; i++)
-    skip[(unsigned char)slice.data[i]] = slice.length - 1 - i;
-
-  // Search
-  size_t i = slice.length - 1;
-  while (i < self.length) {
-    size_t j = slice.length - 1;
-    size_t k = i;
-    while (j < slice.length && self.data[k] == slice.data[j]) {
-      if (j == 0)
-        return ARGON_TRUE;
-      k--;
-      j--;
-    }
-    i += skip[(unsigned char)self.data[i]];
-  }
-
-  return ARGON_FALSE;
+  return string_search(self.data, self.length, slice.data, slice.length)
+             ? ARGON_TRUE
+             : ARGON_FALSE;
 })
 
 ARGON_METHOD(ARGON_STRING_TYPE, starts_with, {
@@ -860,27 +860,9 @@ ARGON_METHOD(ARGON_STRING_TYPE, index_of, {
   if (needle.length > self.length - (size_t)from)
     return new_number_object_from_int64(-1);
 
-  // Boyer-Moore-Horspool
-  size_t skip[256];
-  for (size_t i = 0; i < 256; i++)
-    skip[i] = needle.length;
-  for (size_t i = 0; i < needle.length - 1; i++)
-    skip[(unsigned char)needle.data[i]] = needle.length - 1 - i;
-
-  size_t i = (size_t)from + needle.length - 1;
-  while (i < self.length) {
-    size_t j = needle.length - 1;
-    size_t k = i;
-    while (self.data[k] == needle.data[j]) {
-      if (j == 0)
-        return new_number_object_from_int64((int64_t)k);
-      k--;
-      j--;
-    }
-    i += skip[(unsigned char)self.data[i]];
-  }
-
-  return new_number_object_from_int64(-1);
+  const char *match = string_search(self.data + from, self.length - from,
+                                    needle.data, needle.length);
+  return new_number_object_from_int64(match ? match - self.data : -1);
 })
 
 ARGON_METHOD(ARGON_STRING_TYPE, last_index_of, {
@@ -934,30 +916,9 @@ ARGON_METHOD(ARGON_STRING_TYPE, last_index_of, {
   if (max_start < 0)
     return new_number_object_from_int64(-1);
 
-  // Boyer-Moore-Horspool, mirrored to scan right-to-left: the skip table
-  // is built from the needle's *first* character occurrences (rightmost
-  // match position from the front), and we align/compare starting from
-  // the needle's first character instead of its last.
-  size_t skip[256];
-  for (size_t i = 0; i < 256; i++)
-    skip[i] = needle.length;
-  for (size_t i = needle.length - 1; i > 0; i--)
-    skip[(unsigned char)needle.data[i]] = i;
-
-  int64_t i = max_start;
-  while (i >= 0) {
-    size_t j = 0;
-    size_t k = (size_t)i;
-    while (needle.data[j] == self.data[k]) {
-      if (j == needle.length - 1)
-        return new_number_object_from_int64(i);
-      j++;
-      k++;
-    }
-    i -= (int64_t)skip[(unsigned char)self.data[i]];
-  }
-
-  return new_number_object_from_int64(-1);
+  const char *match = string_search_last(
+      self.data, (size_t)max_start + needle.length, needle.data, needle.length);
+  return new_number_object_from_int64(match ? match - self.data : -1);
 })
 
 char *char_chr(uint64_t codepoint, size_t *len_out) {
@@ -1207,6 +1168,7 @@ void init_string(ArgonObject *object, char *data, size_t length,
   object->value.as_str->data = data;
   object->value.as_str->hash = hash;
   object->value.as_str->length = length;
+  object->value.as_str->buffer = NULL;
   object->as_bool = length;
 }
 
@@ -1218,6 +1180,45 @@ ArgonObject *new_string_object_without_memcpy(char *data, size_t length,
   return object;
 }
 
+ArgonObject *concat_string_objects(ArgonObject *left, ArgonObject *right) {
+  struct string_struct *a = left->value.as_str;
+  struct string_struct *b = right->value.as_str;
+  if (!b->length)
+    return left;
+  if (!a->length)
+    return right;
+  size_t length = a->length + b->length;
+
+  struct string_buffer *buffer = a->buffer;
+  size_t used = a->length;
+  if (buffer && length <= buffer->capacity &&
+      atomic_compare_exchange_strong(&buffer->used, &used, length)) {
+    memcpy(buffer->data + a->length, b->data, b->length);
+  } else {
+    // only grow past what is needed once the left side was itself built by
+    // concatenation, so one-off joins stay exact while loops amortise.
+    size_t capacity = a->buffer ? length * 2 : length;
+    buffer = ar_alloc_atomic(sizeof(struct string_buffer) + capacity);
+    buffer->capacity = capacity;
+    atomic_init(&buffer->used, length);
+    memcpy(buffer->data, a->data, a->length);
+    memcpy(buffer->data + a->length, b->data, b->length);
+  }
+  ArgonObject *object =
+      new_string_object_without_memcpy(buffer->data, length, 0);
+  object->value.as_str->buffer = buffer;
+  return object;
+}
+
+ArgonObject *new_string_view(ArgonObject *parent, size_t offset,
+                             size_t length) {
+  char *data = parent->value.as_str->data + offset;
+  if (length < 2)
+    return new_string_object(data, length, 0);
+  // the interior pointer is enough to keep the parent's bytes alive.
+  return new_string_object_without_memcpy(data, length, 0);
+}
+
 ArgonObject *new_string_object(char *data, size_t length, uint64_t hash) {
   if (length == 0)
     return &empty_str.obj;
@@ -1288,6 +1289,41 @@ char *argon_string_to_c_string_malloc(ArgonObject *object) {
   return string;
 }
 
+uint64_t hash_string_object(ArgonObject *object) {
+  if (!object->value.as_str->hash)
+    object->value.as_str->hash =
+        siphash64_bytes(object->value.as_str->data,
+                        object->value.as_str->length, siphash_key_fixed);
+  return object->value.as_str->hash;
+}
+
+// literal strings shared by every module, keyed by their fixed hash.
+// never shrinks: OP_LOAD_STRING caches these objects in bytecode slots the
+// collector doesn't scan, so this table (reachable from a static root) is
+// what keeps them alive. removing entries would need those slots to move
+// to scanned memory first.
+static struct hashmap_GC *interned_strings = NULL;
+static RWLock interned_strings_lock = RWLOCK_INIT;
+
+ArgonObject *intern_string_object(char *data, size_t length, uint64_t hash) {
+  if (length < 2)
+    return new_string_object(data, length, hash);
+  ArgonObject *object = NULL;
+  RWLOCK_WRLOCK(interned_strings_lock, {
+    if (!interned_strings)
+      interned_strings = createHashmap_GC();
+    ArgonObject *existing = hashmap_lookup_GC(interned_strings, hash);
+    if (!existing) {
+      object = new_string_object(data, length, hash);
+      hashmap_insert_GC(interned_strings, hash, object, object, 0);
+    } else if (existing->value.as_str->length == length &&
+               memcmp(existing->value.as_str->data, data, length) == 0) {
+      object = existing;
+    }
+  });
+  return object;
+}
+
 ArgonObject *new_string_object_null_terminated(char *data) {
   return new_string_object(data, strlen(data), 0);
 }
@@ -1336,6 +1372,65 @@ ARGON_METHOD(ARGON_STRING_ITERATOR_TYPE, __next__, {
       (struct string){&string_iterator->data[string_iterator->current++], 1});
 })
 
+ARGON_METHOD(ARGON_STRING_TYPE, builder, {
+  (void)api;
+  (void)state;
+  (void)argv;
+  if (argc != 0) {
+    *err = create_err(RuntimeError, "builder expects 0 arguments, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  ArgonObject *builder = new_instance(ARGON_STRING_BUILDER_TYPE, 0);
+  builder->type = TYPE_STRING_BUILDER;
+  builder->value.as_string_builder = &empty_str.obj;
+  return builder;
+})
+
+ARGON_METHOD(ARGON_STRING_BUILDER_TYPE, append, {
+  if (argc != 2) {
+    *err = create_err(RuntimeError, "append expects 2 arguments, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  GET_SELF(TYPE_STRING_BUILDER)
+  ArgonObject *piece = argv[1];
+  if (piece->type != TYPE_STRING) {
+    size_t length;
+    char *data = argon_object_to_length_terminated_string_from___string__(
+        piece, err, state, &length);
+    if (is_error(err))
+      return ARGON_NULL;
+    piece = new_string_object(data, length, 0);
+  }
+  self->value.as_string_builder =
+      concat_string_objects(self->value.as_string_builder, piece);
+  return self;
+})
+
+ARGON_METHOD(ARGON_STRING_BUILDER_TYPE, __string__, {
+  (void)state;
+  if (argc != 1) {
+    *err = create_err(RuntimeError,
+                      "__string__ expects 1 argument, got %" PRIu64, argc);
+    return ARGON_NULL;
+  }
+  GET_SELF(TYPE_STRING_BUILDER)
+  return self->value.as_string_builder;
+})
+
+ARGON_METHOD(ARGON_STRING_BUILDER_TYPE, get_length, {
+  (void)state;
+  if (argc != 1) {
+    *err = create_err(RuntimeError,
+                      "get_length expects 1 argument, got %" PRIu64, argc);
+    return ARGON_NULL;
+  }
+  GET_SELF(TYPE_STRING_BUILDER)
+  return new_number_object_from_int64(
+      self->value.as_string_builder->value.as_str->length);
+})
+
 ArgonObject *ARGON_RENDER_TEMPLATE;
 
 ARGON_FUNCTION(RENDER_TEMPLATE, {
@@ -14,6 +14,8 @@ extern ArgonObject *ARGON_RENDER_TEMPLATE;
 
 extern ArgonObject *ARGON_STRING_ITERATOR_TYPE;
 
+extern ArgonObject *ARGON_STRING_BUILDER_TYPE;
+
 EXPOSE_ARGON_FUNCTION(RENDER_TEMPLATE)
 
 char *c_quote_string(const char *input, size_t len);
@@ -31,6 +33,21 @@ ArgonObject *new_string_object_without_memcpy(char *data, size_t length,
 
 ArgonObject *new_string_object(char *data, size_t length, uint64_t hash);
 
+// a string sharing `length` bytes of parent's data from `offset`, no copy.
+ArgonObject *new_string_view(ArgonObject *parent, size_t offset,
+                             size_t length);
+
+// joins two strings, appending in place when the left one ends at the tail of
+// its concatenation buffer so repeated `s = s + piece` is amortised linear.
+ArgonObject *concat_string_objects(ArgonObject *left, ArgonObject *right);
+
+// the fixed siphash of the string, computed once and cached on the object
+uint64_t hash_string_object(ArgonObject *object);
+
+// returns the shared copy of a literal string, creating it on first use.
+// returns NULL if the hash is already taken by different bytes.
+ArgonObject *intern_string_object(char *data, size_t length, uint64_t hash);
+
 ArgonObject *new_string_object_null_terminated(char *data);
 
 char *argon_string_to_c_string_malloc(ArgonObject *object);
@@ -55,6 +72,10 @@ EXPOSE_ARGON_METHOD(ARGON_STRING_TYPE, split)
 
 EXPOSE_ARGON_METHOD(ARGON_STRING_TYPE, __iter__)
 EXPOSE_ARGON_METHOD(ARGON_STRING_ITERATOR_TYPE, __next__)
+EXPOSE_ARGON_METHOD(ARGON_STRING_TYPE, builder)
+EXPOSE_ARGON_METHOD(ARGON_STRING_BUILDER_TYPE, append)
+EXPOSE_ARGON_METHOD(ARGON_STRING_BUILDER_TYPE, __string__)
+EXPOSE_ARGON_METHOD(ARGON_STRING_BUILDER_TYPE, get_length)
 EXPOSE_ARGON_METHOD(ARGON_STRING_TYPE, chr)
 EXPOSE_ARGON_METHOD(ARGON_STRING_TYPE, ord)
 EXPOSE_ARGON_METHOD(ARGON_STRING_TYPE, __contains__)
@@ -37,6 +37,47 @@ ARGON_FUNCTION(TUPLE_CREATE, {
   return object;
 })
 
+static inline uint64_t mix_item_hash(uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+// dictionaries match keys by hash alone, so two distinct tuples only share an
+// entry if their hashes collide. every item hash is fully mixed before being
+// folded in so that takes a 64 bit collision, the same odds as for strings,
+// rather than a pair of items that happen to cancel out. an item whose
+// __hash__ throws makes the tuple unhashable.
+int64_t hash_tuple_object(ArgonObject *object, ArErr *err,
+                          RuntimeState *state) {
+  uint64_t hash = mix_item_hash(object->value.as_tuple.size);
+  for (size_t i = 0; i < object->value.as_tuple.size; i++) {
+    uint64_t item_hash =
+        hash_object(object->value.as_tuple.data[i], err, state);
+    if (is_error(err))
+      return 0;
+    hash = mix_item_hash(hash ^ (item_hash + 0x9e3779b97f4a7c15ULL +
+                                 (hash << 6) + (hash >> 2)));
+  }
+  return hash;
+}
+
+ARGON_METHOD(ARGON_TUPLE_TYPE, __hash__, {
+  (void)api;
+  if (argc != 1) {
+    *err = create_err(RuntimeError, "__hash__ expects 1 argument, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  int64_t hash = hash_tuple_object(argv[0], err, state);
+  if (is_error(err))
+    return ARGON_NULL;
+  return new_number_object_from_int64(hash);
+})
+
 ARGON_METHOD(ARGON_TUPLE_TYPE, __new__, {
   (void)api;
   (void)state;
@@ -315,6 +356,7 @@ void init_tuple_type() {
   MOUNT_ARGON_METHOD(ARGON_TUPLE_TYPE, set_length)
   MOUNT_ARGON_METHOD(ARGON_TUPLE_TYPE, __getitem__)
   MOUNT_ARGON_METHOD(ARGON_TUPLE_TYPE, __iter__)
+  MOUNT_ARGON_METHOD(ARGON_TUPLE_TYPE, __hash__)
   MOUNT_ARGON_METHOD(ARGON_TUPLE_TYPE, of)
 
   ARGON_TUPLE_ITERATOR_TYPE = new_class();
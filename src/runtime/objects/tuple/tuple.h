@@ -13,6 +13,8 @@ extern ArgonObject *ARGON_TUPLE_CREATE;
 
 EXPOSE_ARGON_FUNCTION(TUPLE_CREATE)
 
+int64_t hash_tuple_object(ArgonObject *object, ArErr *err, RuntimeState *state);
+
 void init_tuple_type();
 
 #endif // TUPLE_OBJECT
\ No newline at end of file
@@ -20,15 +20,18 @@
 #include "internals/hashmap/hashmap.h"
 #include "native_loader/native_loader.h"
 #include "objects/array/array.h"
+#include "objects/array/typed_array.h"
 #include "objects/buffer/buffer.h"
 #include "objects/dictionary/dictionary.h"
 #include "objects/exceptions/exceptions.h"
 #include "objects/functions/functions.h"
+#include "objects/iterator/lazy_iterator.h"
 #include "objects/iterator/range_iterator.h"
 #include "objects/literals/literals.h"
 #include "objects/number/number.h"
 #include "objects/object.h"
 #include "objects/slice/slice.h"
+#include "objects/string/search.h"
 #include "objects/string/string.h"
 #include "objects/term/term.h"
 #include "objects/tuple/tuple.h"
@@ -37,6 +40,7 @@
 #include <gc/gc.h>
 #include <gmp.h>
 #include <inttypes.h>
+#include <stdatomic.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -964,13 +968,7 @@ ARGON_METHOD(ARGON_STRING_TYPE, __add__, {
         type_name->value.as_str->length, type_name->value.as_str->data);
     return ARGON_NULL;
   }
-  size_t length = argv[0]->value.as_str->length + argv[1]->value.as_str->length;
-  char *concat = ar_alloc_atomic(length);
-  memcpy(concat, argv[0]->value.as_str->data, argv[0]->value.as_str->length);
-  memcpy(concat + argv[0]->value.as_str->length, argv[1]->value.as_str->data,
-         argv[1]->value.as_str->length);
-  ArgonObject *object = new_string_object_without_memcpy(concat, length, 0);
-  return object;
+  return concat_string_objects(argv[0], argv[1]);
 })
 
 ARGON_METHOD(ARGON_BOOL_TYPE, __string__, {
@@ -1028,15 +1026,7 @@ ARGON_METHOD(ARGON_STRING_TYPE, __hash__, {
     *err = create_err(RuntimeError, "__hash__ expects 1 argument, got %" PRIu64,
                       argc);
   }
-  uint64_t hash;
-  if (argv[0]->value.as_str->hash) {
-    hash = argv[0]->value.as_str->hash;
-  } else {
-    hash = siphash64_bytes(argv[0]->value.as_str->data,
-                           argv[0]->value.as_str->length, siphash_key_fixed);
-    argv[0]->value.as_str->hash = hash;
-  }
-  return new_number_object_from_int64(hash);
+  return new_number_object_from_int64(hash_string_object(argv[0]));
 })
 
 ARGON_METHOD(ARGON_STRING_TYPE, __number__, {
@@ -1151,6 +1141,7 @@ void bootstrap_types() {
   ARGON_FALSE->type = TYPE_BOOL;
   ARGON_NULL->as_bool = false;
 
+  string_search_init();
   ARGON_STRING_TYPE = new_class();
   add_builtin_field(ARGON_STRING_TYPE, __base__, BASE_CLASS);
 
@@ -1269,6 +1260,15 @@ void bootstrap_types() {
                     new_string_object_null_terminated("string_iterator"));
   MOUNT_ARGON_METHOD(ARGON_STRING_ITERATOR_TYPE, __next__)
 
+  ARGON_STRING_BUILDER_TYPE = new_class();
+
+  add_builtin_field(ARGON_STRING_BUILDER_TYPE, __name__,
+                    new_string_object_null_terminated("string_builder"));
+  MOUNT_ARGON_METHOD(ARGON_STRING_BUILDER_TYPE, append)
+  MOUNT_ARGON_METHOD(ARGON_STRING_BUILDER_TYPE, __string__)
+  MOUNT_ARGON_METHOD(ARGON_STRING_BUILDER_TYPE, get_length)
+  MOUNT_ARGON_METHOD(ARGON_STRING_TYPE, builder)
+
   create_ARGON_DICTIONARY_TYPE();
   create_ARGON_NUMBER_TYPE();
   create_ARGON_BUFFER_TYPE();
@@ -1276,8 +1276,10 @@ void bootstrap_types() {
   init_exceptions();
 
   init_array_type();
+  init_typed_array_type();
   init_tuple_type();
   init_range_iterator();
+  init_lazy_iterator();
   init_slice_type();
   init_small_chars();
 
@@ -1384,6 +1386,28 @@ void bootstrap_globals() {
   add_to_hashmap(argon_term, "input",
                  create_argon_native_function("input", ARGON_FUNC_term_input));
   add_to_scope(Global_Scope, "term", create_dictionary(argon_term));
+
+  struct hashmap_GC *argon_iter = createHashmap_GC();
+  add_to_hashmap(argon_iter, "map",
+                 create_argon_native_function("map", ARGON_FUNC_iter_map));
+  add_to_hashmap(argon_iter, "filter",
+                 create_argon_native_function("filter", ARGON_FUNC_iter_filter));
+  add_to_hashmap(argon_iter, "take",
+                 create_argon_native_function("take", ARGON_FUNC_iter_take));
+  add_to_hashmap(argon_iter, "skip",
+                 create_argon_native_function("skip", ARGON_FUNC_iter_skip));
+  add_to_hashmap(argon_iter, "zip",
+                 create_argon_native_function("zip", ARGON_FUNC_iter_zip));
+  add_to_hashmap(argon_iter, "enumerate",
+                 create_argon_native_function("enumerate",
+                                              ARGON_FUNC_iter_enumerate));
+  add_to_hashmap(argon_iter, "chain",
+                 create_argon_native_function("chain", ARGON_FUNC_iter_chain));
+  add_to_hashmap(argon_iter, "chunk",
+                 create_argon_native_function("chunk", ARGON_FUNC_iter_chunk));
+  add_to_hashmap(argon_iter, "window",
+                 create_argon_native_function("window", ARGON_FUNC_iter_window));
+  add_to_scope(Global_Scope, "iter", create_dictionary(argon_iter));
   add_to_scope(Global_Scope, "load_native_code",
                create_argon_native_function("load_native_code",
                                             ARGON_FUNC_ARGON_LOAD_NATIVE_CODE));
@@ -1443,11 +1467,30 @@ int compare_by_order(const void *a, const void *b) {
   return itemA->order - itemB->order;
 }
 
+// the slot is a ready byte followed by the interned string, filled in the
+// first time the instruction runs so later runs are a single pointer load.
 static inline void load_const(uint8_t to_register, size_t length,
-                              uint64_t offset, uint64_t hash,
+                              uint64_t offset, uint64_t hash, uint8_t *slot,
                               Translated *translated, RuntimeState *state) {
-  ArgonObject *object = new_string_object(
-      arena_get(&translated->constants, offset), length, hash);
+  ArgonObject *object;
+  if (atomic_load_explicit((_Atomic uint8_t *)slot, memory_order_acquire)) {
+    memcpy(&object, slot + 1, sizeof(object));
+    state->registers[to_register] = object;
+    return;
+  }
+  char *data = arena_get(&translated->constants, offset);
+  object = intern_string_object(data, length, hash);
+  if (!object) {
+    // hash collision with another literal, so this one can't be shared.
+    state->registers[to_register] = new_string_object(data, length, hash);
+    return;
+  }
+  // the bytecode is allocated atomic, so the collector never sees this
+  // pointer. the object stays alive only because interned_strings holds
+  // every interned string for the life of the process; see the invariant
+  // there before ever letting that table drop entries.
+  memcpy(slot + 1, &object, sizeof(object));
+  atomic_store_explicit((_Atomic uint8_t *)slot, 1, memory_order_release);
   state->registers[to_register] = object;
 }
 
@@ -1562,11 +1605,6 @@ void runtime(Translated _translated, RuntimeState _state, Stack *stack,
       [OP_DECLARE] = &&DO_DECLARE,
       [OP_LOAD_NULL] = &&DO_LOAD_NULL,
       [OP_LOAD_FUNCTION] = &&DO_LOAD_FUNCTION,
-      [OP_SET_FUNCTION_PARAMETER] = &&DO_SET_FUNCTION_PARAMETER,
-      [OP_SET_FUNCTION_POSITIONAL_PARAMETER] =
-          &&DO_SET_FUNCTION_POSITIONAL_PARAMETER,
-      [OP_SET_FUNCTION_KEY_WORD_PARAMETER] =
-          &&DO_SET_FUNCTION_KEY_WORD_PARAMETER,
       [OP_SET_FUNCTION_DEFAULT_PARAMETER] = &&DO_SET_FUNCTION_DEFAULT_PARAMETER,
       [OP_IDENTIFIER] = &&DO_IDENTIFIER,
       [OP_BOOL] = &&DO_BOOL,
@@ -1685,7 +1723,9 @@ void runtime(Translated _translated, RuntimeState _state, Stack *stack,
         POP_U64(offset);
         uint64_t hash;
         POP_U64(hash);
-        load_const(to_register, length, offset, hash, translated, state);
+        uint8_t *slot = bc + ip;
+        ip += 1 + sizeof(ArgonObject *);
+        load_const(to_register, length, offset, hash, slot, translated, state);
         continue;
       }
     DO_LOAD_NUMBER:
@@ -1767,48 +1807,45 @@ void runtime(Translated _translated, RuntimeState _state, Stack *stack,
       }
     DO_LOAD_FUNCTION:
       {
-        uint64_t offset;
-        POP_U64(offset);
-        uint64_t length;
-        POP_U64(length);
-        uint64_t bytecode_offset;
-        POP_U64(bytecode_offset);
-        uint64_t bytecode_length;
-        POP_U64(bytecode_length);
-        uint64_t number_of_parameters;
-        POP_U64(number_of_parameters);
+        uint64_t toc_offset;
+        POP_U64(toc_offset);
         uint64_t number_of_default_parameters;
         POP_U64(number_of_default_parameters);
+        uint8_t *toc = arena_get(&translated->constants, toc_offset);
+        uint64_t toc_header[FUNCTION_TOC_HEADER_SIZE];
+        for (size_t i = 0; i < FUNCTION_TOC_HEADER_SIZE; i++)
+          toc_header[i] = bytes_to_uint64(toc + i * sizeof(uint64_t));
         ArgonObject *object = new_instance(
             ARGON_FUNCTION_TYPE,
             sizeof(struct argon_function_struct) +
-                number_of_parameters * sizeof(struct string_struct) +
                 number_of_default_parameters * sizeof(struct default_value));
         object->type = TYPE_FUNCTION;
         add_builtin_field(
             object, __name__,
-            new_string_object(arena_get(&translated->constants, offset), length,
-                              0));
+            new_string_object(
+                arena_get(&translated->constants,
+                          toc_header[FUNCTION_TOC_NAME_OFFSET]),
+                toc_header[FUNCTION_TOC_NAME_LENGTH], 0));
         object->value.argon_fn =
             (struct argon_function_struct *)((char *)object +
                                              sizeof(ArgonObject));
-        object->value.argon_fn->parameters =
-            (struct string_struct *)((char *)object->value.argon_fn +
-                                     sizeof(struct argon_function_struct));
         object->value.argon_fn->default_parameters =
-            (struct default_value *)((char *)
-                                         object->value.argon_fn->parameters +
-                                     number_of_parameters *
-                                         sizeof(struct string_struct));
+            (struct default_value *)((char *)object->value.argon_fn +
+                                     sizeof(struct argon_function_struct));
         object->value.argon_fn->translated = *translated;
-        object->value.argon_fn->number_of_parameters = number_of_parameters;
+        object->value.argon_fn->toc = toc;
+        object->value.argon_fn->number_of_parameters =
+            toc_header[FUNCTION_TOC_PARAMETER_COUNT];
+        object->value.argon_fn->parameters = NULL;
         object->value.argon_fn->number_of_default_parameters =
             number_of_default_parameters;
         object->value.argon_fn->vargs.data = NULL;
         object->value.argon_fn->kwargs.data = NULL;
         object->value.argon_fn->bytecode =
-            arena_get(&translated->constants, bytecode_offset);
-        object->value.argon_fn->bytecode_length = bytecode_length;
+            arena_get(&translated->constants,
+                      toc_header[FUNCTION_TOC_BYTECODE_OFFSET]);
+        object->value.argon_fn->bytecode_length =
+            toc_header[FUNCTION_TOC_BYTECODE_LENGTH];
         Stack *current = currentStackFrame->stack;
         object->value.argon_fn->stack = current;
 
@@ -1821,53 +1858,6 @@ void runtime(Translated _translated, RuntimeState _state, Stack *stack,
         state->registers[0] = object;
         continue;
       }
-    DO_SET_FUNCTION_PARAMETER:
-      {
-        uint64_t index;
-        POP_U64(index);
-        uint64_t offset;
-        POP_U64(offset);
-        uint64_t length;
-        POP_U64(length);
-        uint64_t hash;
-        POP_U64(hash);
-
-        state->registers[0]->value.argon_fn->parameters[index].data =
-            arena_get(&translated->constants, offset);
-        state->registers[0]->value.argon_fn->parameters[index].length = length;
-        state->registers[0]->value.argon_fn->parameters[index].hash = hash;
-        continue;
-      }
-    DO_SET_FUNCTION_POSITIONAL_PARAMETER:
-      {
-        uint64_t offset;
-        POP_U64(offset);
-        uint64_t length;
-        POP_U64(length);
-        uint64_t hash;
-        POP_U64(hash);
-
-        state->registers[0]->value.argon_fn->vargs.data =
-            arena_get(&translated->constants, offset);
-        state->registers[0]->value.argon_fn->vargs.length = length;
-        state->registers[0]->value.argon_fn->vargs.hash = hash;
-        continue;
-      }
-    DO_SET_FUNCTION_KEY_WORD_PARAMETER:
-      {
-        uint64_t offset;
-        POP_U64(offset);
-        uint64_t length;
-        POP_U64(length);
-        uint64_t hash;
-        POP_U64(hash);
-
-        state->registers[0]->value.argon_fn->kwargs.data =
-            arena_get(&translated->constants, offset);
-        state->registers[0]->value.argon_fn->kwargs.length = length;
-        state->registers[0]->value.argon_fn->kwargs.hash = hash;
-        continue;
-      }
     DO_SET_FUNCTION_DEFAULT_PARAMETER:
       {
         uint8_t func_register = POP_BYTE();
@@ -1990,6 +1980,8 @@ void runtime(Translated _translated, RuntimeState _state, Stack *stack,
       {
         ArgonObject *iterator = state->registers[POP_BYTE()];
         ArgonObject *iterator_next = state->registers[POP_BYTE()];
+        uint64_t exhausted;
+        POP_U64(exhausted);
 
         switch (iterator->type) {
         case TYPE_ARRAY_ITERATOR:
@@ -2009,10 +2001,22 @@ void runtime(Translated _translated, RuntimeState _state, Stack *stack,
               ARGON_FUNC_ARGON_DICTIONARY_ITERATOR_TYPE___next__(
                   1, &iterator, NULL, &err, state, &native_api);
           break;
+        case TYPE_LAZY_ITERATOR:
+          state->registers[0] = ARGON_FUNC_LAZY_ITERATOR_TYPE___next__(
+              1, &iterator, NULL, &err, state, &native_api);
+          break;
         default:
           state->registers[0] =
               argon_call(iterator_next, 0, NULL, NULL, &err, state);
         }
+        // native iterators hand back the shared StopIteration instance, so
+        // only a user __next__ that throws its own needs the instance check.
+        // neither goes through the catch stack.
+        if (is_error(&err) && (err.ptr == StopIteration_instance ||
+                               is_instance(err.ptr, StopIteration))) {
+          err.ptr = ARGON_NULL;
+          ip = exhausted;
+        }
         continue;
       }
     DO_BOOL:
@@ -2165,7 +2169,9 @@ void runtime(Translated _translated, RuntimeState _state, Stack *stack,
         POP_U64(hash);
         struct string_struct *key = ar_alloc(sizeof(struct string_struct));
         *key = (struct string_struct){
-            hash, arena_get(&translated->constants, offset), length};
+            .hash = hash,
+            .data = arena_get(&translated->constants, offset),
+            .length = length};
         if (!state->call_instance->kwargs)
           state->call_instance->kwargs = createHashmap_GC();
         hashmap_insert_GC(state->call_instance->kwargs, hash, key,
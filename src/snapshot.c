@@ -0,0 +1,476 @@
+/*
+ * SPDX-FileCopyrightText: 2026 William Bell
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "snapshot.h"
+#include "RWLock.h"
+#include "../external/cwalk/include/cwalk.h"
+#include "../external/xxhash/xxhash.h"
+#include "err.h"
+#include "hash_data/hash_data.h"
+#include "hashmap/hashmap.h"
+#include "import.h"
+#include "memory.h"
+#include "runtime/objects/exceptions/exceptions.h"
+#include "runtime/objects/literals/literals.h"
+#include "translator/translator.h"
+#include <inttypes.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#if defined(_WIN32) || defined(_WIN64)
+static inline uint32_t le32toh(uint32_t x) { return x; }
+static inline uint64_t le64toh(uint64_t x) { return x; }
+static inline uint32_t htole32(uint32_t x) { return x; }
+static inline uint64_t htole64(uint64_t x) { return x; }
+#elif defined(__linux__)
+#include <endian.h>
+#elif defined(__APPLE__)
+#include <libkern/OSByteOrder.h>
+#define htole32(x) OSSwapHostToLittleInt32(x)
+#define le32toh(x) OSSwapLittleToHostInt32(x)
+#define htole64(x) OSSwapHostToLittleInt64(x)
+#define le64toh(x) OSSwapLittleToHostInt64(x)
+#elif defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+#include <sys/endian.h>
+#endif
+
+/*
+ * A snapshot is a single file holding the translated bytecode of every module
+ * a program loaded, plus how each import path was resolved. Replaying it skips
+ * the path search, source hashing, lexing, parsing and translation for each
+ * module, as long as the source file on disk still has the same size and
+ * modification time it had when the snapshot was taken.
+ *
+ * layout (all integers little endian):
+ *   "ARSN", u32 bytecode version, main path,
+ *   u64 module count, modules..., u64 resolution count, resolutions...,
+ *   u64 XXH64 of everything before it
+ * strings are stored as a u64 length followed by the bytes.
+ */
+
+const char SNAPSHOT_IDENTIFIER[] = "ARSN";
+
+struct snapshot_module {
+  char *path;
+  uint64_t source_size;
+  int64_t source_mtime;
+  uint64_t source_hash;
+  uint8_t register_count;
+  uint64_t constants_size;
+  uint64_t bytecode_size;
+  void *constants;
+  void *bytecode;
+};
+
+struct snapshot_resolution {
+  char *current_directory;
+  char *path_relative;
+  char *path;
+};
+
+SnapshotMode snapshot_mode = SNAPSHOT_NONE;
+bool snapshot_until_ready = false;
+static char *snapshot_path;
+static char *snapshot_main_path;
+static DArray snapshot_modules;
+static DArray snapshot_resolutions;
+// both tables map a hash to (index + 1) in the arrays above
+static struct hashmap *snapshot_module_table;
+static struct hashmap *snapshot_resolution_table;
+
+static char *snapshot_strdup(const char *str, size_t length) {
+  char *copy = checked_malloc(length + 1);
+  memcpy(copy, str, length);
+  copy[length] = '\0';
+  return copy;
+}
+
+static RWLock snapshot_modules_lock = RWLOCK_INIT;
+
+static void *snapshot_memdup(const void *data, size_t length) {
+  void *copy = checked_malloc(length ? length : 1);
+  memcpy(copy, data, length);
+  return copy;
+}
+
+static bool source_stat(char *path, uint64_t *size, int64_t *mtime) {
+  struct stat st;
+  if (stat(path, &st) != 0)
+    return false;
+  *size = (uint64_t)st.st_size;
+  *mtime = (int64_t)st.st_mtime;
+  return true;
+}
+
+static uint64_t resolution_hash(char *current_directory, char *path_relative) {
+  size_t directory_length = strlen(current_directory);
+  size_t relative_length = strlen(path_relative);
+  char *key = checked_malloc(directory_length + relative_length + 1);
+  memcpy(key, current_directory, directory_length);
+  key[directory_length] = '\0';
+  memcpy(key + directory_length + 1, path_relative, relative_length);
+  uint64_t hash = siphash64_bytes(key, directory_length + relative_length + 1,
+                                  siphash_key_fixed);
+  free(key);
+  return hash;
+}
+
+static void init_snapshot_tables(void) {
+  darray_init(&snapshot_modules, sizeof(struct snapshot_module));
+  darray_init(&snapshot_resolutions, sizeof(struct snapshot_resolution));
+  snapshot_module_table = createHashmap();
+  snapshot_resolution_table = createHashmap();
+}
+
+void snapshot_begin_record(char *path, char *main_path, bool until_ready) {
+  snapshot_mode = SNAPSHOT_RECORD;
+  snapshot_until_ready = until_ready;
+  snapshot_path = path;
+  snapshot_main_path = main_path;
+  init_snapshot_tables();
+}
+
+void snapshot_record_module(char *path, uint64_t source_hash,
+                            Translated *translated) {
+  if (snapshot_mode != SNAPSHOT_RECORD)
+    return;
+  size_t path_length = strlen(path);
+  uint64_t hash = siphash64_bytes(path, path_length, siphash_key_fixed);
+  if (hashmap_lookup(snapshot_module_table, hash))
+    return;
+  struct snapshot_module module = {0};
+  if (!source_stat(path, &module.source_size, &module.source_mtime))
+    return;
+  module.path = snapshot_strdup(path, path_length);
+  module.source_hash = source_hash;
+  module.register_count = translated->registerCount;
+  module.constants_size = translated->constants.size;
+  module.bytecode_size = translated->bytecode.size;
+  module.constants = checked_malloc(module.constants_size + 1);
+  memcpy(module.constants, translated->constants.data, module.constants_size);
+  module.bytecode = checked_malloc(module.bytecode_size + 1);
+  memcpy(module.bytecode, translated->bytecode.data, module.bytecode_size);
+  darray_push(&snapshot_modules, &module);
+  hashmap_insert(snapshot_module_table, hash, NULL,
+                 (void *)(uintptr_t)snapshot_modules.size, 0);
+}
+
+void snapshot_record_resolution(char *current_directory, char *path_relative,
+                                char *path) {
+  if (snapshot_mode != SNAPSHOT_RECORD)
+    return;
+  uint64_t hash = resolution_hash(current_directory, path_relative);
+  if (hashmap_lookup(snapshot_resolution_table, hash))
+    return;
+  struct snapshot_resolution resolution = {
+      snapshot_strdup(current_directory, strlen(current_directory)),
+      snapshot_strdup(path_relative, strlen(path_relative)),
+      snapshot_strdup(path, strlen(path))};
+  darray_push(&snapshot_resolutions, &resolution);
+  hashmap_insert(snapshot_resolution_table, hash, NULL,
+                 (void *)(uintptr_t)snapshot_resolutions.size, 0);
+}
+
+static void write_bytes(FILE *file, XXH64_state_t *state, const void *ptr,
+                        size_t size) {
+  fwrite(ptr, 1, size, file);
+  XXH64_update(state, ptr, size);
+}
+
+static void write_u64(FILE *file, XXH64_state_t *state, uint64_t value) {
+  value = htole64(value);
+  write_bytes(file, state, &value, sizeof(value));
+}
+
+static void write_string(FILE *file, XXH64_state_t *state, char *str) {
+  size_t length = strlen(str);
+  write_u64(file, state, length);
+  write_bytes(file, state, str, length);
+}
+
+int snapshot_write(void) {
+  if (snapshot_mode != SNAPSHOT_RECORD)
+    return 1;
+  FILE *file = fopen(snapshot_path, "wb");
+  if (!file)
+    return 1;
+
+  XXH64_state_t *state = XXH64_createState();
+  XXH64_reset(state, 0);
+
+  uint32_t version = htole32(bytecode_version_number);
+  write_bytes(file, state, SNAPSHOT_IDENTIFIER, strlen(SNAPSHOT_IDENTIFIER));
+  write_bytes(file, state, &version, sizeof(version));
+  char main_path[PATH_MAX];
+  cwk_path_get_absolute(CWD, snapshot_main_path, main_path, sizeof(main_path));
+  write_string(file, state, main_path);
+
+  write_u64(file, state, snapshot_modules.size);
+  for (size_t i = 0; i < snapshot_modules.size; i++) {
+    struct snapshot_module *module = darray_get(&snapshot_modules, i);
+    write_string(file, state, module->path);
+    write_u64(file, state, module->source_size);
+    write_u64(file, state, (uint64_t)module->source_mtime);
+    write_u64(file, state, module->source_hash);
+    write_bytes(file, state, &module->register_count, sizeof(uint8_t));
+    write_u64(file, state, module->constants_size);
+    write_u64(file, state, module->bytecode_size);
+    write_bytes(file, state, module->constants, module->constants_size);
+    write_bytes(file, state, module->bytecode, module->bytecode_size);
+  }
+
+  write_u64(file, state, snapshot_resolutions.size);
+  for (size_t i = 0; i < snapshot_resolutions.size; i++) {
+    struct snapshot_resolution *resolution =
+        darray_get(&snapshot_resolutions, i);
+    write_string(file, state, resolution->current_directory);
+    write_string(file, state, resolution->path_relative);
+    write_string(file, state, resolution->path);
+  }
+
+  uint64_t file_hash = htole64(XXH64_digest(state));
+  XXH64_freeState(state);
+  fwrite(&file_hash, sizeof(file_hash), 1, file);
+
+  int failed = ferror(file);
+  fclose(file);
+  return failed ? 1 : 0;
+}
+
+struct snapshot_reader {
+  uint8_t *data;
+  size_t size;
+  size_t pos;
+};
+
+static bool read_bytes(struct snapshot_reader *reader, size_t size,
+                       void **out) {
+  if (reader->size - reader->pos < size)
+    return false;
+  *out = reader->data + reader->pos;
+  reader->pos += size;
+  return true;
+}
+
+static bool read_u64(struct snapshot_reader *reader, uint64_t *out) {
+  void *ptr;
+  if (!read_bytes(reader, sizeof(uint64_t), &ptr))
+    return false;
+  memcpy(out, ptr, sizeof(uint64_t));
+  *out = le64toh(*out);
+  return true;
+}
+
+static bool read_string(struct snapshot_reader *reader, char **out) {
+  uint64_t length;
+  void *ptr;
+  if (!read_u64(reader, &length) || !read_bytes(reader, length, &ptr))
+    return false;
+  *out = snapshot_strdup(ptr, length);
+  return true;
+}
+
+char *snapshot_begin_replay(char *path, ArErr *err) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    *err = create_err(FileError, "Unable to open snapshot '%s'", path);
+    return NULL;
+  }
+  fseek(file, 0, SEEK_END);
+  long file_size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  if (file_size < (long)sizeof(uint64_t)) {
+    fclose(file);
+    *err = create_err(FileError, "Snapshot '%s' is truncated", path);
+    return NULL;
+  }
+
+  // everything kept is copied out, so the file's buffer is freed once it is
+  // parsed
+  uint8_t *data = checked_malloc(file_size);
+  size_t read = fread(data, 1, file_size, file);
+  fclose(file);
+  if (read != (size_t)file_size) {
+    free(data);
+    *err = create_err(FileError, "Unable to read snapshot '%s'", path);
+    return NULL;
+  }
+
+  // the version is checked ahead of the hash so a snapshot from another
+  // argon is reported as that rather than as corruption
+  size_t data_size = file_size - sizeof(uint64_t);
+  struct snapshot_reader reader = {data, data_size, 0};
+  void *identifier;
+  uint32_t version;
+  void *version_ptr;
+  if (!read_bytes(&reader, strlen(SNAPSHOT_IDENTIFIER), &identifier) ||
+      memcmp(identifier, SNAPSHOT_IDENTIFIER, strlen(SNAPSHOT_IDENTIFIER)) !=
+          0 ||
+      !read_bytes(&reader, sizeof(version), &version_ptr)) {
+    free(data);
+    *err = create_err(FileError, "'%s' is not a snapshot", path);
+    return NULL;
+  }
+  memcpy(&version, version_ptr, sizeof(version));
+  if (le32toh(version) != bytecode_version_number) {
+    free(data);
+    *err = create_err(FileError,
+                      "Snapshot '%s' was made by a different version of argon",
+                      path);
+    return NULL;
+  }
+
+  uint64_t stored_hash;
+  memcpy(&stored_hash, data + data_size, sizeof(stored_hash));
+  if (XXH64(data, data_size, 0) != le64toh(stored_hash)) {
+    free(data);
+    *err = create_err(FileError, "Snapshot '%s' is corrupted", path);
+    return NULL;
+  }
+
+  init_snapshot_tables();
+  char *main_path;
+  uint64_t module_count;
+  if (!read_string(&reader, &main_path) || !read_u64(&reader, &module_count))
+    goto INVALID;
+
+  for (uint64_t i = 0; i < module_count; i++) {
+    struct snapshot_module module;
+    uint64_t mtime;
+    void *register_count;
+    void *constants;
+    void *bytecode;
+    if (!read_string(&reader, &module.path) ||
+        !read_u64(&reader, &module.source_size) ||
+        !read_u64(&reader, &mtime) ||
+        !read_u64(&reader, &module.source_hash) ||
+        !read_bytes(&reader, sizeof(uint8_t), &register_count) ||
+        !read_u64(&reader, &module.constants_size) ||
+        !read_u64(&reader, &module.bytecode_size) ||
+        !read_bytes(&reader, module.constants_size, &constants) ||
+        !read_bytes(&reader, module.bytecode_size, &bytecode))
+      goto INVALID;
+    module.constants = snapshot_memdup(constants, module.constants_size);
+    module.bytecode = snapshot_memdup(bytecode, module.bytecode_size);
+    module.source_mtime = (int64_t)mtime;
+    module.register_count = *(uint8_t *)register_count;
+    darray_push(&snapshot_modules, &module);
+    hashmap_insert(
+        snapshot_module_table,
+        siphash64_bytes(module.path, strlen(module.path), siphash_key_fixed),
+        NULL, (void *)(uintptr_t)snapshot_modules.size, 0);
+  }
+
+  uint64_t resolution_count;
+  if (!read_u64(&reader, &resolution_count))
+    goto INVALID;
+  for (uint64_t i = 0; i < resolution_count; i++) {
+    struct snapshot_resolution resolution;
+    if (!read_string(&reader, &resolution.current_directory) ||
+        !read_string(&reader, &resolution.path_relative) ||
+        !read_string(&reader, &resolution.path))
+      goto INVALID;
+    darray_push(&snapshot_resolutions, &resolution);
+    hashmap_insert(snapshot_resolution_table,
+                   resolution_hash(resolution.current_directory,
+                                   resolution.path_relative),
+                   NULL, (void *)(uintptr_t)snapshot_resolutions.size, 0);
+  }
+
+  free(data);
+  snapshot_mode = SNAPSHOT_REPLAY;
+  snapshot_path = path;
+  snapshot_main_path = main_path;
+  return main_path;
+INVALID:
+  free(data);
+  *err = create_err(FileError, "Snapshot '%s' is malformed", path);
+  return NULL;
+}
+
+int snapshot_load_module(Translated *translated_dest, char *path) {
+  if (snapshot_mode != SNAPSHOT_REPLAY)
+    return 1;
+  uintptr_t index = (uintptr_t)hashmap_lookup(
+      snapshot_module_table,
+      siphash64_bytes(path, strlen(path), siphash_key_fixed));
+  if (!index)
+    return 1;
+  struct snapshot_module *module = darray_get(&snapshot_modules, index - 1);
+
+  uint64_t source_size;
+  int64_t source_mtime;
+  if (!source_stat(path, &source_size, &source_mtime) ||
+      source_size != module->source_size ||
+      source_mtime != module->source_mtime) {
+#ifdef ARGON_DEBUG
+    fprintf(stderr, "snapshot of %s is stale... loading normally.\n", path);
+#endif
+    return 1;
+  }
+
+  // each module's copy is handed out once and freed, so a second load of
+  // the same path goes the normal way
+  void *constants;
+  void *bytecode;
+  RWLOCK_WRLOCK(snapshot_modules_lock, {
+    constants = module->constants;
+    bytecode = module->bytecode;
+    module->constants = module->bytecode = NULL;
+  });
+  if (!bytecode)
+    return 1;
+
+  *translated_dest = init_translator(path);
+  translated_dest->registerCount = module->register_count;
+  arena_resize(&translated_dest->constants, module->constants_size);
+  memcpy(translated_dest->constants.data, constants, module->constants_size);
+  translated_dest->constants.size = module->constants_size;
+  darray_resize(&translated_dest->bytecode, module->bytecode_size);
+  memcpy(translated_dest->bytecode.data, bytecode, module->bytecode_size);
+  translated_dest->bytecode.size = module->bytecode_size;
+  free(constants);
+  free(bytecode);
+  return 0;
+}
+
+char *snapshot_lookup_resolution(char *current_directory,
+                                 char *path_relative) {
+  if (snapshot_mode != SNAPSHOT_REPLAY)
+    return NULL;
+  uintptr_t index = (uintptr_t)hashmap_lookup(
+      snapshot_resolution_table,
+      resolution_hash(current_directory, path_relative));
+  if (!index)
+    return NULL;
+  struct snapshot_resolution *resolution =
+      darray_get(&snapshot_resolutions, index - 1);
+  return resolution->path;
+}
+
+// program.ready(), lets a program mark the point where its startup work is
+// done. with --until-ready the snapshot is written and the process exits here.
+ARGON_FUNCTION(ARGON_PROGRAM_READY, {
+  if (argc != 0) {
+    *err = create_err(RuntimeError, "ready expects 0 arguments, got %" PRIu64,
+                      argc);
+    return ARGON_NULL;
+  }
+  if (snapshot_mode != SNAPSHOT_RECORD || !snapshot_until_ready)
+    return ARGON_NULL;
+  if (snapshot_write() != 0) {
+    *err = create_err(FileError, "Unable to write snapshot '%s'",
+                      snapshot_path);
+    return ARGON_NULL;
+  }
+  fflush(stdout);
+  exit(0);
+})
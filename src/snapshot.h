@@ -0,0 +1,43 @@
+/*
+ * SPDX-FileCopyrightText: 2026 William Bell
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+#include "arobject.h"
+
+typedef enum {
+  SNAPSHOT_NONE = 0,
+  SNAPSHOT_RECORD,
+  SNAPSHOT_REPLAY,
+} SnapshotMode;
+
+extern SnapshotMode snapshot_mode;
+extern bool snapshot_until_ready;
+
+// start recording every module translated during this run into `path`
+void snapshot_begin_record(char *path, char *main_path, bool until_ready);
+
+// load a snapshot written by --snapshot, returning the main module path
+char *snapshot_begin_replay(char *path, ArErr *err);
+
+// write the recorded modules out to the snapshot file
+int snapshot_write(void);
+
+void snapshot_record_module(char *path, uint64_t source_hash,
+                            Translated *translated);
+
+// returns 0 and fills translated_dest if the snapshot has an up to date copy
+int snapshot_load_module(Translated *translated_dest, char *path);
+
+void snapshot_record_resolution(char *current_directory, char *path_relative,
+                                char *path);
+
+char *snapshot_lookup_resolution(char *current_directory,
+                                 char *path_relative);
+
+EXPOSE_ARGON_FUNCTION(ARGON_PROGRAM_READY)
+
+#endif // SNAPSHOT_H
@@ -7,6 +7,7 @@
 #include "../../hash_data/hash_data.h"
 #include "../../memory.h"
 #include "../../parser/assignable/identifier/identifier.h"
+#include "../string/string.h"
 #include "../translator.h"
 #include <stddef.h>
 #include <stdint.h>
@@ -219,17 +220,8 @@ size_t translate_destructure(Translated *translated, Destructure *destructure,
           char *key_name = ((ParsedIdentifier *)item->key->data)->name;
           size_t key_name_length = strlen(key_name);
 
-          size_t key_string_pos =
-              arena_push(&translated->constants, key_name, key_name_length);
-
           set_registers(translated, 1);
-          push_instruction_byte(translated, OP_LOAD_STRING);
-          push_instruction_byte(translated, 0);
-          push_instruction_code(translated, key_name_length);
-          push_instruction_code(translated, key_string_pos);
-          push_instruction_code(
-              translated,
-              siphash64_bytes(key_name, key_name_length, siphash_key_fixed));
+          push_load_string(translated, key_name, key_name_length);
         } else {
           translate_parsed(translated, item->key, err);
           if (is_error(err)) {
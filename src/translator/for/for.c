@@ -13,7 +13,7 @@
 
 size_t translate_parsed_for(Translated *translated, ParsedFor *parsedFor,
                             ArErr *err) {
-  uint8_t iterator_and_err_register = translated->registerAssignment++;
+  uint8_t iterator_register = translated->registerAssignment++;
   uint8_t iterator_next_register = translated->registerAssignment++;
   set_registers(translated, translated->registerAssignment);
   struct break_or_return_jump old_break_jump = translated->break_jump;
@@ -23,10 +23,7 @@ size_t translate_parsed_for(Translated *translated, ParsedFor *parsedFor,
   translated->break_jump.exception_handler_depth =
       translated->exception_handler_depth;
   translated->break_jump.scope_depth = translated->scope_depth;
-  size_t first = push_instruction_byte(translated, OP_EXCEPTION_CATCHER_PUSH);
-  uint64_t jump_index = push_instruction_code(translated, 0);
-
-  push_instruction_byte(translated, OP_NEW_SCOPE);
+  size_t first = push_instruction_byte(translated, OP_NEW_SCOPE);
   translated->scope_depth++;
   translate_parsed(translated, parsedFor->iterator, err);
   if (is_error(err)) {
@@ -41,7 +38,7 @@ size_t translate_parsed_for(Translated *translated, ParsedFor *parsedFor,
 
   push_instruction_byte(translated, OP_COPY_TO_REGISTER);
   push_instruction_byte(translated, 0);
-  push_instruction_byte(translated, iterator_and_err_register);
+  push_instruction_byte(translated, iterator_register);
 
   push_instruction_byte(translated, OP_LOAD_NEXT_METHOD);
 
@@ -51,8 +48,9 @@ size_t translate_parsed_for(Translated *translated, ParsedFor *parsedFor,
 
   size_t start_of_loop = push_instruction_byte(translated, OP_EMPTY_SCOPE);
   push_instruction_byte(translated, OP_FOR_LOOP_JUMP);
-  push_instruction_byte(translated, iterator_and_err_register);
+  push_instruction_byte(translated, iterator_register);
   push_instruction_byte(translated, iterator_next_register);
+  uint64_t exhausted_index = push_instruction_code(translated, 0);
 
   struct continue_jump old_continue_jump = translated->continue_jump;
   translated->continue_jump =
@@ -70,6 +68,9 @@ size_t translate_parsed_for(Translated *translated, ParsedFor *parsedFor,
   push_instruction_byte(translated, OP_JUMP);
   push_instruction_code(translated, start_of_loop);
 
+  set_instruction_code(translated, exhausted_index,
+                       push_instruction_byte(translated, OP_POP_SCOPE));
+
   for (size_t i = 0; i < break_jumps.size; i++) {
     size_t *index = darray_get(&break_jumps, i);
     set_instruction_code(translated, *index, translated->bytecode.size);
@@ -77,44 +78,7 @@ size_t translate_parsed_for(Translated *translated, ParsedFor *parsedFor,
   darray_free(&break_jumps, NULL);
   translated->break_jump = old_break_jump;
 
-  push_instruction_byte(translated, OP_JUMP);
-  size_t break_skip = push_instruction_code(translated, 0);
-
-  set_instruction_code(translated, jump_index,
-                       push_instruction_byte(translated, OP_COPY_TO_REGISTER));
-  push_instruction_byte(translated, 0);
-  push_instruction_byte(translated, iterator_and_err_register);
-
-  push_instruction_byte(translated, OP_LOAD_IS_INSTANCE_FUNCTION);
-  push_instruction_byte(translated, OP_INIT_CALL);
-  push_instruction_code(translated, 2);
-
-  push_instruction_byte(translated, OP_COPY_TO_REGISTER);
-  push_instruction_byte(translated, iterator_and_err_register);
-  push_instruction_byte(translated, 0);
-  push_instruction_byte(translated, OP_INSERT_ARG);
-  push_instruction_code(translated, 0);
-
-  push_instruction_byte(translated, OP_LOAD_STOPITERATION_CLASS);
-  push_instruction_byte(translated, OP_INSERT_ARG);
-  push_instruction_code(translated, 1);
-
-  push_instruction_byte(translated, OP_CALL);
-  push_instruction_byte(translated, OP_NOT);
-
-  push_instruction_byte(translated, OP_JUMP_IF_FALSE);
-  push_instruction_byte(translated, 0);
-  size_t is_exception_type = push_instruction_code(translated, 0);
-
-  push_instruction_byte(translated, OP_COPY_TO_REGISTER);
-  push_instruction_byte(translated, iterator_and_err_register);
-  push_instruction_byte(translated, 0);
-  push_instruction_byte(translated, OP_QUIET_THROW);
-  set_instruction_code(translated, is_exception_type,
-                       translated->bytecode.size);
-
-  set_instruction_code(translated, break_skip,
-                       push_instruction_byte(translated, OP_LOAD_NULL));
+  push_instruction_byte(translated, OP_LOAD_NULL);
   push_instruction_byte(translated, 0);
 
   translated->continue_jump = old_continue_jump;
@@ -6,12 +6,28 @@
 
 #include "function.h"
 #include "../../hash_data/hash_data.h"
+#include "../../memory.h"
 #include "../translator.h"
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+
+static void set_toc_entry(uint8_t *toc, size_t entry, uint64_t value) {
+  uint64_to_bytes(value, toc + entry * sizeof(uint64_t));
+}
+
+static void push_toc_name(Translated *translated, uint8_t *toc, size_t *entry,
+                          char *name) {
+  size_t length = strlen(name);
+  set_toc_entry(toc, (*entry)++,
+                arena_push(&translated->constants, name, length));
+  set_toc_entry(toc, (*entry)++, length);
+  set_toc_entry(toc, (*entry)++,
+                siphash64_bytes(name, length, siphash_key_fixed));
+}
+
 size_t translate_parsed_function(Translated *translated,
                                  ParsedFunction *parsedFunction, ArErr *err) {
   DArray main_bytecode = translated->bytecode;
@@ -60,56 +76,46 @@ size_t translate_parsed_function(Translated *translated,
   translated->scope_depth = old_scope_depth;
   translated->exception_handler_depth = old_exception_handler_depth;
 
-  size_t start = push_instruction_byte(translated, OP_LOAD_FUNCTION);
-  size_t offset = arena_push(&translated->constants, parsedFunction->name,
-                             strlen(parsedFunction->name));
-  push_instruction_code(translated, offset);
-  push_instruction_code(translated, strlen(parsedFunction->name));
-  push_instruction_code(translated, function_bytecode_offset);
-  push_instruction_code(translated, function_bytecode_length *
-                                        translated->bytecode.element_size);
-  push_instruction_code(translated, parsedFunction->parameters.size);
-  push_instruction_code(translated,
-                        parsedFunction->default_value_parameters
-                            ? parsedFunction->default_value_parameters->size
-                            : 0);
+  size_t toc_size =
+      FUNCTION_TOC_HEADER_SIZE +
+      3 * (parsedFunction->parameters.size +
+           (parsedFunction->v_parameter ? 1 : 0) +
+           (parsedFunction->kw_parameter ? 1 : 0));
+  uint8_t *toc = checked_malloc(toc_size * sizeof(uint64_t));
+  set_toc_entry(toc, FUNCTION_TOC_NAME_OFFSET,
+                arena_push(&translated->constants, parsedFunction->name,
+                           strlen(parsedFunction->name)));
+  set_toc_entry(toc, FUNCTION_TOC_NAME_LENGTH, strlen(parsedFunction->name));
+  set_toc_entry(toc, FUNCTION_TOC_BYTECODE_OFFSET, function_bytecode_offset);
+  set_toc_entry(toc, FUNCTION_TOC_BYTECODE_LENGTH,
+                function_bytecode_length * translated->bytecode.element_size);
+  set_toc_entry(toc, FUNCTION_TOC_PARAMETER_COUNT,
+                parsedFunction->parameters.size);
+  set_toc_entry(toc, FUNCTION_TOC_FLAGS,
+                (parsedFunction->v_parameter ? FUNCTION_TOC_HAS_VARGS : 0) |
+                    (parsedFunction->kw_parameter ? FUNCTION_TOC_HAS_KWARGS
+                                                  : 0));
 
+  size_t entry = FUNCTION_TOC_HEADER_SIZE;
   for (size_t i = 0; i < parsedFunction->parameters.size; i++) {
     char **parameter_name = darray_get(&parsedFunction->parameters, i);
-    offset = arena_push(&translated->constants, *parameter_name,
-                        strlen(*parameter_name));
-    push_instruction_byte(translated, OP_SET_FUNCTION_PARAMETER);
-    push_instruction_code(translated, i);
-    push_instruction_code(translated, offset);
-    push_instruction_code(translated, strlen(*parameter_name));
-    push_instruction_code(translated, siphash64_bytes(*parameter_name,
-                                                      strlen(*parameter_name),
-                                                      siphash_key_fixed));
+    push_toc_name(translated, toc, &entry, *parameter_name);
   }
+  if (parsedFunction->v_parameter)
+    push_toc_name(translated, toc, &entry, parsedFunction->v_parameter);
+  if (parsedFunction->kw_parameter)
+    push_toc_name(translated, toc, &entry, parsedFunction->kw_parameter);
 
-  if (parsedFunction->v_parameter) {
-    char *parameter_name = parsedFunction->v_parameter;
-    offset = arena_push(&translated->constants, parameter_name,
-                        strlen(parameter_name));
-    push_instruction_byte(translated, OP_SET_FUNCTION_POSITIONAL_PARAMETER);
-    push_instruction_code(translated, offset);
-    push_instruction_code(translated, strlen(parameter_name));
-    push_instruction_code(translated, siphash64_bytes(parameter_name,
-                                                      strlen(parameter_name),
-                                                      siphash_key_fixed));
-  }
+  size_t toc_offset = arena_push(&translated->constants, toc,
+                                 toc_size * sizeof(uint64_t));
+  free(toc);
 
-  if (parsedFunction->kw_parameter) {
-    char *parameter_name = parsedFunction->kw_parameter;
-    offset = arena_push(&translated->constants, parameter_name,
-                        strlen(parameter_name));
-    push_instruction_byte(translated, OP_SET_FUNCTION_KEY_WORD_PARAMETER);
-    push_instruction_code(translated, offset);
-    push_instruction_code(translated, strlen(parameter_name));
-    push_instruction_code(translated, siphash64_bytes(parameter_name,
-                                                      strlen(parameter_name),
-                                                      siphash_key_fixed));
-  }
+  size_t start = push_instruction_byte(translated, OP_LOAD_FUNCTION);
+  push_instruction_code(translated, toc_offset);
+  push_instruction_code(translated,
+                        parsedFunction->default_value_parameters
+                            ? parsedFunction->default_value_parameters->size
+                            : 0);
 
   if (parsedFunction->default_value_parameters) {
     uint8_t funcRegister = translated->registerAssignment++;
@@ -124,8 +130,8 @@ size_t translate_parsed_function(Translated *translated,
 
       translate_parsed(translated, parameter->value, err);
 
-      offset = arena_push(&translated->constants, parameter->name,
-                          strlen(parameter->name));
+      size_t offset = arena_push(&translated->constants, parameter->name,
+                                 strlen(parameter->name));
       push_instruction_byte(translated, OP_SET_FUNCTION_DEFAULT_PARAMETER);
       push_instruction_byte(translated, funcRegister);
       push_instruction_code(translated, i);
@@ -0,0 +1,525 @@
+/*
+ * SPDX-FileCopyrightText: 2026 William Bell
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "optimise.h"
+#include "../../memory.h"
+#include "../../parser/assignable/assign/assign.h"
+#include "../../parser/assignable/call/call.h"
+#include "../../parser/class/class.h"
+#include "../../parser/conditional_expression/conditional_expression.h"
+#include "../../parser/declaration/declaration.h"
+#include "../../parser/dictionary/dictionary.h"
+#include "../../parser/for/for.h"
+#include "../../parser/function/function.h"
+#include "../../parser/if/if.h"
+#include "../../parser/not/not.h"
+#include "../../parser/operations/operations.h"
+#include "../../parser/return/return.h"
+#include "../../parser/string/string.h"
+#include "../../parser/throw/throw.h"
+#include "../../parser/trycatch/trycatch.h"
+#include "../../parser/while/while.h"
+#include <gmp.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// exponents above this are left for the runtime so a stray `10^100000` does
+// not balloon the constant arena.
+#define MAX_FOLDED_EXPONENT 1024
+
+static bool is_literal(ParsedValue *parsedValue) {
+  switch (parsedValue->type) {
+  case AST_NUMBER:
+  case AST_STRING:
+  case AST_BOOLEAN:
+  case AST_NULL:
+    return true;
+  default:
+    return false;
+  }
+}
+
+static bool literal_truthy(ParsedValue *parsedValue) {
+  switch (parsedValue->type) {
+  case AST_NUMBER:
+    return mpq_sgn(*(mpq_t *)parsedValue->data) != 0;
+  case AST_STRING:
+    return ((ParsedString *)parsedValue->data)->length != 0;
+  case AST_BOOLEAN:
+    return (bool)parsedValue->data;
+  default:
+    return false;
+  }
+}
+
+static void replace_with_bool(ParsedValue *parsedValue, bool value) {
+  free_parsed(parsedValue);
+  parsedValue->type = AST_BOOLEAN;
+  parsedValue->data = (void *)value;
+}
+
+static void replace_with_null(ParsedValue *parsedValue) {
+  free_parsed(parsedValue);
+  parsedValue->type = AST_NULL;
+  parsedValue->data = NULL;
+}
+
+// child must be owned by parsedValue; it is detached before the parent is
+// freed so only the rest of the parent goes.
+static void replace_with_child(ParsedValue *parsedValue, ParsedValue *child) {
+  ParsedValue moved = *child;
+  child->type = AST_NULL;
+  child->data = NULL;
+  free_parsed(parsedValue);
+  *parsedValue = moved;
+}
+
+static void optimise_array(DArray *values) {
+  for (size_t i = 0; i < values->size; i++)
+    optimise_parsed(darray_get(values, i));
+}
+
+static bool fold_number(ArTokenType operation, mpq_t result, mpq_t operand) {
+  switch (operation) {
+  case TOKEN_PLUS:
+    mpq_add(result, result, operand);
+    return true;
+  case TOKEN_MINUS:
+    mpq_sub(result, result, operand);
+    return true;
+  case TOKEN_STAR:
+    mpq_mul(result, result, operand);
+    return true;
+  case TOKEN_SLASH:
+    if (mpq_sgn(operand) == 0)
+      return false;
+    mpq_div(result, result, operand);
+    return true;
+  case TOKEN_CARET: {
+    if (mpz_cmp_ui(mpq_denref(operand), 1) != 0 ||
+        mpz_cmpabs_ui(mpq_numref(operand), MAX_FOLDED_EXPONENT) > 0)
+      return false;
+    long exponent = mpz_get_si(mpq_numref(operand));
+    if (exponent < 0 && mpq_sgn(result) == 0)
+      return false;
+    unsigned long magnitude = exponent < 0 ? -exponent : exponent;
+    // powers of coprime integers stay coprime, so no canonicalise needed.
+    mpz_pow_ui(mpq_numref(result), mpq_numref(result), magnitude);
+    mpz_pow_ui(mpq_denref(result), mpq_denref(result), magnitude);
+    if (exponent < 0)
+      mpq_inv(result, result);
+    return true;
+  }
+  default:
+    return false;
+  }
+}
+
+static bool compare_numbers(ArTokenType operation, mpq_t a, mpq_t b,
+                            bool *result) {
+  int cmp = mpq_cmp(a, b);
+  switch (operation) {
+  case TOKEN_EQ:
+    *result = cmp == 0;
+    return true;
+  case TOKEN_NE:
+    *result = cmp != 0;
+    return true;
+  case TOKEN_LT:
+    *result = cmp < 0;
+    return true;
+  case TOKEN_GT:
+    *result = cmp > 0;
+    return true;
+  case TOKEN_LE:
+    *result = cmp <= 0;
+    return true;
+  case TOKEN_GE:
+    *result = cmp >= 0;
+    return true;
+  default:
+    return false;
+  }
+}
+
+static bool compare_strings(ArTokenType operation, ParsedString *a,
+                            ParsedString *b, bool *result) {
+  bool equal = a->length == b->length &&
+               (!a->length || memcmp(a->string, b->string, a->length) == 0);
+  switch (operation) {
+  case TOKEN_EQ:
+    *result = equal;
+    return true;
+  case TOKEN_NE:
+    *result = !equal;
+    return true;
+  default:
+    return false;
+  }
+}
+
+static void append_parsed_string(ParsedString *to, ParsedString *from) {
+  to->string = realloc(to->string, to->length + from->length + 1);
+  if (!to->string) {
+    fprintf(stderr, "fatal error: failed to allocate memory\n");
+    exit(EXIT_FAILURE);
+  }
+  if (from->length)
+    memcpy(to->string + to->length, from->string, from->length);
+  to->length += from->length;
+  to->string[to->length] = '\0';
+}
+
+// drops `count` operands starting at `start`, replacing them with `with` if
+// it is not NULL.
+static void splice_operands(ParsedOperation *operation, size_t start,
+                            size_t count, ParsedValue *with) {
+  DArray operands;
+  darray_init(&operands, sizeof(ParsedValue));
+  for (size_t i = 0; i < operation->to_operate_on.size; i++) {
+    ParsedValue *operand = darray_get(&operation->to_operate_on, i);
+    if (i < start || i >= start + count) {
+      darray_push(&operands, operand);
+      continue;
+    }
+    if (i == start && with)
+      darray_push(&operands, with);
+    free_parsed(operand);
+  }
+  darray_free(&operation->to_operate_on, NULL);
+  operation->to_operate_on = operands;
+}
+
+// folds the leading run of literal operands of an arithmetic chain. only the
+// leading run is safe because the chain is evaluated left to right.
+static void fold_arithmetic(ParsedOperation *operation) {
+  ParsedValue *first = darray_get(&operation->to_operate_on, 0);
+  size_t folded = 1;
+  if (first->type == AST_NUMBER) {
+    mpq_t *result = checked_malloc(sizeof(mpq_t));
+    mpq_init(*result);
+    mpq_set(*result, *(mpq_t *)first->data);
+    for (; folded < operation->to_operate_on.size; folded++) {
+      ParsedValue *operand = darray_get(&operation->to_operate_on, folded);
+      if (operand->type != AST_NUMBER ||
+          !fold_number(operation->operation, *result,
+                       *(mpq_t *)operand->data))
+        break;
+    }
+    if (folded < 2) {
+      mpq_clear(*result);
+      free(result);
+      return;
+    }
+    ParsedValue number = {AST_NUMBER, result};
+    splice_operands(operation, 0, folded, &number);
+  } else if (first->type == AST_STRING &&
+             operation->operation == TOKEN_PLUS) {
+    ParsedString *result = checked_malloc(sizeof(ParsedString));
+    result->length = 0;
+    result->string = NULL;
+    append_parsed_string(result, first->data);
+    for (; folded < operation->to_operate_on.size; folded++) {
+      ParsedValue *operand = darray_get(&operation->to_operate_on, folded);
+      if (operand->type != AST_STRING)
+        break;
+      append_parsed_string(result, operand->data);
+    }
+    if (folded < 2) {
+      free(result->string);
+      free(result);
+      return;
+    }
+    ParsedValue string = {AST_STRING, result};
+    splice_operands(operation, 0, folded, &string);
+  }
+}
+
+static void fold_comparison(ParsedValue *parsedValue) {
+  ParsedOperation *operation = parsedValue->data;
+  if (operation->to_operate_on.size != 2)
+    return;
+  ParsedValue *a = darray_get(&operation->to_operate_on, 0);
+  ParsedValue *b = darray_get(&operation->to_operate_on, 1);
+  bool result;
+  if (a->type == AST_NUMBER && b->type == AST_NUMBER) {
+    if (compare_numbers(operation->operation, *(mpq_t *)a->data,
+                        *(mpq_t *)b->data, &result))
+      replace_with_bool(parsedValue, result);
+  } else if (a->type == AST_STRING && b->type == AST_STRING) {
+    if (compare_strings(operation->operation, a->data, b->data, &result))
+      replace_with_bool(parsedValue, result);
+  }
+}
+
+// `&&` and `||` return the first operand that decides the result, otherwise
+// the last one.
+static void fold_logical(ParsedValue *parsedValue) {
+  ParsedOperation *operation = parsedValue->data;
+  bool deciding_truthiness = operation->operation == TOKEN_OR;
+  size_t skip = 0;
+  for (size_t i = 0; i < operation->to_operate_on.size; i++) {
+    ParsedValue *operand = darray_get(&operation->to_operate_on, i);
+    if (!is_literal(operand))
+      break;
+    if (literal_truthy(operand) == deciding_truthiness ||
+        i + 1 == operation->to_operate_on.size) {
+      replace_with_child(parsedValue, operand);
+      return;
+    }
+    skip++;
+  }
+  if (skip)
+    splice_operands(operation, 0, skip, NULL);
+}
+
+static void optimise_operation(ParsedValue *parsedValue) {
+  ParsedOperation *operation = parsedValue->data;
+  optimise_array(&operation->to_operate_on);
+  switch (operation->operation) {
+  case TOKEN_PLUS:
+  case TOKEN_MINUS:
+  case TOKEN_STAR:
+  case TOKEN_SLASH:
+  case TOKEN_CARET:
+    fold_arithmetic(operation);
+    break;
+  case TOKEN_EQ:
+  case TOKEN_NE:
+  case TOKEN_LT:
+  case TOKEN_GT:
+  case TOKEN_LE:
+  case TOKEN_GE:
+    fold_comparison(parsedValue);
+    return;
+  case TOKEN_AND:
+  case TOKEN_OR:
+    fold_logical(parsedValue);
+    if (parsedValue->type != AST_OPERATION)
+      return;
+    break;
+  default:
+    // `//` and `%` are left alone: the int64 fast path truncates while the
+    // rational path floors, so there is no single answer to fold to.
+    return;
+  }
+  if (operation->to_operate_on.size == 1)
+    replace_with_child(parsedValue,
+                       darray_get(&operation->to_operate_on, 0));
+}
+
+static void optimise_if(ParsedValue *parsedValue) {
+  DArray *parsed_if = parsedValue->data;
+  DArray kept;
+  darray_init(&kept, sizeof(ParsedConditional));
+  bool unreachable = false;
+  for (size_t i = 0; i < parsed_if->size; i++) {
+    ParsedConditional *conditional = darray_get(parsed_if, i);
+    if (unreachable) {
+      free_conditional(conditional);
+      continue;
+    }
+    if (conditional->condition) {
+      optimise_parsed(conditional->condition);
+      if (is_literal(conditional->condition)) {
+        if (!literal_truthy(conditional->condition)) {
+          free_conditional(conditional);
+          continue;
+        }
+        free_parsed(conditional->condition);
+        free(conditional->condition);
+        conditional->condition = NULL;
+      }
+    }
+    optimise_parsed(conditional->content);
+    if (!conditional->condition)
+      unreachable = true;
+    darray_push(&kept, conditional);
+  }
+  darray_free(parsed_if, NULL);
+  *parsed_if = kept;
+  if (!kept.size)
+    replace_with_null(parsedValue);
+}
+
+static void optimise_template(ParsedValue *parsedValue) {
+  ParsedTemplate *parsed_template = parsedValue->data;
+  if (parsed_template->templater) {
+    // the templater sees every segment, so the layout has to stay as written.
+    optimise_parsed(parsed_template->templater);
+    for (size_t i = 0; i < parsed_template->values.size; i++) {
+      TemplateValue *value = darray_get(&parsed_template->values, i);
+      if (!value->is_string)
+        optimise_parsed(value->value.value);
+    }
+    return;
+  }
+  DArray values;
+  darray_init(&values, sizeof(TemplateValue));
+  for (size_t i = 0; i < parsed_template->values.size; i++) {
+    TemplateValue *value = darray_get(&parsed_template->values, i);
+    if (!value->is_string) {
+      optimise_parsed(value->value.value);
+      if (value->value.value->type == AST_STRING) {
+        ParsedValue *string_value = value->value.value;
+        value->is_string = true;
+        value->value.string = *(ParsedString *)string_value->data;
+        free(string_value->data);
+        free(string_value);
+      }
+    }
+    if (value->is_string && values.size) {
+      TemplateValue *last = darray_get(&values, values.size - 1);
+      if (last->is_string) {
+        append_parsed_string(&last->value.string, &value->value.string);
+        free(value->value.string.string);
+        continue;
+      }
+    }
+    darray_push(&values, value);
+  }
+  darray_free(&parsed_template->values, NULL);
+  parsed_template->values = values;
+
+  if (values.size > 1)
+    return;
+  TemplateValue *only = values.size ? darray_get(&values, 0) : NULL;
+  if (only && !only->is_string)
+    return;
+  ParsedString *string = checked_malloc(sizeof(ParsedString));
+  string->length = 0;
+  string->string = checked_malloc(1);
+  string->string[0] = '\0';
+  if (only) {
+    free(string->string);
+    *string = only->value.string;
+    if (!string->string) {
+      string->string = checked_malloc(1);
+      string->string[0] = '\0';
+    }
+  }
+  darray_free(&parsed_template->values, NULL);
+  free(parsed_template);
+  parsedValue->type = AST_STRING;
+  parsedValue->data = string;
+}
+
+void optimise_parsed(ParsedValue *parsedValue) {
+  if (!parsedValue)
+    return;
+  switch (parsedValue->type) {
+  case AST_OPERATION:
+    optimise_operation(parsedValue);
+    break;
+  case AST_TO_BOOL: {
+    ParsedToBool *to_bool = parsedValue->data;
+    optimise_parsed(to_bool->value);
+    if (is_literal(to_bool->value))
+      replace_with_bool(parsedValue,
+                        literal_truthy(to_bool->value) != to_bool->invert);
+    break;
+  }
+  case AST_NEGATION: {
+    ParsedValue *value = parsedValue->data;
+    optimise_parsed(value);
+    if (value->type == AST_NUMBER) {
+      mpq_neg(*(mpq_t *)value->data, *(mpq_t *)value->data);
+      replace_with_child(parsedValue, value);
+    }
+    break;
+  }
+  case AST_IF:
+    optimise_if(parsedValue);
+    break;
+  case AST_CONDITIONAL_EXCEPTION: {
+    ParsedConditionalExpression *expression = parsedValue->data;
+    optimise_parsed(expression->condition);
+    optimise_parsed(expression->true_body);
+    optimise_parsed(expression->false_body);
+    if (is_literal(expression->condition))
+      replace_with_child(parsedValue, literal_truthy(expression->condition)
+                                          ? expression->true_body
+                                          : expression->false_body);
+    break;
+  }
+  case AST_TEMPLATE:
+    optimise_template(parsedValue);
+    break;
+  case AST_DOWRAP:
+  case AST_ARRAY:
+    optimise_array(parsedValue->data);
+    break;
+  case AST_WHILE: {
+    ParsedWhile *parsed_while = parsedValue->data;
+    optimise_parsed(parsed_while->condition);
+    optimise_parsed(parsed_while->content);
+    break;
+  }
+  case AST_FUNCTION: {
+    ParsedFunction *function = parsedValue->data;
+    optimise_parsed(function->body);
+    if (function->default_value_parameters) {
+      for (size_t i = 0; i < function->default_value_parameters->size; i++) {
+        struct default_value_parameter *parameter =
+            darray_get(function->default_value_parameters, i);
+        optimise_parsed(parameter->value);
+      }
+    }
+    break;
+  }
+  case AST_DECLARATION: {
+    DArray *declarations = parsedValue->data;
+    for (size_t i = 0; i < declarations->size; i++) {
+      ParsedSingleDeclaration *declaration = darray_get(declarations, i);
+      optimise_parsed(declaration->from);
+    }
+    break;
+  }
+  case AST_ASSIGN:
+    optimise_parsed(((ParsedAssign *)parsedValue->data)->from);
+    break;
+  case AST_CALL: {
+    ParsedCall *call = parsedValue->data;
+    optimise_parsed(call->to_call);
+    optimise_array(&call->args);
+    break;
+  }
+  case AST_RETURN:
+    optimise_parsed(((ParsedReturn *)parsedValue->data)->value);
+    break;
+  case AST_THROW:
+    optimise_parsed(((ParsedThrow *)parsedValue->data)->value);
+    break;
+  case AST_DICTIONARY: {
+    DArray *entries = parsedValue->data;
+    for (size_t i = 0; i < entries->size; i++) {
+      ParsedDictionaryEntry *entry = darray_get(entries, i);
+      optimise_parsed(entry->key);
+      optimise_parsed(entry->value);
+    }
+    break;
+  }
+  case AST_FOR: {
+    ParsedFor *parsed_for = parsedValue->data;
+    optimise_parsed(parsed_for->iterator);
+    optimise_parsed(parsed_for->content);
+    break;
+  }
+  case AST_TRY: {
+    ParsedTry *parsed_try = parsedValue->data;
+    optimise_parsed(parsed_try->try_body);
+    optimise_parsed(parsed_try->catch_body);
+    break;
+  }
+  case AST_CLASS:
+    optimise_parsed(((ParsedClass *)parsedValue->data)->body);
+    break;
+  default:
+    break;
+  }
+}
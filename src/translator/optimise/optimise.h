@@ -0,0 +1,15 @@
+/*
+ * SPDX-FileCopyrightText: 2026 William Bell
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef OPTIMISE_H
+#define OPTIMISE_H
+#include "../../parser/parser.h"
+
+// folds constant expressions and prunes unreachable branches in place, before
+// the value is translated.
+void optimise_parsed(ParsedValue *parsedValue);
+
+#endif // OPTIMISE_H
@@ -11,21 +11,27 @@
 #include <stdio.h>
 #include <string.h>
 
-size_t translate_parsed_string(Translated *translated,
-                               ParsedString parsedString) {
-  size_t string_pos = arena_push(&translated->constants, parsedString.string,
-                                 parsedString.length);
-  set_registers(translated, 1);
+size_t push_load_string(Translated *translated, char *string, size_t length) {
+  size_t string_pos = arena_push(&translated->constants, string, length);
   size_t start = push_instruction_byte(translated, OP_LOAD_STRING);
   push_instruction_byte(translated, 0);
-  push_instruction_code(translated, parsedString.length);
+  push_instruction_code(translated, length);
   push_instruction_code(translated, string_pos);
-  push_instruction_code(translated, siphash64_bytes(parsedString.string,
-                                                    parsedString.length,
-                                                    siphash_key_fixed));
+  push_instruction_code(translated,
+                        siphash64_bytes(string, length, siphash_key_fixed));
+  // interned string slot, filled in by the runtime.
+  push_instruction_byte(translated, 0);
+  push_instruction_code(translated, 0);
   return start;
 }
 
+size_t translate_parsed_string(Translated *translated,
+                               ParsedString parsedString) {
+  set_registers(translated, 1);
+  return push_load_string(translated, parsedString.string,
+                          parsedString.length);
+}
+
 size_t translate_parsed_template(Translated *translated,
                                  ParsedTemplate *parsedTemplate, ArErr *err) {
   set_registers(translated, 1);
@@ -60,17 +66,8 @@ size_t translate_parsed_template(Translated *translated,
       if (is_error(err))
         return 0;
     } else {
-      size_t string_pos =
-          arena_push(&translated->constants, item->value.string.string,
-                     item->value.string.length);
-      push_instruction_byte(translated, OP_LOAD_STRING);
-      push_instruction_byte(translated, 0);
-      push_instruction_code(translated, item->value.string.length);
-      push_instruction_code(translated, string_pos);
-      push_instruction_code(translated,
-                            siphash64_bytes(item->value.string.string,
-                                            item->value.string.length,
-                                            siphash_key_fixed));
+      push_load_string(translated, item->value.string.string,
+                       item->value.string.length);
     }
     push_instruction_byte(translated, OP_INSERT_ARG);
     push_instruction_code(translated, 1);
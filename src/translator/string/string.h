@@ -8,6 +8,9 @@
 #define BYTECODE_STRING_H
 #include "../../parser/string/string.h"
 
+// emits OP_LOAD_STRING into register 0 for the given bytes
+size_t push_load_string(Translated *translated, char *string, size_t length);
+
 size_t translate_parsed_string(Translated *translated, ParsedString parsedString);
 
 size_t translate_parsed_template(Translated *translated, ParsedTemplate *parsedTemplate,
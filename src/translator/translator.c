@@ -31,6 +31,7 @@
 #include "item_access/item_access.h"
 #include "number/number.h"
 #include "operation/operation.h"
+#include "optimise/optimise.h"
 #include "return/return.h"
 #include "string/string.h"
 #include "try/try.h"
@@ -47,6 +48,14 @@ void uint64_to_bytes(uint64_t value, uint8_t bytes[8]) {
   }
 }
 
+uint64_t bytes_to_uint64(const uint8_t bytes[8]) {
+  uint64_t value = 0;
+  for (int i = 0; i < 8; i++) {
+    value |= (uint64_t)bytes[i] << (i * 8);
+  }
+  return value;
+}
+
 void arena_init(ConstantArena *arena) {
   arena->data = malloc(CHUNK_SIZE);
   arena->capacity = CHUNK_SIZE;
@@ -372,6 +381,7 @@ ArErr translate(Translated *translated, DArray *ast) {
   ArErr err = no_err;
   for (size_t i = 0; i < ast->size; i++) {
     ParsedValue *parsedValue = darray_get(ast, i);
+    optimise_parsed(parsedValue);
     translate_parsed(translated, parsedValue, &err);
     if (is_error(&err)) {
       break;
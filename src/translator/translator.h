@@ -17,9 +17,6 @@ typedef enum {
   OP_DECLARE,
   OP_LOAD_NULL,
   OP_LOAD_FUNCTION,
-  OP_SET_FUNCTION_PARAMETER,
-  OP_SET_FUNCTION_POSITIONAL_PARAMETER,
-  OP_SET_FUNCTION_KEY_WORD_PARAMETER,
   OP_SET_FUNCTION_DEFAULT_PARAMETER,
   OP_IDENTIFIER,
   OP_DELETE_IDENTIFIER,
@@ -91,6 +88,29 @@ typedef enum {
   OP_LOAD_DICTIONARY_CLASS
 } OperationType;
 
+// layout of the table of contents archived in the constant arena for every
+// function, as little endian uint64 entries like every other operand, so
+// cached bytecode reads the same on any host. the header is followed by an (offset, length,
+// hash) triple per parameter name, then one for the positional and key word
+// parameters when the matching flag is set.
+typedef enum {
+  FUNCTION_TOC_NAME_OFFSET,
+  FUNCTION_TOC_NAME_LENGTH,
+  FUNCTION_TOC_BYTECODE_OFFSET,
+  FUNCTION_TOC_BYTECODE_LENGTH,
+  FUNCTION_TOC_PARAMETER_COUNT,
+  FUNCTION_TOC_FLAGS,
+  FUNCTION_TOC_HEADER_SIZE
+} FunctionTocEntry;
+
+#define FUNCTION_TOC_HAS_VARGS 1
+#define FUNCTION_TOC_HAS_KWARGS 2
+
+// little endian, whatever the host's byte order
+void uint64_to_bytes(uint64_t value, uint8_t bytes[8]);
+
+uint64_t bytes_to_uint64(const uint8_t bytes[8]);
+
 void arena_resize(ConstantArena *arena, size_t new_size);
 
 size_t arena_push(ConstantArena *arena, const void *data, size_t length);
@@ -6,6 +6,7 @@
 #define FILE_HANDLE_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 
 typedef enum {
@@ -15,10 +16,18 @@ typedef enum {
 } FileType;
 
 
+#define FILE_READ_BUFFER (64 * 1024)
+
 typedef struct {
     FILE *fp;
     bool is_open;
     FileType type;
+    // read ahead for readline, malloc'd on first use and freed on close.
+    // grows past FILE_READ_BUFFER only to hold a longer line.
+    char *read_buffer;
+    size_t read_capacity;
+    size_t read_start;
+    size_t read_end;
 } FileHandle;
 
 #endif
\ No newline at end of file
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "./handle.h"
+#include "./tree.h"
 #include "Argon.h"
 #include "ArgonFunction.h"
 #include <errno.h>
@@ -21,6 +22,7 @@
 
 #include <dirent.h>
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <unistd.h>
 #if defined(__linux__)
@@ -29,6 +31,83 @@
 #endif
 #endif
 
+static size_t buffered_length(FileHandle *handle) {
+  return handle->read_end - handle->read_start;
+}
+
+// moves up to size read-ahead bytes into out.
+static size_t take_buffered(FileHandle *handle, char *out, size_t size) {
+  size_t n = buffered_length(handle);
+  if (n > size)
+    n = size;
+  if (n) {
+    memcpy(out, handle->read_buffer + handle->read_start, n);
+    handle->read_start += n;
+  }
+  return n;
+}
+
+// seeks the stream back over the read-ahead, for calls that need the real
+// position, like a write on a "+" file.
+static bool drop_read_buffer(FileHandle *handle) {
+  size_t pending = buffered_length(handle);
+  handle->read_start = handle->read_end = 0;
+  return !pending || fseek(handle->fp, -(long)pending, SEEK_CUR) == 0;
+}
+
+// reads more into the buffer after the unread bytes, growing it when they
+// already fill it. returns the bytes added, 0 at the end of the file, or -1
+// with errno set. the standard streams stop at a newline so an interactive
+// readline does not wait for a whole buffer.
+static long fill_read_buffer(FileHandle *handle) {
+  if (handle->read_start) {
+    memmove(handle->read_buffer, handle->read_buffer + handle->read_start,
+            buffered_length(handle));
+    handle->read_end -= handle->read_start;
+    handle->read_start = 0;
+  }
+  if (handle->read_end == handle->read_capacity) {
+    size_t capacity =
+        handle->read_capacity ? handle->read_capacity * 2 : FILE_READ_BUFFER;
+    char *grown = realloc(handle->read_buffer, capacity);
+    if (!grown) {
+      errno = ENOMEM;
+      return -1;
+    }
+    handle->read_buffer = grown;
+    handle->read_capacity = capacity;
+  }
+  size_t n = 0;
+  char *out = handle->read_buffer + handle->read_end;
+  size_t space = handle->read_capacity - handle->read_end;
+  if (handle->type == FILE_STD) {
+    int c;
+    while (n < space && (c = getc(handle->fp)) != EOF) {
+      out[n++] = (char)c;
+      if (c == '\n')
+        break;
+    }
+  } else {
+    n = fread(out, 1, space, handle->fp);
+  }
+  if (!n && ferror(handle->fp))
+    return -1;
+  handle->read_end += n;
+  return (long)n;
+}
+
+static ArgonObject *bytes_to_argon(const char *data, size_t length,
+                                   bool is_binary, ArgonError *err,
+                                   ArgonNativeAPI *api) {
+  if (!is_binary)
+    return api->string_to_argon((struct string){(char *)data, length});
+  ArgonObject *result = api->create_argon_buffer(length);
+  struct buffer result_buffer = api->argon_buffer_to_buffer(result, err);
+  if (length)
+    memcpy(result_buffer.data, data, length);
+  return result;
+}
+
 ARGON_FUNCTION(open_handle, {
   if (api->fix_to_arg_size(6, argc, err))
     return api->ARGON_NULL;
@@ -109,6 +188,7 @@ ARGON_FUNCTION(read_all, {
     long size = ftell(handle->fp);
     if (size >= 0 && fseek(handle->fp, 0, SEEK_SET) == 0) {
       // seekable, allocate exact size
+      handle->read_start = handle->read_end = 0;
       buf = malloc(size + 1);
       if (!buf)
         return api->throw_argon_error(err, argv[1], "out of memory");
@@ -123,6 +203,13 @@ ARGON_FUNCTION(read_all, {
     }
   }
   clearerr(handle->fp);
+  total = buffered_length(handle);
+  if (total) {
+    buf = malloc(total);
+    if (!buf)
+      return api->throw_argon_error(err, argv[2], "out of memory");
+    take_buffered(handle, buf, total);
+  }
   char chunk[4096];
   size_t n;
   while ((n = fread(chunk, 1, sizeof(chunk), handle->fp)) > 0) {
@@ -179,7 +266,9 @@ ARGON_FUNCTION(read, {
   if (!buf)
     return api->throw_argon_error(err, argv[3], "out of memory");
 
-  size_t n = fread(buf, 1, size, handle->fp);
+  size_t n = take_buffered(handle, buf, size);
+  if (n < (size_t)size)
+    n += fread(buf + n, 1, size - n, handle->fp);
 
   if (ferror(handle->fp)) {
     free(buf);
@@ -207,6 +296,76 @@ ARGON_FUNCTION(read, {
   return result;
 })
 
+// readline(handle, is_binary, FileReadError) -> the next line with its
+// newline, or an empty string or buffer at the end of the file
+ARGON_FUNCTION(readline, {
+  if (api->fix_to_arg_size(3, argc, err))
+    return api->ARGON_NULL;
+
+  struct buffer handle_buffer = api->argon_buffer_to_buffer(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  bool is_binary = argv[1] == api->ARGON_TRUE;
+
+  FileHandle *handle = handle_buffer.data;
+  if (!handle->is_open)
+    return api->throw_argon_error(err, argv[2], "file is closed");
+
+  size_t scanned = 0;
+  size_t length;
+  while (true) {
+    size_t pending = buffered_length(handle);
+    char *start = handle->read_buffer + handle->read_start;
+    char *newline =
+        pending > scanned ? memchr(start + scanned, '\n', pending - scanned)
+                          : NULL;
+    if (newline) {
+      length = newline - start + 1;
+      break;
+    }
+    scanned = pending;
+    long added = fill_read_buffer(handle);
+    if (added < 0)
+      return api->throw_argon_error(err, argv[2], "%s", strerror(errno));
+    if (added == 0) {
+      length = pending;
+      break;
+    }
+  }
+
+  ArgonObject *result =
+      bytes_to_argon(handle->read_buffer + handle->read_start, length,
+                     is_binary, err, api);
+  handle->read_start += length;
+  return result;
+})
+
+// readinto(handle, buffer, FileReadError) -> bytes read, 0 at the end of
+// the file
+ARGON_FUNCTION(readinto, {
+  if (api->fix_to_arg_size(3, argc, err))
+    return api->ARGON_NULL;
+
+  struct buffer handle_buffer = api->argon_buffer_to_buffer(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  struct buffer target = api->argon_buffer_to_buffer(argv[1], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  FileHandle *handle = handle_buffer.data;
+  if (!handle->is_open)
+    return api->throw_argon_error(err, argv[2], "file is closed");
+
+  size_t n = take_buffered(handle, target.data, target.size);
+  if (n < target.size)
+    n += fread((char *)target.data + n, 1, target.size - n, handle->fp);
+  if (ferror(handle->fp))
+    return api->throw_argon_error(err, argv[2], "%s", strerror(errno));
+
+  return api->i64_to_argon((int64_t)n);
+})
+
 ARGON_FUNCTION(write, {
   if (api->fix_to_arg_size(4, argc, err))
     return api->ARGON_NULL;
@@ -221,6 +380,9 @@ ARGON_FUNCTION(write, {
 
   bool is_binary = argv[2] == api->ARGON_TRUE;
 
+  if (!drop_read_buffer(handle))
+    return api->throw_argon_error(err, argv[3], "%s", strerror(errno));
+
   const char *data;
   size_t length;
 
@@ -259,6 +421,10 @@ ARGON_FUNCTION(close, {
   if (!handle->is_open)
     return api->ARGON_NULL;
 
+  free(handle->read_buffer);
+  handle->read_buffer = NULL;
+  handle->read_capacity = handle->read_start = handle->read_end = 0;
+
   if (handle->type == FILE_NORMAL && fclose(handle->fp) != 0)
     return api->throw_argon_error(err, argv[1], "%s", strerror(errno));
 
@@ -292,6 +458,11 @@ ARGON_FUNCTION(seek, {
     return api->throw_argon_error(err, argv[3], "invalid whence value: %lld",
                                   whence);
 
+  // the read ahead sits between the stream and the caller's position
+  if (whence == SEEK_CUR)
+    offset -= (int64_t)buffered_length(handle);
+  handle->read_start = handle->read_end = 0;
+
   if (fseek(handle->fp, (long)offset, (int)whence) != 0)
     return api->throw_argon_error(err, argv[3], "%s", strerror(errno));
 
@@ -314,7 +485,7 @@ ARGON_FUNCTION(tell, {
   if (pos < 0)
     return api->throw_argon_error(err, argv[1], "%s", strerror(errno));
 
-  return api->i64_to_argon((int64_t)pos);
+  return api->i64_to_argon((int64_t)pos - (int64_t)buffered_length(handle));
 })
 
 ARGON_FUNCTION(flush, {
@@ -335,6 +506,26 @@ ARGON_FUNCTION(flush, {
   return api->ARGON_NULL;
 })
 
+// the OS file descriptor under the handle, for modules that hand the file to
+// the kernel themselves. buffered writes are flushed first so it sees them.
+ARGON_FUNCTION(fileno, {
+  if (api->fix_to_arg_size(2, argc, err))
+    return api->ARGON_NULL;
+
+  struct buffer handle_buffer = api->argon_buffer_to_buffer(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  FileHandle *handle = handle_buffer.data;
+  if (!handle->is_open)
+    return api->throw_argon_error(err, argv[1], "file is closed");
+
+  if (fflush(handle->fp) != 0)
+    return api->throw_argon_error(err, argv[1], "%s", strerror(errno));
+
+  return api->i64_to_argon(fileno(handle->fp));
+})
+
 ARGON_FUNCTION(file_size, {
   if (api->fix_to_arg_size(2, argc, err))
     return api->ARGON_NULL;
@@ -1308,87 +1499,11 @@ static bool argon_copy_file_native(const char *src, const char *dst,
 
 #else
 
-  int in_fd = open(src, O_RDONLY);
-
-  if (in_fd < 0) {
-    if (error_number)
-      *error_number = errno;
-
-    return false;
-  }
-
-  struct stat st;
-
-  if (fstat(in_fd, &st) != 0) {
-    if (error_number)
-      *error_number = errno;
-
-    close(in_fd);
-    return false;
-  }
-
-  int out_fd = open(dst, O_WRONLY | O_CREAT | O_EXCL, st.st_mode & 0777);
-
-  if (out_fd < 0) {
-    if (error_number)
-      *error_number = errno;
-
-    close(in_fd);
-    return false;
-  }
-
-  char buffer[64 * 1024];
-
-  while (true) {
-
-    ssize_t bytes_read = read(in_fd, buffer, sizeof(buffer));
-
-    if (bytes_read == 0)
-      break;
-
-    if (bytes_read < 0) {
-
-      if (error_number)
-        *error_number = errno;
-
-      close(in_fd);
-      close(out_fd);
-      unlink(dst);
-
-      return false;
-    }
-
-    ssize_t offset = 0;
-
-    while (offset < bytes_read) {
-
-      ssize_t bytes_written =
-          write(out_fd, buffer + offset, (size_t)(bytes_read - offset));
-
-      if (bytes_written <= 0) {
-
-        if (error_number)
-          *error_number = errno;
-
-        close(in_fd);
-        close(out_fd);
-        unlink(dst);
-
-        return false;
-      }
-
-      offset += bytes_written;
-    }
-  }
-
-  close(in_fd);
-
-  if (close(out_fd) != 0) {
+  int error = argon_copy_file_at(AT_FDCWD, src, AT_FDCWD, dst);
 
+  if (error != 0) {
     if (error_number)
-      *error_number = errno;
-
-    unlink(dst);
+      *error_number = error;
 
     return false;
   }
@@ -1399,7 +1514,7 @@ static bool argon_copy_file_native(const char *src, const char *dst,
 }
 
 static bool argon_copy_directory_native(const char *src, const char *dst,
-                                        int *error_number) {
+                                        size_t threads, int *error_number) {
 
   if (!argon_is_directory(src)) {
 
@@ -1484,7 +1599,8 @@ static bool argon_copy_directory_native(const char *src, const char *dst,
 
     if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
 
-      if (!argon_copy_directory_native(src_path, dst_path, error_number)) {
+      if (!argon_copy_directory_native(src_path, dst_path, threads,
+                                       error_number)) {
 
         success = false;
       }
@@ -1511,82 +1627,22 @@ static bool argon_copy_directory_native(const char *src, const char *dst,
 
 #else
 
-  if (mkdir(dst, 0755) != 0) {
-
-    if (errno != EEXIST || !argon_is_directory(dst)) {
-
-      if (error_number)
-        *error_number = errno;
-
-      return false;
-    }
-  }
-
-  DIR *directory = opendir(src);
-
-  if (!directory) {
+  int error = argon_copy_tree(src, dst, threads);
 
+  if (error != 0) {
     if (error_number)
-      *error_number = errno;
+      *error_number = error;
 
     return false;
   }
 
-  bool success = true;
-
-  struct dirent *entry;
-
-  while ((entry = readdir(directory)) != NULL) {
-
-    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
-      continue;
-
-    char *src_path = argon_path_join(src, entry->d_name);
-
-    char *dst_path = argon_path_join(dst, entry->d_name);
-
-    if (!src_path || !dst_path) {
-
-      free(src_path);
-      free(dst_path);
-
-      if (error_number)
-        *error_number = ENOMEM;
-
-      success = false;
-      break;
-    }
-
-    if (argon_is_directory(src_path)) {
-
-      if (!argon_copy_directory_native(src_path, dst_path, error_number)) {
-
-        success = false;
-      }
-
-    } else if (argon_is_file(src_path)) {
-
-      if (!argon_copy_file_native(src_path, dst_path, error_number)) {
-
-        success = false;
-      }
-    }
-
-    free(src_path);
-    free(dst_path);
-
-    if (!success)
-      break;
-  }
-
-  closedir(directory);
-
-  return success;
+  return true;
 
 #endif
 }
 
-static bool argon_remove_directory_native(const char *path, int *error_number) {
+static bool argon_remove_directory_native(const char *path, size_t threads,
+                                          int *error_number) {
 
 #if defined(_WIN32) || defined(_WIN64)
 
@@ -1627,7 +1683,7 @@ static bool argon_remove_directory_native(const char *path, int *error_number) {
 
       if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
 
-        result = argon_remove_directory_native(child, error_number);
+        result = argon_remove_directory_native(child, threads, error_number);
 
       } else {
 
@@ -1661,70 +1717,141 @@ static bool argon_remove_directory_native(const char *path, int *error_number) {
 
 #else
 
-  DIR *directory = opendir(path);
-
-  if (!directory) {
+  int error = argon_remove_tree(path, threads);
 
+  if (error != 0) {
     if (error_number)
-      *error_number = errno;
+      *error_number = error;
 
     return false;
   }
 
-  struct dirent *entry;
-
-  while ((entry = readdir(directory)) != NULL) {
-
-    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
-      continue;
-
-    char *child = argon_path_join(path, entry->d_name);
-
-    if (!child) {
-
-      if (error_number)
-        *error_number = ENOMEM;
-
-      closedir(directory);
-      return false;
-    }
-
-    bool result;
-
-    if (argon_is_directory(child)) {
-
-      result = argon_remove_directory_native(child, error_number);
+  return true;
 
-    } else {
+#endif
+}
 
-      result = unlink(child) == 0;
+#if defined(_WIN32) || defined(_WIN64)
+static void argon_unmap(void *data, size_t size) {
+  (void)size;
+  UnmapViewOfFile(data);
+}
+#else
+static void argon_unmap(void *data, size_t size) { munmap(data, size); }
+#endif
 
-      if (!result && error_number)
-        *error_number = errno;
-    }
+// mmap(path, writable, advice, FileNotFoundError, FilePermissionError,
+// FileError) -> buffer over the mapped file. a read only mapping is private,
+// so a write through a typed array view changes the copy, not the file.
+ARGON_FUNCTION(mmap, {
+  if (api->fix_to_arg_size(6, argc, err))
+    return api->ARGON_NULL;
 
-    free(child);
+  bool writable = argv[1] == api->ARGON_TRUE;
+  struct string advice = api->argon_to_string(argv[2], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  char *path = argon_path_to_c_string(api, argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  if (!path)
+    return api->throw_argon_error(err, api->RuntimeError, "out of memory");
 
-    if (!result) {
-      closedir(directory);
-      return false;
-    }
+#if defined(_WIN32) || defined(_WIN64)
+  HANDLE file = CreateFileA(path, GENERIC_READ | (writable ? GENERIC_WRITE : 0),
+                            FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    DWORD error = GetLastError();
+    ArgonObject *type = error == ERROR_FILE_NOT_FOUND ||
+                                error == ERROR_PATH_NOT_FOUND
+                            ? argv[3]
+                        : error == ERROR_ACCESS_DENIED ? argv[4]
+                                                       : argv[5];
+    api->throw_argon_error(err, type, "%s", path);
+    free(path);
+    return api->ARGON_NULL;
   }
-
-  closedir(directory);
-
-  if (rmdir(path) != 0) {
-
-    if (error_number)
-      *error_number = errno;
-
-    return false;
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size)) {
+    CloseHandle(file);
+    api->throw_argon_error(err, argv[5], "%s", path);
+    free(path);
+    return api->ARGON_NULL;
   }
-
-  return true;
-
+  size_t size = (size_t)file_size.QuadPart;
+  if (size == 0) {
+    CloseHandle(file);
+    free(path);
+    return api->create_argon_buffer(0);
+  }
+  HANDLE mapping = CreateFileMappingA(
+      file, NULL, writable ? PAGE_READWRITE : PAGE_WRITECOPY, 0, 0, NULL);
+  CloseHandle(file);
+  void *data = mapping ? MapViewOfFile(mapping,
+                                       writable ? FILE_MAP_WRITE
+                                                : FILE_MAP_COPY,
+                                       0, 0, 0)
+                       : NULL;
+  if (mapping)
+    CloseHandle(mapping);
+  if (!data) {
+    api->throw_argon_error(err, argv[5], "unable to map %s", path);
+    free(path);
+    return api->ARGON_NULL;
+  }
+  // windows has no access pattern hints for a view, the advice is accepted
+  // and ignored
+  (void)advice;
+#else
+  int fd = open(path, writable ? O_RDWR : O_RDONLY);
+  if (fd < 0) {
+    int errnum = errno;
+    ArgonObject *type = errnum == ENOENT   ? argv[3]
+                        : errnum == EACCES ? argv[4]
+                                           : argv[5];
+    api->throw_argon_error(err, type, "%s", errnum == ENOENT || errnum == EACCES
+                                                ? path
+                                                : strerror(errnum));
+    free(path);
+    return api->ARGON_NULL;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    int errnum = errno;
+    close(fd);
+    free(path);
+    return api->throw_argon_error(err, argv[5], "%s", strerror(errnum));
+  }
+  size_t size = (size_t)st.st_size;
+  if (size == 0) {
+    // an empty file cannot be mapped
+    close(fd);
+    free(path);
+    return api->create_argon_buffer(0);
+  }
+  void *data = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                    writable ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+  int errnum = errno;
+  close(fd);
+  if (data == MAP_FAILED) {
+    free(path);
+    return api->throw_argon_error(err, argv[5], "%s", strerror(errnum));
+  }
+
+  int hint = MADV_NORMAL;
+  if (advice.length == 10 && memcmp(advice.data, "sequential", 10) == 0)
+    hint = MADV_SEQUENTIAL;
+  else if (advice.length == 6 && memcmp(advice.data, "random", 6) == 0)
+    hint = MADV_RANDOM;
+  else if (advice.length == 8 && memcmp(advice.data, "willneed", 8) == 0)
+    hint = MADV_WILLNEED;
+  if (hint != MADV_NORMAL)
+    madvise(data, size, hint);
 #endif
-}
+  free(path);
+  return api->create_argon_buffer_external(data, size, argon_unmap);
+})
 
 ARGON_FUNCTION(copy_file, {
   if (api->fix_to_arg_size(3, argc, err))
@@ -1772,8 +1899,26 @@ ARGON_FUNCTION(copy_file, {
   return api->ARGON_NULL;
 })
 
+// 0 asks for one thread per core.
+static size_t argon_tree_threads(int64_t requested) {
+  if (requested > 0)
+    return (size_t)requested;
+
+#if defined(_WIN32) || defined(_WIN64)
+  return 1;
+#else
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (size_t)count : 1;
+#endif
+}
+
 ARGON_FUNCTION(copy_dir, {
-  if (api->fix_to_arg_size(3, argc, err))
+  if (api->fix_to_arg_size(4, argc, err))
+    return api->ARGON_NULL;
+
+  int64_t requested = api->argon_to_i64(argv[2], err);
+
+  if (api->is_error(err))
     return api->ARGON_NULL;
 
   char *src = argon_path_to_c_string(api, argv[0], err);
@@ -1791,7 +1936,7 @@ ARGON_FUNCTION(copy_dir, {
   if (!argon_is_directory(src)) {
 
     ArgonObject *result = api->throw_argon_error(
-        err, argv[2], "source is not a directory: %s", src);
+        err, argv[3], "source is not a directory: %s", src);
 
     free(src);
     free(dst);
@@ -1801,10 +1946,11 @@ ARGON_FUNCTION(copy_dir, {
 
   int error_number = 0;
 
-  if (!argon_copy_directory_native(src, dst, &error_number)) {
+  if (!argon_copy_directory_native(src, dst, argon_tree_threads(requested),
+                                   &error_number)) {
 
     ArgonObject *result = api->throw_argon_error(
-        err, argv[2], "failed to copy directory: %s", strerror(error_number));
+        err, argv[3], "failed to copy directory: %s", strerror(error_number));
 
     free(src);
     free(dst);
@@ -1906,10 +2052,10 @@ ARGON_FUNCTION(move, {
 
   if (argon_is_directory(src)) {
 
-    success = argon_copy_directory_native(src, dst, &error_number);
+    success = argon_copy_directory_native(src, dst, 1, &error_number);
 
     if (success)
-      success = argon_remove_directory_native(src, &error_number);
+      success = argon_remove_directory_native(src, 1, &error_number);
 
   } else if (argon_is_file(src)) {
 
@@ -1989,6 +2135,74 @@ static bool argon_tree_add_path(ArgonNativeAPI *api, ArgonObject ***items,
   return true;
 }
 
+#if !defined(_WIN32) && !defined(_WIN64)
+// lists an open directory and everything under it, opening each subdirectory
+// relative to its parent's fd.
+static bool argon_tree_entries_native(ArgonNativeAPI *api, DIR *directory,
+                                      const char *root, ArgonObject ***items,
+                                      size_t *size, size_t *capacity,
+                                      ArgonError *err) {
+
+  int fd = dirfd(directory);
+
+  struct dirent *entry;
+
+  while ((entry = readdir(directory)) != NULL) {
+
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+      continue;
+
+    char *path = argon_path_join(root, entry->d_name);
+
+    if (!path) {
+
+      api->throw_argon_error(err, api->RuntimeError, "out of memory");
+
+      return false;
+    }
+
+    if (!argon_tree_add_path(api, items, size, capacity, path, err)) {
+
+      free(path);
+
+      return false;
+    }
+
+    if (argon_tree_entry_kind(fd, entry, true) == TREE_DIRECTORY) {
+
+      DIR *child = argon_open_directory_at(fd, entry->d_name, true);
+
+      if (!child) {
+
+        api->throw_argon_error(err, api->PathError,
+                               "failed to read directory '%s': %s", path,
+                               strerror(errno));
+
+        free(path);
+
+        return false;
+      }
+
+      bool success = argon_tree_entries_native(api, child, path, items, size,
+                                               capacity, err);
+
+      closedir(child);
+
+      if (!success) {
+
+        free(path);
+
+        return false;
+      }
+    }
+
+    free(path);
+  }
+
+  return true;
+}
+#endif
+
 static bool argon_tree_directory_native(ArgonNativeAPI *api, const char *root,
                                         ArgonObject ***items, size_t *size,
                                         size_t *capacity, ArgonError *err) {
@@ -2067,7 +2281,7 @@ static bool argon_tree_directory_native(ArgonNativeAPI *api, const char *root,
 
 #else
 
-  DIR *directory = opendir(root);
+  DIR *directory = argon_open_directory_at(AT_FDCWD, root, true);
 
   if (!directory) {
 
@@ -2078,49 +2292,12 @@ static bool argon_tree_directory_native(ArgonNativeAPI *api, const char *root,
     return false;
   }
 
-  struct dirent *entry;
-
-  while ((entry = readdir(directory)) != NULL) {
-
-    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
-      continue;
-
-    char *path = argon_path_join(root, entry->d_name);
-
-    if (!path) {
-
-      closedir(directory);
-
-      api->throw_argon_error(err, api->RuntimeError, "out of memory");
-
-      return false;
-    }
-
-    if (!argon_tree_add_path(api, items, size, capacity, path, err)) {
-
-      free(path);
-      closedir(directory);
-
-      return false;
-    }
-
-    if (argon_is_directory(path)) {
-
-      if (!argon_tree_directory_native(api, path, items, size, capacity, err)) {
-
-        free(path);
-        closedir(directory);
-
-        return false;
-      }
-    }
-
-    free(path);
-  }
+  bool success = argon_tree_entries_native(api, directory, root, items, size,
+                                           capacity, err);
 
   closedir(directory);
 
-  return true;
+  return success;
 
 #endif
 }
@@ -2219,7 +2396,12 @@ ARGON_FUNCTION(delete_file, {
 })
 
 ARGON_FUNCTION(delete_dir, {
-  if (api->fix_to_arg_size(2, argc, err))
+  if (api->fix_to_arg_size(3, argc, err))
+    return api->ARGON_NULL;
+
+  int64_t requested = api->argon_to_i64(argv[1], err);
+
+  if (api->is_error(err))
     return api->ARGON_NULL;
 
   char *path = argon_path_to_c_string(api, argv[0], err);
@@ -2229,7 +2411,7 @@ ARGON_FUNCTION(delete_dir, {
 
   if (!argon_is_directory(path)) {
     ArgonObject *result =
-        api->throw_argon_error(err, argv[1], "not a directory: %s", path);
+        api->throw_argon_error(err, argv[2], "not a directory: %s", path);
 
     free(path);
     return result;
@@ -2237,10 +2419,11 @@ ARGON_FUNCTION(delete_dir, {
 
   int error_number = 0;
 
-  if (!argon_remove_directory_native(path, &error_number)) {
+  if (!argon_remove_directory_native(path, argon_tree_threads(requested),
+                                     &error_number)) {
 
     ArgonObject *result = api->throw_argon_error(
-        err, argv[1], "failed to delete directory '%s': %s", path,
+        err, argv[2], "failed to delete directory '%s': %s", path,
         strerror(error_number));
 
     free(path);
@@ -2329,10 +2512,11 @@ static bool argon_move_contents_native(const char *src, const char *dst,
 
       if (!result && GetLastError() == ERROR_NOT_SAME_DEVICE) {
 
-        result = argon_copy_directory_native(src_path, dst_path, error_number);
+        result =
+            argon_copy_directory_native(src_path, dst_path, 1, error_number);
 
         if (result)
-          result = argon_remove_directory_native(src_path, error_number);
+          result = argon_remove_directory_native(src_path, 1, error_number);
       } else if (!result) {
         if (error_number)
           *error_number = (int)GetLastError();
@@ -2419,9 +2603,10 @@ static bool argon_move_contents_native(const char *src, const char *dst,
 
         if (argon_is_directory(src_path)) {
 
-          if (argon_copy_directory_native(src_path, dst_path, error_number)) {
+          if (argon_copy_directory_native(src_path, dst_path, 1,
+                                          error_number)) {
 
-            if (!argon_remove_directory_native(src_path, error_number)) {
+            if (!argon_remove_directory_native(src_path, 1, error_number)) {
 
               success = false;
             }
@@ -2509,12 +2694,15 @@ INIT_ARGON_MODULE({
   REGISTER_ARGON_FUNCTION(open_handle);
   REGISTER_ARGON_FUNCTION(read_all);
   REGISTER_ARGON_FUNCTION(read);
+  REGISTER_ARGON_FUNCTION(readline);
+  REGISTER_ARGON_FUNCTION(readinto);
   REGISTER_ARGON_FUNCTION(write);
   REGISTER_ARGON_FUNCTION(close);
   REGISTER_ARGON_FUNCTION(seek);
   REGISTER_ARGON_FUNCTION(tell);
   REGISTER_ARGON_FUNCTION(flush);
   REGISTER_ARGON_FUNCTION(file_size);
+  REGISTER_ARGON_FUNCTION(fileno);
   REGISTER_ARGON_FUNCTION(path_type);
   REGISTER_ARGON_FUNCTION(open_stdout);
   REGISTER_ARGON_FUNCTION(open_stdin);
@@ -2525,6 +2713,7 @@ INIT_ARGON_MODULE({
   REGISTER_ARGON_FUNCTION(temp_file);
   REGISTER_ARGON_FUNCTION(temp_dir);
   REGISTER_ARGON_FUNCTION(move);
+  REGISTER_ARGON_FUNCTION(mmap);
   REGISTER_ARGON_FUNCTION(copy_file);
   REGISTER_ARGON_FUNCTION(copy_dir);
   REGISTER_ARGON_FUNCTION(tree_dir);
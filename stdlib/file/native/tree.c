@@ -0,0 +1,610 @@
+// SPDX-FileCopyrightText: 2026 William Bell
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#if !defined(_WIN32) && !defined(_WIN64)
+
+#define _GNU_SOURCE
+#include "./tree.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#endif
+
+#define COPY_CHUNK ((size_t)1 << 30)
+
+static int copy_fd_loop(int in_fd, int out_fd) {
+  char buffer[64 * 1024];
+
+  while (true) {
+    ssize_t bytes_read = read(in_fd, buffer, sizeof(buffer));
+
+    if (bytes_read == 0)
+      return 0;
+
+    if (bytes_read < 0) {
+      if (errno == EINTR)
+        continue;
+      return errno;
+    }
+
+    ssize_t offset = 0;
+
+    while (offset < bytes_read) {
+      ssize_t bytes_written =
+          write(out_fd, buffer + offset, (size_t)(bytes_read - offset));
+
+      if (bytes_written < 0 && errno == EINTR)
+        continue;
+
+      if (bytes_written <= 0)
+        return bytes_written < 0 ? errno : EIO;
+
+      offset += bytes_written;
+    }
+  }
+}
+
+int argon_copy_fd(int in_fd, int out_fd) {
+#if defined(__linux__)
+#ifdef FICLONE
+  // a reflink either shares every extent at once or fails without writing
+  // anything, so it goes first.
+  if (ioctl(out_fd, FICLONE, in_fd) == 0)
+    return 0;
+#endif
+
+  bool use_range = true;
+  bool use_sendfile = true;
+  bool copied = false;
+
+  while (use_range || use_sendfile) {
+    ssize_t count;
+
+    if (use_range) {
+      count = copy_file_range(in_fd, NULL, out_fd, NULL, COPY_CHUNK, 0);
+
+      // older kernels refuse cross filesystem copies and some filesystems
+      // don't implement it at all. nothing has been written yet when that
+      // happens on the first call.
+      if (count < 0 && !copied &&
+          (errno == EXDEV || errno == ENOSYS || errno == EOPNOTSUPP ||
+           errno == EINVAL)) {
+        use_range = false;
+        continue;
+      }
+    } else {
+      count = sendfile(out_fd, in_fd, NULL, COPY_CHUNK);
+
+      if (count < 0 && !copied && (errno == EINVAL || errno == ENOSYS)) {
+        use_sendfile = false;
+        continue;
+      }
+    }
+
+    if (count == 0)
+      return 0;
+
+    if (count < 0) {
+      if (errno == EINTR)
+        continue;
+      return errno;
+    }
+
+    copied = true;
+  }
+#endif
+
+  return copy_fd_loop(in_fd, out_fd);
+}
+
+int argon_copy_file_at(int src_dir, const char *src_name, int dst_dir,
+                       const char *dst_name) {
+  int in_fd = openat(src_dir, src_name, O_RDONLY | O_CLOEXEC);
+
+  if (in_fd < 0)
+    return errno;
+
+  struct stat st;
+
+  if (fstat(in_fd, &st) != 0) {
+    int error = errno;
+    close(in_fd);
+    return error;
+  }
+
+  int out_fd = openat(dst_dir, dst_name, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                      st.st_mode & 0777);
+
+  if (out_fd < 0) {
+    int error = errno;
+    close(in_fd);
+    return error;
+  }
+
+  int error = argon_copy_fd(in_fd, out_fd);
+
+  close(in_fd);
+
+  if (close(out_fd) != 0 && error == 0)
+    error = errno;
+
+  if (error != 0)
+    unlinkat(dst_dir, dst_name, 0);
+
+  return error;
+}
+
+TreeEntryKind argon_tree_entry_kind(int dir_fd, const struct dirent *entry,
+                                    bool follow) {
+#ifdef DT_UNKNOWN
+  switch (entry->d_type) {
+  case DT_REG:
+    return TREE_FILE;
+  case DT_DIR:
+    return TREE_DIRECTORY;
+  case DT_LNK:
+    if (!follow)
+      return TREE_OTHER;
+    break;
+  case DT_UNKNOWN:
+    break;
+  default:
+    return TREE_OTHER;
+  }
+#endif
+
+  struct stat st;
+
+  if (fstatat(dir_fd, entry->d_name, &st, follow ? 0 : AT_SYMLINK_NOFOLLOW) !=
+      0)
+    return TREE_OTHER;
+
+  if (S_ISDIR(st.st_mode))
+    return TREE_DIRECTORY;
+
+  if (S_ISREG(st.st_mode))
+    return TREE_FILE;
+
+  return TREE_OTHER;
+}
+
+DIR *argon_open_directory_at(int parent, const char *name, bool follow) {
+  int fd = openat(parent, name,
+                  O_RDONLY | O_DIRECTORY | O_CLOEXEC | (follow ? 0 : O_NOFOLLOW));
+
+  if (fd < 0)
+    return NULL;
+
+  DIR *directory = fdopendir(fd);
+
+  if (!directory) {
+    int error = errno;
+    close(fd);
+    errno = error;
+  }
+
+  return directory;
+}
+
+static bool is_dot_entry(const char *name) {
+  return name[0] == '.' &&
+         (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+static char *join_path(const char *parent, const char *child) {
+  size_t parent_length = strlen(parent);
+  size_t child_length = strlen(child);
+  bool separator = parent_length > 0 && parent[parent_length - 1] != '/';
+
+  char *path = malloc(parent_length + separator + child_length + 1);
+
+  if (!path)
+    return NULL;
+
+  memcpy(path, parent, parent_length);
+
+  if (separator)
+    path[parent_length] = '/';
+
+  memcpy(path + parent_length + separator, child, child_length + 1);
+
+  return path;
+}
+
+static int make_directory_at(int parent, const char *name) {
+  if (mkdirat(parent, name, 0755) == 0)
+    return 0;
+
+  if (errno != EEXIST)
+    return errno;
+
+  struct stat st;
+
+  if (fstatat(parent, name, &st, 0) == 0 && S_ISDIR(st.st_mode))
+    return 0;
+
+  return EEXIST;
+}
+
+/* parallel walks share one stack of directories between the workers. a
+ * directory is pending from the moment it is pushed until the worker that
+ * popped it has finished reading it, so the walk is over once nothing is
+ * pending. */
+
+typedef struct tree_task {
+  struct tree_task *next;
+  char *src;
+  char *dst;
+} tree_task;
+
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  tree_task *head;
+  size_t pending;
+  int error;
+  bool removing;
+
+  // removal keeps every directory it found so they can be removed children
+  // first once all the files are gone.
+  char **directories;
+  size_t directory_count;
+  size_t directory_capacity;
+} tree_queue;
+
+// queues one directory, taking ownership of both paths. dst is NULL when
+// removing.
+static int tree_push_paths(tree_queue *queue, char *src, char *dst) {
+  tree_task *task = calloc(1, sizeof(tree_task));
+  char *recorded = queue->removing && src ? strdup(src) : NULL;
+
+  if (!task || !src || (!queue->removing && !dst) ||
+      (queue->removing && !recorded)) {
+    free(task);
+    free(src);
+    free(dst);
+    free(recorded);
+    return ENOMEM;
+  }
+
+  task->src = src;
+  task->dst = dst;
+
+  pthread_mutex_lock(&queue->lock);
+
+  if (queue->removing) {
+    if (queue->directory_count == queue->directory_capacity) {
+      size_t capacity =
+          queue->directory_capacity ? queue->directory_capacity * 2 : 64;
+      char **directories =
+          realloc(queue->directories, capacity * sizeof(char *));
+
+      if (!directories) {
+        pthread_mutex_unlock(&queue->lock);
+        free(task->src);
+        free(task);
+        free(recorded);
+        return ENOMEM;
+      }
+
+      queue->directories = directories;
+      queue->directory_capacity = capacity;
+    }
+
+    queue->directories[queue->directory_count++] = recorded;
+  }
+
+  task->next = queue->head;
+  queue->head = task;
+  queue->pending++;
+
+  pthread_cond_signal(&queue->wake);
+  pthread_mutex_unlock(&queue->lock);
+
+  return 0;
+}
+
+static int tree_push(tree_queue *queue, const char *src_parent,
+                     const char *dst_parent, const char *name) {
+  return tree_push_paths(queue, join_path(src_parent, name),
+                         dst_parent ? join_path(dst_parent, name) : NULL);
+}
+
+static bool tree_failed(tree_queue *queue) {
+  pthread_mutex_lock(&queue->lock);
+  bool failed = queue->error != 0;
+  pthread_mutex_unlock(&queue->lock);
+  return failed;
+}
+
+static int copy_subdirectory(int src_parent, const char *src_name,
+                             int dst_parent, const char *dst_name);
+
+// copies the entries of an open source directory into dst_fd. subdirectories
+// go to the queue when there is one and are copied depth first here when not.
+static int copy_entries(DIR *directory, int dst_fd, const char *src_path,
+                        const char *dst_path, tree_queue *queue) {
+  int src_fd = dirfd(directory);
+  int error = 0;
+  struct dirent *entry;
+
+  errno = 0;
+
+  while (error == 0 && (entry = readdir(directory)) != NULL) {
+    if (is_dot_entry(entry->d_name))
+      continue;
+
+    switch (argon_tree_entry_kind(src_fd, entry, true)) {
+    case TREE_FILE:
+      error = argon_copy_file_at(src_fd, entry->d_name, dst_fd, entry->d_name);
+      break;
+    case TREE_DIRECTORY:
+      if (queue)
+        error = tree_push(queue, src_path, dst_path, entry->d_name);
+      else
+        error = copy_subdirectory(src_fd, entry->d_name, dst_fd, entry->d_name);
+      break;
+    case TREE_OTHER:
+      break;
+    }
+
+    if (queue && error == 0 && tree_failed(queue))
+      break;
+
+    errno = 0;
+  }
+
+  if (error == 0 && errno != 0)
+    error = errno;
+
+  return error;
+}
+
+static int copy_directory_pair(int src_parent, const char *src_name,
+                               int dst_parent, const char *dst_name,
+                               tree_queue *queue) {
+  int error = make_directory_at(dst_parent, dst_name);
+
+  if (error != 0)
+    return error;
+
+  DIR *source = argon_open_directory_at(src_parent, src_name, true);
+
+  if (!source)
+    return errno;
+
+  int dst_fd =
+      openat(dst_parent, dst_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+  if (dst_fd < 0) {
+    error = errno;
+    closedir(source);
+    return error;
+  }
+
+  error = copy_entries(source, dst_fd, src_name, dst_name, queue);
+
+  close(dst_fd);
+  closedir(source);
+
+  return error;
+}
+
+static int copy_subdirectory(int src_parent, const char *src_name,
+                             int dst_parent, const char *dst_name) {
+  return copy_directory_pair(src_parent, src_name, dst_parent, dst_name, NULL);
+}
+
+// unlinks everything in an open directory. subdirectories go to the queue when
+// there is one and are emptied and removed depth first here when not.
+static int clear_entries(DIR *directory, const char *path,
+                         tree_queue *queue) {
+  int fd = dirfd(directory);
+  int error = 0;
+  struct dirent *entry;
+
+  errno = 0;
+
+  while (error == 0 && (entry = readdir(directory)) != NULL) {
+    if (is_dot_entry(entry->d_name))
+      continue;
+
+    if (argon_tree_entry_kind(fd, entry, false) == TREE_DIRECTORY) {
+      if (queue) {
+        error = tree_push(queue, path, NULL, entry->d_name);
+      } else {
+        DIR *child = argon_open_directory_at(fd, entry->d_name, false);
+
+        if (!child) {
+          error = errno;
+        } else {
+          error = clear_entries(child, NULL, NULL);
+          closedir(child);
+
+          if (error == 0 && unlinkat(fd, entry->d_name, AT_REMOVEDIR) != 0)
+            error = errno;
+        }
+      }
+    } else if (unlinkat(fd, entry->d_name, 0) != 0) {
+      error = errno;
+    }
+
+    if (queue && error == 0 && tree_failed(queue))
+      break;
+
+    errno = 0;
+  }
+
+  if (error == 0 && errno != 0)
+    error = errno;
+
+  return error;
+}
+
+static int run_task(tree_queue *queue, tree_task *task) {
+  if (!queue->removing)
+    return copy_directory_pair(AT_FDCWD, task->src, AT_FDCWD, task->dst,
+                               queue);
+
+  DIR *directory = argon_open_directory_at(AT_FDCWD, task->src, false);
+
+  if (!directory)
+    return errno;
+
+  int error = clear_entries(directory, task->src, queue);
+
+  closedir(directory);
+
+  return error;
+}
+
+static void *tree_worker(void *arg) {
+  tree_queue *queue = arg;
+
+  pthread_mutex_lock(&queue->lock);
+
+  while (true) {
+    while (!queue->head && queue->pending > 0)
+      pthread_cond_wait(&queue->wake, &queue->lock);
+
+    if (!queue->head)
+      break;
+
+    tree_task *task = queue->head;
+    queue->head = task->next;
+
+    bool skip = queue->error != 0;
+
+    pthread_mutex_unlock(&queue->lock);
+
+    int error = skip ? 0 : run_task(queue, task);
+
+    free(task->src);
+    free(task->dst);
+    free(task);
+
+    pthread_mutex_lock(&queue->lock);
+
+    if (error != 0 && queue->error == 0)
+      queue->error = error;
+
+    if (--queue->pending == 0)
+      pthread_cond_broadcast(&queue->wake);
+  }
+
+  pthread_mutex_unlock(&queue->lock);
+
+  return NULL;
+}
+
+// runs the queue on the calling thread plus threads - 1 workers. if a worker
+// can't be started the ones that did, and the caller, still finish the walk.
+static int run_queue(tree_queue *queue, size_t threads) {
+  pthread_t *workers = calloc(threads - 1, sizeof(pthread_t));
+  size_t started = 0;
+
+  if (workers) {
+    while (started < threads - 1 &&
+           pthread_create(&workers[started], NULL, tree_worker, queue) == 0)
+      started++;
+  }
+
+  tree_worker(queue);
+
+  for (size_t i = 0; i < started; i++)
+    pthread_join(workers[i], NULL);
+
+  free(workers);
+
+  return queue->error;
+}
+
+static void init_queue(tree_queue *queue, bool removing) {
+  memset(queue, 0, sizeof(*queue));
+  pthread_mutex_init(&queue->lock, NULL);
+  pthread_cond_init(&queue->wake, NULL);
+  queue->removing = removing;
+}
+
+static void free_queue(tree_queue *queue) {
+  while (queue->head) {
+    tree_task *task = queue->head;
+    queue->head = task->next;
+    free(task->src);
+    free(task->dst);
+    free(task);
+  }
+
+  for (size_t i = 0; i < queue->directory_count; i++)
+    free(queue->directories[i]);
+
+  free(queue->directories);
+  pthread_cond_destroy(&queue->wake);
+  pthread_mutex_destroy(&queue->lock);
+}
+
+int argon_copy_tree(const char *src, const char *dst, size_t threads) {
+  if (threads <= 1)
+    return copy_subdirectory(AT_FDCWD, src, AT_FDCWD, dst);
+
+  tree_queue queue;
+  init_queue(&queue, false);
+
+  int error = tree_push_paths(&queue, strdup(src), strdup(dst));
+
+  if (error == 0)
+    error = run_queue(&queue, threads);
+
+  free_queue(&queue);
+
+  return error;
+}
+
+int argon_remove_tree(const char *path, size_t threads) {
+  if (threads <= 1) {
+    DIR *directory = argon_open_directory_at(AT_FDCWD, path, false);
+
+    if (!directory)
+      return errno;
+
+    int error = clear_entries(directory, NULL, NULL);
+
+    closedir(directory);
+
+    if (error == 0 && rmdir(path) != 0)
+      error = errno;
+
+    return error;
+  }
+
+  tree_queue queue;
+  init_queue(&queue, true);
+
+  int error = tree_push_paths(&queue, strdup(path), NULL);
+
+  if (error == 0)
+    error = run_queue(&queue, threads);
+
+  // every file is gone once the walk succeeds, and each directory was found
+  // after its parent, so removing in reverse leaves parents until last.
+  for (size_t i = queue.directory_count; error == 0 && i > 0; i--) {
+    if (rmdir(queue.directories[i - 1]) != 0)
+      error = errno;
+  }
+
+  free_queue(&queue);
+
+  return error;
+}
+
+#endif
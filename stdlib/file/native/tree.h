@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: 2026 William Bell
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef FILE_TREE_H
+#define FILE_TREE_H
+
+#if !defined(_WIN32) && !defined(_WIN64)
+
+#include <dirent.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef enum { TREE_OTHER, TREE_FILE, TREE_DIRECTORY } TreeEntryKind;
+
+// copies everything left to read from in_fd into out_fd, trying a reflink,
+// then copy_file_range, then sendfile before falling back to read/write.
+// returns 0 or an errno value.
+int argon_copy_fd(int in_fd, int out_fd);
+
+// copies one regular file relative to two directory fds (AT_FDCWD for plain
+// paths). the destination must not exist and is removed again on failure.
+int argon_copy_file_at(int src_dir, const char *src_name, int dst_dir,
+                       const char *dst_name);
+
+// the kind of a directory entry, from d_type when the filesystem fills it in
+// and from one fstatat otherwise. symlinks are only resolved when follow is
+// true.
+TreeEntryKind argon_tree_entry_kind(int dir_fd, const struct dirent *entry,
+                                    bool follow);
+
+// opens name relative to parent as a directory stream.
+DIR *argon_open_directory_at(int parent, const char *name, bool follow);
+
+// copies the tree at src into dst, creating dst if needed. with more than one
+// thread, subdirectories are shared out between that many workers.
+int argon_copy_tree(const char *src, const char *dst, size_t threads);
+
+// deletes the tree at path without following symlinks inside it.
+int argon_remove_tree(const char *path, size_t threads);
+
+#endif
+
+#endif // FILE_TREE_H
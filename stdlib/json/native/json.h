@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2026 William Bell
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef JSON_NATIVE_H
+#define JSON_NATIVE_H
+
+#include "Argon.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define JSON_BLOCK 64
+
+// what the scanner carries from one 64 byte block into the next.
+typedef struct {
+  uint64_t in_string; // all ones while a string is open
+  uint64_t escaped;   // 1 when the next block starts with an escaped byte
+  uint64_t scalar;    // 1 when the last block ended inside a bare value
+} ScanState;
+
+// returns a bit for every structural byte in the block: brackets, ':' and ','
+// outside strings, opening quotes, and the first byte of each bare value.
+uint64_t json_scan_block(const uint8_t *block, ScanState *state);
+
+// offsets of every structural byte in data, followed by a sentinel equal to
+// length. returns NULL if data is too large to index.
+uint32_t *json_structural_index(const char *data, size_t length,
+                                size_t *count);
+
+// finds the first '"' or '\\' at or after data, or end if there is none.
+const char *json_find_quote_or_escape(const char *data, const char *end);
+
+// length of the run of bytes at data that can be copied into a JSON string
+// without escaping.
+size_t json_plain_prefix(const char *data, size_t length);
+
+// decodes the escapes in the body of a string literal.
+ArgonObject *json_unescape(const char *data, size_t length,
+                           ArgonObject *value_error, ArgonError *err,
+                           ArgonNativeAPI *api);
+
+ArgonObject *json_parse(const char *data, size_t length,
+                        ArgonObject *value_error, ArgonError *err,
+                        ArgonState *state, ArgonNativeAPI *api);
+
+typedef struct {
+  ArgonObject **items;
+  size_t length;
+  size_t capacity;
+} JsonParents;
+
+typedef struct {
+  bool pretty;
+  struct string indent;
+  JsonParents parents;
+  ArgonObject *fallback; // called for values with no native encoding
+  ArgonObject *value_error;
+  ArgonError *err;
+  ArgonState *state;
+  ArgonNativeAPI *api;
+} JsonWriterOptions;
+
+// returns a malloc'd buffer holding the encoded value, or NULL on error.
+char *json_stringify(ArgonObject *value, JsonWriterOptions *options,
+                     size_t *length);
+
+#endif // JSON_NATIVE_H
@@ -0,0 +1,325 @@
+// SPDX-FileCopyrightText: 2026 William Bell
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "./json.h"
+#include "Argon.h"
+#include "ArgonFunction.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define NO_DOCUMENT ((size_t)-1)
+
+/*
+ * a stream holds the bytes that have not made a complete document yet. the
+ * structural scanner runs over them once as they arrive, tracking nesting so
+ * each top-level value is parsed as soon as its last byte is in. the state
+ * and the bytes live in two argon buffers owned by the json.Parser object.
+ */
+typedef struct {
+  ScanState scan;
+  size_t length;   // bytes held in the data buffer
+  size_t position; // next byte to scan
+  size_t start;    // first byte of the pending document
+  size_t depth;
+  bool bare; // the pending document is a top-level string or scalar
+} JsonStream;
+
+typedef struct {
+  ArgonObject **items;
+  size_t length;
+  size_t capacity;
+} ValueList;
+
+static bool list_push(ValueList *list, ArgonObject *value,
+                      ArgonNativeAPI *api) {
+  if (list->length == list->capacity) {
+    size_t capacity = list->capacity ? list->capacity * 2 : 8;
+    ArgonObject **items = api->malloc(capacity * sizeof(ArgonObject *));
+    if (!items)
+      return false;
+    if (list->items) {
+      memcpy(items, list->items, list->length * sizeof(ArgonObject *));
+      api->free(list->items);
+    }
+    list->items = items;
+    list->capacity = capacity;
+  }
+  list->items[list->length++] = value;
+  return true;
+}
+
+static ArgonObject *list_to_array(ValueList *list, ArgonNativeAPI *api) {
+  ArgonObject *array = api->create_argon_array(list->items, list->length);
+  if (list->items)
+    api->free(list->items);
+  return array;
+}
+
+// accepts either a string or a buffer, like the file handles return.
+static struct string bytes_of(ArgonObject *object, ArgonError *err,
+                              ArgonNativeAPI *api) {
+  if (api->argon_get_ArgonType(object) == TYPE_BUFFER) {
+    struct buffer buffer = api->argon_buffer_to_buffer(object, err);
+    return (struct string){buffer.data, buffer.size};
+  }
+  return api->argon_to_string(object, err);
+}
+
+static JsonStream *get_stream(ArgonObject *object, ArgonError *err,
+                              ArgonNativeAPI *api) {
+  struct buffer buffer = api->argon_buffer_to_buffer(object, err);
+  if (api->is_error(err))
+    return NULL;
+  if (buffer.size != sizeof(JsonStream)) {
+    api->throw_argon_error(err, api->TypeError, "expected a json stream");
+    return NULL;
+  }
+  return buffer.data;
+}
+
+static void reset_stream(JsonStream *stream, size_t position) {
+  stream->scan = (ScanState){0, 0, 0};
+  stream->position = position;
+  stream->start = NO_DOCUMENT;
+  stream->depth = 0;
+  stream->bare = false;
+}
+
+// scans the next block, returning the end of a document if one finishes in
+// it or NO_DOCUMENT. a short final block is scanned speculatively and only
+// kept if it finishes a document.
+static size_t scan_next_block(JsonStream *stream, const char *data) {
+  JsonStream s = *stream;
+  size_t available = s.length - s.position;
+  const uint8_t *block = (const uint8_t *)data + s.position;
+  uint8_t tail[JSON_BLOCK];
+  bool speculative = available < JSON_BLOCK;
+  if (speculative) {
+    memset(tail, ' ', JSON_BLOCK);
+    memcpy(tail, block, available);
+    block = tail;
+  }
+  uint64_t bits = json_scan_block(block, &s.scan);
+  while (bits) {
+    size_t at = s.position + __builtin_ctzll(bits);
+    bits &= bits - 1;
+    char c = data[at];
+    if (s.start == NO_DOCUMENT) {
+      s.start = at;
+      if (c == '{' || c == '[') {
+        s.depth = 1;
+      } else if (c == '}' || c == ']' || c == ',' || c == ':') {
+        // a stray byte is a document of its own, the parser reports it
+        *stream = s;
+        return at + 1;
+      } else {
+        s.bare = true;
+      }
+      continue;
+    }
+    if (s.bare) {
+      *stream = s;
+      return at;
+    }
+    if (c == '{' || c == '[') {
+      s.depth++;
+    } else if ((c == '}' || c == ']') && --s.depth == 0) {
+      *stream = s;
+      return at + 1;
+    }
+  }
+  if (!speculative) {
+    s.position += JSON_BLOCK;
+    *stream = s;
+  }
+  return NO_DOCUMENT;
+}
+
+static bool parse_pending(JsonStream *stream, const char *data, size_t end,
+                          ValueList *values, ArgonObject *value_error,
+                          ArgonError *err, ArgonState *state,
+                          ArgonNativeAPI *api) {
+  ArgonObject *value = json_parse(data + stream->start, end - stream->start,
+                                  value_error, err, state, api);
+  if (api->is_error(err))
+    return false;
+  if (!list_push(values, value, api)) {
+    api->throw_argon_error(err, api->RuntimeError, "out of memory");
+    return false;
+  }
+  reset_stream(stream, end);
+  return true;
+}
+
+// moves the unfinished bytes to the front of the buffer.
+static void compact_stream(JsonStream *stream, char *data) {
+  size_t keep = stream->start != NO_DOCUMENT ? stream->start : stream->position;
+  if (keep == 0)
+    return;
+  memmove(data, data + keep, stream->length - keep);
+  stream->length -= keep;
+  stream->position -= keep;
+  if (stream->start != NO_DOCUMENT)
+    stream->start -= keep;
+}
+
+// parse(text, ValueError) -> value
+ARGON_FUNCTION(parse, {
+  if (api->fix_to_arg_size(2, argc, err))
+    return api->ARGON_NULL;
+  struct string text = bytes_of(argv[0], err, api);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  return json_parse(text.data, text.length, argv[1], err, state, api);
+})
+
+// parse_string(body, ValueError) -> string
+ARGON_FUNCTION(parse_string, {
+  if (api->fix_to_arg_size(2, argc, err))
+    return api->ARGON_NULL;
+  struct string body = api->argon_to_string(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  return json_unescape(body.data, body.length, argv[1], err, api);
+})
+
+// stringify(value, pretty, indent, parents, fallback, ValueError) -> string
+ARGON_FUNCTION(stringify, {
+  if (api->fix_to_arg_size(6, argc, err))
+    return api->ARGON_NULL;
+  struct string indent = api->argon_to_string(argv[2], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  struct array parents = api->argon_to_array(argv[3], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  JsonWriterOptions options = {
+      .pretty = argv[1] != api->ARGON_FALSE && argv[1] != api->ARGON_NULL,
+      .indent = indent,
+      .parents = {NULL, 0, 0},
+      .fallback = argv[4],
+      .value_error = argv[5],
+      .err = err,
+      .state = state,
+      .api = api,
+  };
+  if (parents.size) {
+    options.parents.items = malloc(parents.size * sizeof(ArgonObject *));
+    if (!options.parents.items)
+      return api->throw_argon_error(err, api->RuntimeError, "out of memory");
+    memcpy(options.parents.items, parents.items,
+           parents.size * sizeof(ArgonObject *));
+    options.parents.length = options.parents.capacity = parents.size;
+  }
+
+  size_t length;
+  char *output = json_stringify(argv[0], &options, &length);
+  free(options.parents.items);
+  if (!output)
+    return api->ARGON_NULL;
+  ArgonObject *result = api->string_to_argon((struct string){output, length});
+  free(output);
+  return result;
+})
+
+// stream_new() -> buffer<JsonStream>
+ARGON_FUNCTION(stream_new, {
+  if (api->fix_to_arg_size(0, argc, err))
+    return api->ARGON_NULL;
+  ArgonObject *stream_obj = api->create_argon_buffer(sizeof(JsonStream));
+  JsonStream *stream = get_stream(stream_obj, err, api);
+  if (!stream)
+    return api->ARGON_NULL;
+  stream->length = 0;
+  reset_stream(stream, 0);
+  return stream_obj;
+})
+
+// stream_feed(stream, data_buffer, chunk, ValueError) -> array of values
+ARGON_FUNCTION(stream_feed, {
+  if (api->fix_to_arg_size(4, argc, err))
+    return api->ARGON_NULL;
+  JsonStream *stream = get_stream(argv[0], err, api);
+  if (!stream)
+    return api->ARGON_NULL;
+  struct buffer data = api->argon_buffer_to_buffer(argv[1], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  struct string chunk = bytes_of(argv[2], err, api);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  if (stream->length + chunk.length > data.size) {
+    size_t capacity = data.size ? data.size : 4096;
+    while (capacity < stream->length + chunk.length)
+      capacity *= 2;
+    api->resize_argon_buffer(argv[1], err, capacity);
+    if (api->is_error(err))
+      return api->ARGON_NULL;
+    data = api->argon_buffer_to_buffer(argv[1], err);
+  }
+  memcpy((char *)data.data + stream->length, chunk.data, chunk.length);
+  stream->length += chunk.length;
+
+  ValueList values = {NULL, 0, 0};
+  while (stream->position < stream->length) {
+    bool tail = stream->length - stream->position < JSON_BLOCK;
+    size_t end = scan_next_block(stream, data.data);
+    if (end != NO_DOCUMENT) {
+      if (!parse_pending(stream, data.data, end, &values, argv[3], err, state,
+                         api)) {
+        reset_stream(stream, stream->length);
+        compact_stream(stream, data.data);
+        list_to_array(&values, api);
+        return api->ARGON_NULL;
+      }
+    } else if (tail) {
+      break;
+    }
+  }
+  compact_stream(stream, data.data);
+  return list_to_array(&values, api);
+})
+
+// stream_finish(stream, data_buffer, ValueError) -> array of values
+ARGON_FUNCTION(stream_finish, {
+  if (api->fix_to_arg_size(3, argc, err))
+    return api->ARGON_NULL;
+  JsonStream *stream = get_stream(argv[0], err, api);
+  if (!stream)
+    return api->ARGON_NULL;
+  struct buffer data = api->argon_buffer_to_buffer(argv[1], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  ValueList values = {NULL, 0, 0};
+  if (stream->start == NO_DOCUMENT) {
+    // only the speculative tail is left, skip its whitespace
+    const char *bytes = data.data;
+    size_t at = stream->position;
+    while (at < stream->length && (bytes[at] == ' ' || bytes[at] == '\t' ||
+                                   bytes[at] == '\n' || bytes[at] == '\r'))
+      at++;
+    if (at < stream->length)
+      stream->start = at;
+  }
+  bool ok = true;
+  if (stream->start != NO_DOCUMENT)
+    ok = parse_pending(stream, data.data, stream->length, &values, argv[2],
+                       err, state, api);
+  stream->length = 0;
+  reset_stream(stream, 0);
+  ArgonObject *result = list_to_array(&values, api);
+  return ok ? result : api->ARGON_NULL;
+})
+
+INIT_ARGON_MODULE({
+  REGISTER_ARGON_FUNCTION(parse);
+  REGISTER_ARGON_FUNCTION(parse_string);
+  REGISTER_ARGON_FUNCTION(stringify);
+  REGISTER_ARGON_FUNCTION(stream_new);
+  REGISTER_ARGON_FUNCTION(stream_feed);
+  REGISTER_ARGON_FUNCTION(stream_finish);
+})
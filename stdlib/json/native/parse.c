@@ -0,0 +1,540 @@
+// SPDX-FileCopyrightText: 2026 William Bell
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "json.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * stage two walks the structural index from stage one. containers are built
+ * with an explicit stack rather than recursion, so deeply nested input can't
+ * overflow the c stack. error messages and positions match the old argon
+ * implementation.
+ */
+
+#define NO_POSITION ((size_t)-1)
+
+typedef struct {
+  char kind; // '[' or '{'
+  size_t base;
+} Frame;
+
+typedef struct {
+  const char *data;
+  size_t length;
+  const uint32_t *index;
+  size_t next;
+  // set when a bare value runs straight into another byte, e.g. "12x"
+  size_t resume;
+
+  ArgonObject **values; // api->malloc'd so the collector can see them
+  size_t values_length;
+  size_t values_capacity;
+  Frame *frames;
+  size_t frames_length;
+  size_t frames_capacity;
+  char *scratch;
+  size_t scratch_capacity;
+
+  ArgonObject *value_error;
+  ArgonError *err;
+  ArgonState *state;
+  ArgonNativeAPI *api;
+} Parser;
+
+static bool fail(Parser *p, const char *fmt, ...) {
+  char message[256];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(message, sizeof(message), fmt, args);
+  va_end(args);
+  p->api->throw_argon_error(p->err, p->value_error, "%s", message);
+  return false;
+}
+
+static bool out_of_memory(Parser *p) {
+  p->api->throw_argon_error(p->err, p->api->RuntimeError, "out of memory");
+  return false;
+}
+
+static size_t next_position(Parser *p) {
+  if (p->resume != NO_POSITION) {
+    size_t position = p->resume;
+    p->resume = NO_POSITION;
+    return position;
+  }
+  size_t position = p->index[p->next];
+  if (position < p->length)
+    p->next++;
+  return position;
+}
+
+static bool push_value(Parser *p, ArgonObject *value) {
+  if (p->values_length == p->values_capacity) {
+    size_t capacity = p->values_capacity ? p->values_capacity * 2 : 64;
+    ArgonObject **values = p->api->malloc(capacity * sizeof(ArgonObject *));
+    if (!values)
+      return out_of_memory(p);
+    if (p->values) {
+      memcpy(values, p->values, p->values_length * sizeof(ArgonObject *));
+      p->api->free(p->values);
+    }
+    p->values = values;
+    p->values_capacity = capacity;
+  }
+  p->values[p->values_length++] = value;
+  return true;
+}
+
+static bool push_frame(Parser *p, char kind) {
+  if (p->frames_length == p->frames_capacity) {
+    size_t capacity = p->frames_capacity ? p->frames_capacity * 2 : 16;
+    Frame *frames = realloc(p->frames, capacity * sizeof(Frame));
+    if (!frames)
+      return out_of_memory(p);
+    p->frames = frames;
+    p->frames_capacity = capacity;
+  }
+  p->frames[p->frames_length++] = (Frame){kind, p->values_length};
+  return true;
+}
+
+static bool reserve_scratch(Parser *p, size_t length) {
+  if (length <= p->scratch_capacity)
+    return true;
+  size_t capacity = p->scratch_capacity ? p->scratch_capacity : 256;
+  while (capacity < length)
+    capacity *= 2;
+  char *scratch = realloc(p->scratch, capacity);
+  if (!scratch)
+    return out_of_memory(p);
+  p->scratch = scratch;
+  p->scratch_capacity = capacity;
+  return true;
+}
+
+static bool is_delimiter(Parser *p, size_t position) {
+  if (position >= p->length)
+    return true;
+  switch (p->data[position]) {
+  case ' ':
+  case '\t':
+  case '\n':
+  case '\r':
+  case ',':
+  case ':':
+  case '[':
+  case ']':
+  case '{':
+  case '}':
+    return true;
+  }
+  return false;
+}
+
+static int hex_value(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+// reads 4 hex digits at content[at], or returns -1.
+static int32_t read_hex4(const char *content, size_t length, size_t at) {
+  if (at + 4 > length)
+    return -1;
+  int32_t value = 0;
+  for (size_t i = 0; i < 4; i++) {
+    int digit = hex_value(content[at + i]);
+    if (digit < 0)
+      return -1;
+    value = value * 16 + digit;
+  }
+  return value;
+}
+
+static size_t encode_utf8(uint32_t cp, char *out) {
+  if (cp < 0x80) {
+    out[0] = (char)cp;
+    return 1;
+  } else if (cp < 0x800) {
+    out[0] = (char)(0xC0 | (cp >> 6));
+    out[1] = (char)(0x80 | (cp & 0x3F));
+    return 2;
+  } else if (cp < 0x10000) {
+    out[0] = (char)(0xE0 | (cp >> 12));
+    out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[2] = (char)(0x80 | (cp & 0x3F));
+    return 3;
+  }
+  out[0] = (char)(0xF0 | (cp >> 18));
+  out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+  out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+  out[3] = (char)(0x80 | (cp & 0x3F));
+  return 4;
+}
+
+// decodes the escapes in a string body. positions in errors are relative to
+// the body, as they were when parse_string was given the quoted slice.
+static ArgonObject *unescape(Parser *p, const char *content, size_t length) {
+  // escapes only ever shrink, \uXXXX is 6 bytes for at most 3 of output
+  if (!reserve_scratch(p, length))
+    return NULL;
+  char *out = p->scratch;
+  size_t j = 0;
+  size_t i = 0;
+  while (i < length) {
+    const char *stop = json_find_quote_or_escape(content + i, content + length);
+    size_t run = stop - (content + i);
+    memcpy(out + j, content + i, run);
+    j += run;
+    i += run;
+    if (i >= length)
+      break;
+    // parse_string can be handed a body with bare quotes in it
+    if (content[i] == '"') {
+      out[j++] = content[i++];
+      continue;
+    }
+    i++;
+    if (i >= length) {
+      fail(p, "Unexpected end of string after backslash");
+      return NULL;
+    }
+    char esc = content[i];
+    switch (esc) {
+    case '"':
+    case '\\':
+    case '/':
+      out[j++] = esc;
+      break;
+    case 'b':
+      out[j++] = '\b';
+      break;
+    case 'f':
+      out[j++] = '\f';
+      break;
+    case 'n':
+      out[j++] = '\n';
+      break;
+    case 'r':
+      out[j++] = '\r';
+      break;
+    case 't':
+      out[j++] = '\t';
+      break;
+    case 'u': {
+      int32_t unit = read_hex4(content, length, i + 1);
+      if (unit < 0) {
+        fail(p, "Invalid \\u escape at position %zu", i);
+        return NULL;
+      }
+      i += 4;
+      uint32_t cp = (uint32_t)unit;
+      if (unit >= 0xD800 && unit <= 0xDBFF) {
+        if (i + 2 >= length || content[i + 1] != '\\' ||
+            content[i + 2] != 'u') {
+          fail(p, "High surrogate at %zu not followed by low surrogate", i);
+          return NULL;
+        }
+        int32_t low = read_hex4(content, length, i + 3);
+        if (low < 0) {
+          fail(p, "Invalid low surrogate hex at position %zu", i + 3);
+          return NULL;
+        }
+        if (low < 0xDC00 || low > 0xDFFF) {
+          fail(p, "Expected low surrogate");
+          return NULL;
+        }
+        cp = 0x10000 + ((uint32_t)(unit - 0xD800) << 10) +
+             (uint32_t)(low - 0xDC00);
+        i += 6;
+      } else if (unit >= 0xDC00 && unit <= 0xDFFF) {
+        fail(p, "Unexpected low surrogate at position %zu", i);
+        return NULL;
+      }
+      j += encode_utf8(cp, out + j);
+      break;
+    }
+    default: {
+      // report the whole utf-8 sequence rather than its first byte
+      int width = 1;
+      unsigned char lead = (unsigned char)esc;
+      if (lead >= 0xF0)
+        width = 4;
+      else if (lead >= 0xE0)
+        width = 3;
+      else if (lead >= 0xC0)
+        width = 2;
+      if (i + width > length)
+        width = (int)(length - i);
+      fail(p, "Unknown escape sequence: \\%.*s", width, content + i);
+      return NULL;
+    }
+    }
+    i++;
+  }
+  return p->api->string_to_argon((struct string){out, j});
+}
+
+static ArgonObject *parse_string(Parser *p, size_t position) {
+  const char *content = p->data + position + 1;
+  const char *end = p->data + p->length;
+  const char *at = content;
+  bool has_escape = false;
+  while (true) {
+    at = json_find_quote_or_escape(at, end);
+    if (at >= end) {
+      fail(p, "Unterminated string");
+      return NULL;
+    }
+    if (*at == '"')
+      break;
+    has_escape = true;
+    at += 2;
+    if (at > end) {
+      fail(p, "Unterminated string");
+      return NULL;
+    }
+  }
+  size_t length = at - content;
+  if (!has_escape)
+    return p->api->string_to_argon((struct string){(char *)content, length});
+  return unescape(p, content, length);
+}
+
+static ArgonObject *parse_literal(Parser *p, size_t position,
+                                  const char *word, ArgonObject *value) {
+  size_t length = strlen(word);
+  for (size_t i = 0; i < length; i++) {
+    if (position + i >= p->length || p->data[position + i] != word[i]) {
+      fail(p, "Expected '%s' at position %zu", word, position + i);
+      return NULL;
+    }
+  }
+  if (!is_delimiter(p, position + length))
+    p->resume = position + length;
+  return value;
+}
+
+static bool is_digit(Parser *p, size_t i) {
+  return i < p->length && p->data[i] >= '0' && p->data[i] <= '9';
+}
+
+static ArgonObject *parse_number(Parser *p, size_t position) {
+  size_t i = position;
+  if (i < p->length && p->data[i] == '-')
+    i++;
+  size_t digits_start = i;
+  while (is_digit(p, i))
+    i++;
+  size_t integer_digits = i - digits_start;
+  bool is_integer = true;
+  size_t mantissa_digits = integer_digits;
+  if (i < p->length && p->data[i] == '.') {
+    is_integer = false;
+    size_t fraction_start = ++i;
+    while (is_digit(p, i))
+      i++;
+    mantissa_digits += i - fraction_start;
+  }
+  if (i < p->length && (p->data[i] == 'e' || p->data[i] == 'E')) {
+    is_integer = false;
+    i++;
+    if (i < p->length && (p->data[i] == '+' || p->data[i] == '-'))
+      i++;
+    size_t exponent_start = i;
+    while (is_digit(p, i))
+      i++;
+    if (i == exponent_start)
+      mantissa_digits = 0;
+  }
+  if (i == position) {
+    unsigned char lead = (unsigned char)p->data[i];
+    int width = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+    if (i + width > p->length)
+      width = (int)(p->length - i);
+    fail(p, "Unexpected character '%.*s' at position %zu", width, p->data + i,
+         i);
+    return NULL;
+  }
+  if (mantissa_digits == 0) {
+    fail(p, "Invalid number '%.*s' at position %zu", (int)(i - position),
+         p->data + position, position);
+    return NULL;
+  }
+  if (!is_delimiter(p, i))
+    p->resume = i;
+
+  // most numbers in the wild are small integers
+  if (is_integer && integer_digits <= 18) {
+    int64_t value = 0;
+    for (size_t d = digits_start; d < i; d++)
+      value = value * 10 + (p->data[d] - '0');
+    return p->api->i64_to_argon(p->data[position] == '-' ? -value : value);
+  }
+  ArgonObject *number = p->api->string_to_number(
+      (struct string){(char *)p->data + position, i - position}, p->err);
+  if (p->api->is_error(p->err))
+    return NULL;
+  return number;
+}
+
+static ArgonObject *close_array(Parser *p, size_t base) {
+  return p->api->create_argon_array(p->values + base,
+                                    p->values_length - base);
+}
+
+static ArgonObject *close_object(Parser *p, size_t base) {
+  ArgonHashmap *hashmap = p->api->create_hashmap();
+  for (size_t i = base; i + 1 < p->values_length; i += 2) {
+    p->api->add_to_hashmap(hashmap, p->values[i], p->values[i + 1], p->state,
+                           p->err);
+    if (p->api->is_error(p->err))
+      return NULL;
+  }
+  return p->api->hashmap_to_dictionary(hashmap);
+}
+
+static ArgonObject *parse_document(Parser *p) {
+  size_t position;
+  ArgonObject *value;
+
+parse_value:
+  position = next_position(p);
+  if (position >= p->length)
+    return fail(p, "Invalid JSON"), NULL;
+  switch (p->data[position]) {
+  case '{':
+    if (p->index[p->next] < p->length && p->data[p->index[p->next]] == '}') {
+      p->next++;
+      value = p->api->hashmap_to_dictionary(p->api->create_hashmap());
+      break;
+    }
+    if (!push_frame(p, '{'))
+      return NULL;
+    goto parse_key;
+  case '[':
+    if (p->index[p->next] < p->length && p->data[p->index[p->next]] == ']') {
+      p->next++;
+      value = p->api->create_argon_array(NULL, 0);
+      break;
+    }
+    if (!push_frame(p, '['))
+      return NULL;
+    goto parse_value;
+  case '"':
+    value = parse_string(p, position);
+    break;
+  case 't':
+    value = parse_literal(p, position, "true", p->api->ARGON_TRUE);
+    break;
+  case 'f':
+    value = parse_literal(p, position, "false", p->api->ARGON_FALSE);
+    break;
+  case 'n':
+    value = parse_literal(p, position, "null", p->api->ARGON_NULL);
+    break;
+  default:
+    value = parse_number(p, position);
+    break;
+  }
+  if (!value || !push_value(p, value))
+    return NULL;
+
+after_value:
+  if (p->frames_length == 0) {
+    position = next_position(p);
+    if (position < p->length)
+      return fail(p, "Unexpected trailing content at position %zu", position),
+             NULL;
+    return p->values[0];
+  }
+  position = next_position(p);
+  if (position >= p->length)
+    return fail(p, "Invalid JSON"), NULL;
+  Frame frame = p->frames[p->frames_length - 1];
+  char c = p->data[position];
+  if (frame.kind == '[') {
+    if (c == ',')
+      goto parse_value;
+    if (c != ']')
+      return fail(p, "Expected ',' or ']' at position %zu", position), NULL;
+    value = close_array(p, frame.base);
+  } else {
+    if (c == ',')
+      goto parse_key;
+    if (c != '}')
+      return fail(p, "Expected ',' or '}' at position %zu", position), NULL;
+    value = close_object(p, frame.base);
+    if (!value)
+      return NULL;
+  }
+  p->frames_length--;
+  p->values_length = frame.base;
+  if (!push_value(p, value))
+    return NULL;
+  goto after_value;
+
+parse_key:
+  position = next_position(p);
+  if (position >= p->length)
+    return fail(p, "Invalid JSON"), NULL;
+  if (p->data[position] != '"')
+    return fail(p, "Expected '\"' at position %zu", position), NULL;
+  value = parse_string(p, position);
+  if (!value || !push_value(p, value))
+    return NULL;
+  position = next_position(p);
+  if (position >= p->length)
+    return fail(p, "Invalid JSON"), NULL;
+  if (p->data[position] != ':')
+    return fail(p, "Expected ':' at position %zu", position), NULL;
+  goto parse_value;
+}
+
+ArgonObject *json_unescape(const char *data, size_t length,
+                           ArgonObject *value_error, ArgonError *err,
+                           ArgonNativeAPI *api) {
+  Parser p = {
+      .value_error = value_error,
+      .err = err,
+      .api = api,
+  };
+  ArgonObject *result = unescape(&p, data, length);
+  free(p.scratch);
+  return result ? result : api->ARGON_NULL;
+}
+
+ArgonObject *json_parse(const char *data, size_t length,
+                        ArgonObject *value_error, ArgonError *err,
+                        ArgonState *state, ArgonNativeAPI *api) {
+  size_t count;
+  uint32_t *index = json_structural_index(data, length, &count);
+  if (!index)
+    return api->throw_argon_error(err, value_error,
+                                  "JSON document is too large");
+  Parser p = {
+      .data = data,
+      .length = length,
+      .index = index,
+      .resume = NO_POSITION,
+      .value_error = value_error,
+      .err = err,
+      .state = state,
+      .api = api,
+  };
+  ArgonObject *result = parse_document(&p);
+  free(index);
+  free(p.frames);
+  free(p.scratch);
+  if (p.values)
+    api->free(p.values);
+  return result ? result : api->ARGON_NULL;
+}
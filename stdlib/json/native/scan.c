@@ -0,0 +1,283 @@
+// SPDX-FileCopyrightText: 2026 William Bell
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "json.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define JSON_SSE2
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define JSON_NEON
+#endif
+
+/*
+ * stage one of the parser, after simdjson. each 64 byte block is classified
+ * into bitmasks (one bit per byte), then escapes and string spans are worked
+ * out with plain integer arithmetic so no byte is looked at twice.
+ */
+
+typedef struct {
+  uint64_t quote;
+  uint64_t backslash;
+  uint64_t op; // { } [ ] : ,
+  uint64_t space;
+} BlockMasks;
+
+#if defined(JSON_SSE2)
+
+static inline uint64_t movemask16(__m128i v, unsigned shift) {
+  return (uint64_t)(uint32_t)_mm_movemask_epi8(v) << shift;
+}
+
+static BlockMasks classify(const uint8_t *block) {
+  BlockMasks m = {0, 0, 0, 0};
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i lower = _mm_set1_epi8(0x20);
+  const __m128i open = _mm_set1_epi8('{');
+  const __m128i close = _mm_set1_epi8('}');
+  const __m128i colon = _mm_set1_epi8(':');
+  const __m128i comma = _mm_set1_epi8(',');
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i newline = _mm_set1_epi8('\n');
+  const __m128i carriage = _mm_set1_epi8('\r');
+  for (unsigned i = 0; i < 4; i++) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(block + i * 16));
+    // '[' and ']' are '{' and '}' with bit 5 cleared
+    __m128i folded = _mm_or_si128(v, lower);
+    m.quote |= movemask16(_mm_cmpeq_epi8(v, quote), i * 16);
+    m.backslash |= movemask16(_mm_cmpeq_epi8(v, backslash), i * 16);
+    m.op |= movemask16(
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(folded, open),
+                                  _mm_cmpeq_epi8(folded, close)),
+                     _mm_or_si128(_mm_cmpeq_epi8(v, colon),
+                                  _mm_cmpeq_epi8(v, comma))),
+        i * 16);
+    m.space |= movemask16(
+        _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, newline),
+                         _mm_cmpeq_epi8(v, carriage))),
+        i * 16);
+  }
+  return m;
+}
+
+#elif defined(JSON_NEON)
+
+// neon has no movemask, so weight each lane by its bit and add pairwise.
+static inline uint64_t movemask64(uint8x16_t a, uint8x16_t b, uint8x16_t c,
+                                  uint8x16_t d) {
+  const uint8x16_t bits = {1, 2, 4, 8, 16, 32, 64, 128,
+                           1, 2, 4, 8, 16, 32, 64, 128};
+  uint8x16_t sum0 = vpaddq_u8(vandq_u8(a, bits), vandq_u8(b, bits));
+  uint8x16_t sum1 = vpaddq_u8(vandq_u8(c, bits), vandq_u8(d, bits));
+  sum0 = vpaddq_u8(sum0, sum1);
+  sum0 = vpaddq_u8(sum0, sum0);
+  return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+}
+
+#define NEON_MASK(EXPR)                                                        \
+  movemask64(EXPR(v[0]), EXPR(v[1]), EXPR(v[2]), EXPR(v[3]))
+
+static BlockMasks classify(const uint8_t *block) {
+  uint8x16_t v[4];
+  for (unsigned i = 0; i < 4; i++)
+    v[i] = vld1q_u8(block + i * 16);
+#define IS_QUOTE(x) vceqq_u8(x, vdupq_n_u8('"'))
+#define IS_BACKSLASH(x) vceqq_u8(x, vdupq_n_u8('\\'))
+#define IS_OP(x)                                                               \
+  vorrq_u8(vorrq_u8(vceqq_u8(vorrq_u8(x, vdupq_n_u8(0x20)), vdupq_n_u8('{')),  \
+                    vceqq_u8(vorrq_u8(x, vdupq_n_u8(0x20)), vdupq_n_u8('}'))), \
+           vorrq_u8(vceqq_u8(x, vdupq_n_u8(':')), vceqq_u8(x, vdupq_n_u8(','))))
+#define IS_SPACE(x)                                                            \
+  vorrq_u8(                                                                    \
+      vorrq_u8(vceqq_u8(x, vdupq_n_u8(' ')), vceqq_u8(x, vdupq_n_u8('\t'))),   \
+      vorrq_u8(vceqq_u8(x, vdupq_n_u8('\n')), vceqq_u8(x, vdupq_n_u8('\r'))))
+  BlockMasks m = {NEON_MASK(IS_QUOTE), NEON_MASK(IS_BACKSLASH),
+                  NEON_MASK(IS_OP), NEON_MASK(IS_SPACE)};
+#undef IS_QUOTE
+#undef IS_BACKSLASH
+#undef IS_OP
+#undef IS_SPACE
+  return m;
+}
+
+#else
+
+static BlockMasks classify(const uint8_t *block) {
+  BlockMasks m = {0, 0, 0, 0};
+  for (unsigned i = 0; i < JSON_BLOCK; i++) {
+    uint64_t bit = (uint64_t)1 << i;
+    switch (block[i]) {
+    case '"':
+      m.quote |= bit;
+      break;
+    case '\\':
+      m.backslash |= bit;
+      break;
+    case '{':
+    case '}':
+    case '[':
+    case ']':
+    case ':':
+    case ',':
+      m.op |= bit;
+      break;
+    case ' ':
+    case '\t':
+    case '\n':
+    case '\r':
+      m.space |= bit;
+      break;
+    }
+  }
+  return m;
+}
+
+#endif
+
+static inline uint64_t prefix_xor(uint64_t x) {
+  x ^= x << 1;
+  x ^= x << 2;
+  x ^= x << 4;
+  x ^= x << 8;
+  x ^= x << 16;
+  x ^= x << 32;
+  return x;
+}
+
+// bytes preceded by an odd run of backslashes. a run that starts on an even
+// bit carries into the odd bits when subtracted, which flips its parity.
+static inline uint64_t find_escaped(uint64_t backslash, uint64_t *carry) {
+  const uint64_t odd_bits = 0xAAAAAAAAAAAAAAAAULL;
+  if (!backslash) {
+    uint64_t escaped = *carry;
+    *carry = 0;
+    return escaped;
+  }
+  uint64_t potential = backslash & ~*carry;
+  uint64_t code = (((potential << 1) | odd_bits) - potential) ^ odd_bits;
+  uint64_t escaped = code ^ (backslash | *carry);
+  *carry = (code & backslash) >> 63;
+  return escaped;
+}
+
+uint64_t json_scan_block(const uint8_t *block, ScanState *state) {
+  BlockMasks m = classify(block);
+  uint64_t escaped = find_escaped(m.backslash, &state->escaped);
+  uint64_t quote = m.quote & ~escaped;
+  // set from each opening quote up to, but not including, its closing quote
+  uint64_t in_string = prefix_xor(quote) ^ state->in_string;
+  state->in_string = (uint64_t)((int64_t)in_string >> 63);
+
+  uint64_t bare = ~(m.op | m.space | m.quote | in_string);
+  uint64_t bare_start = bare & ~((bare << 1) | state->scalar);
+  state->scalar = bare >> 63;
+
+  return (m.op & ~in_string) | (quote & in_string) | bare_start;
+}
+
+uint32_t *json_structural_index(const char *data, size_t length,
+                                size_t *count) {
+  if (length >= UINT32_MAX)
+    return NULL;
+  uint32_t *index = malloc((length + 1) * sizeof(uint32_t));
+  if (!index)
+    return NULL;
+  ScanState state = {0, 0, 0};
+  size_t n = 0;
+  size_t offset = 0;
+  uint8_t tail[JSON_BLOCK];
+  while (offset < length) {
+    const uint8_t *block = (const uint8_t *)data + offset;
+    if (length - offset < JSON_BLOCK) {
+      memset(tail, ' ', JSON_BLOCK);
+      memcpy(tail, block, length - offset);
+      block = tail;
+    }
+    uint64_t bits = json_scan_block(block, &state);
+    while (bits) {
+      index[n++] = (uint32_t)(offset + __builtin_ctzll(bits));
+      bits &= bits - 1;
+    }
+    offset += JSON_BLOCK;
+  }
+  index[n] = (uint32_t)length;
+  *count = n;
+  return index;
+}
+
+const char *json_find_quote_or_escape(const char *data, const char *end) {
+#if defined(JSON_SSE2)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  for (; end - data >= 16; data += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)data);
+    unsigned mask = (unsigned)_mm_movemask_epi8(_mm_or_si128(
+        _mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)));
+    if (mask)
+      return data + __builtin_ctz(mask);
+  }
+#elif defined(JSON_NEON)
+  const uint8x16_t quote = vdupq_n_u8('"');
+  const uint8x16_t backslash = vdupq_n_u8('\\');
+  for (; end - data >= 16; data += 16) {
+    uint8x16_t v = vld1q_u8((const uint8_t *)data);
+    uint8x16_t hit = vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash));
+    // 4 bits per byte once narrowed
+    uint64_t mask = vget_lane_u64(
+        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hit), 4)), 0);
+    if (mask)
+      return data + __builtin_ctzll(mask) / 4;
+  }
+#endif
+  for (; data < end; data++)
+    if (*data == '"' || *data == '\\')
+      return data;
+  return end;
+}
+
+size_t json_plain_prefix(const char *data, size_t length) {
+  size_t i = 0;
+#if defined(JSON_SSE2)
+  // signed compare catches both control bytes and bytes >= 0x80
+  const __m128i low = _mm_set1_epi8(0x20);
+  const __m128i del = _mm_set1_epi8(0x7f);
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  for (; i + 16 <= length; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+    __m128i special = _mm_or_si128(
+        _mm_or_si128(_mm_cmplt_epi8(v, low), _mm_cmpeq_epi8(v, del)),
+        _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)));
+    unsigned mask = (unsigned)_mm_movemask_epi8(special);
+    if (mask)
+      return i + __builtin_ctz(mask);
+  }
+#elif defined(JSON_NEON)
+  const uint8x16_t low = vdupq_n_u8(0x20);
+  const uint8x16_t del = vdupq_n_u8(0x7f);
+  const uint8x16_t quote = vdupq_n_u8('"');
+  const uint8x16_t backslash = vdupq_n_u8('\\');
+  for (; i + 16 <= length; i += 16) {
+    uint8x16_t v = vld1q_u8((const uint8_t *)data + i);
+    uint8x16_t special =
+        vorrq_u8(vorrq_u8(vcltq_u8(v, low), vcgeq_u8(v, del)),
+                 vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash)));
+    if (vmaxvq_u8(special))
+      break;
+  }
+#endif
+  for (; i < length; i++) {
+    unsigned char c = (unsigned char)data[i];
+    if (c < 0x20 || c >= 0x7f || c == '"' || c == '\\')
+      break;
+  }
+  return i;
+}
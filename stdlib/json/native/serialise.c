@@ -0,0 +1,300 @@
+// SPDX-FileCopyrightText: 2026 William Bell
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "json.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * writes straight into one growable buffer instead of joining an array of
+ * fragments. the output is byte for byte what the argon implementation made,
+ * including the \uXXXX escaping of everything outside printable ascii.
+ */
+
+typedef struct {
+  char *data;
+  size_t length;
+  size_t capacity;
+  JsonWriterOptions *options;
+} Writer;
+
+static bool out_of_memory(Writer *w) {
+  w->options->api->throw_argon_error(w->options->err,
+                                     w->options->api->RuntimeError,
+                                     "out of memory");
+  return false;
+}
+
+static bool reserve(Writer *w, size_t extra) {
+  if (w->length + extra <= w->capacity)
+    return true;
+  size_t capacity = w->capacity ? w->capacity : 256;
+  while (capacity < w->length + extra)
+    capacity *= 2;
+  char *data = realloc(w->data, capacity);
+  if (!data)
+    return out_of_memory(w);
+  w->data = data;
+  w->capacity = capacity;
+  return true;
+}
+
+static bool write_bytes(Writer *w, const char *bytes, size_t length) {
+  if (!reserve(w, length))
+    return false;
+  memcpy(w->data + w->length, bytes, length);
+  w->length += length;
+  return true;
+}
+
+#define WRITE_LITERAL(W, S) write_bytes(W, S, sizeof(S) - 1)
+
+static bool write_newline(Writer *w, size_t depth) {
+  struct string indent = w->options->indent;
+  if (!reserve(w, 1 + indent.length * depth))
+    return false;
+  w->data[w->length++] = '\n';
+  for (size_t i = 0; i < depth; i++) {
+    memcpy(w->data + w->length, indent.data, indent.length);
+    w->length += indent.length;
+  }
+  return true;
+}
+
+/* Returns the number of bytes consumed, or 0 on invalid UTF-8. */
+static int decode_utf8(const unsigned char *s, size_t len, uint32_t *cp) {
+  if (s[0] < 0x80) {
+    *cp = s[0];
+    return 1;
+  } else if ((s[0] & 0xE0) == 0xC0 && len >= 2) {
+    *cp = ((s[0] & 0x1F) << 6) | (s[1] & 0x3F);
+    return 2;
+  } else if ((s[0] & 0xF0) == 0xE0 && len >= 3) {
+    *cp = ((s[0] & 0x0F) << 12) | ((s[1] & 0x3F) << 6) | (s[2] & 0x3F);
+    return 3;
+  } else if ((s[0] & 0xF8) == 0xF0 && len >= 4) {
+    *cp = ((s[0] & 0x07) << 18) | ((s[1] & 0x3F) << 12) | ((s[2] & 0x3F) << 6) |
+          (s[3] & 0x3F);
+    return 4;
+  }
+  return 0;
+}
+
+static bool write_string(Writer *w, const char *data, size_t length) {
+  // worst case every byte turns into a \uXXXX escape
+  if (!reserve(w, length * 6 + 2))
+    return false;
+  char *out = w->data + w->length;
+  *out++ = '"';
+  size_t i = 0;
+  while (i < length) {
+    size_t run = json_plain_prefix(data + i, length - i);
+    memcpy(out, data + i, run);
+    out += run;
+    i += run;
+    if (i >= length)
+      break;
+    unsigned char c = (unsigned char)data[i];
+    switch (c) {
+    case '\n':
+      out[0] = '\\', out[1] = 'n', out += 2, i++;
+      break;
+    case '\t':
+      out[0] = '\\', out[1] = 't', out += 2, i++;
+      break;
+    case '\r':
+      out[0] = '\\', out[1] = 'r', out += 2, i++;
+      break;
+    case '\\':
+    case '"':
+      out[0] = '\\', out[1] = (char)c, out += 2, i++;
+      break;
+    default: {
+      uint32_t cp;
+      int consumed =
+          decode_utf8((const unsigned char *)data + i, length - i, &cp);
+      if (consumed <= 0) {
+        cp = c;
+        consumed = 1;
+      }
+      i += consumed;
+      if (cp <= 0xFFFF) {
+        out += sprintf(out, "\\u%04X", cp);
+      } else {
+        // a surrogate pair is 12 bytes for 4 bytes of input
+        cp -= 0x10000;
+        out += sprintf(out, "\\u%04X\\u%04X", 0xD800 + (cp >> 10),
+                       0xDC00 + (cp & 0x3FF));
+      }
+    }
+    }
+  }
+  *out++ = '"';
+  w->length = out - w->data;
+  return true;
+}
+
+static bool write_repr(Writer *w, ArgonObject *value) {
+  ArgonNativeAPI *api = w->options->api;
+  ArgonObject *repr = api->repr(value, w->options->err, w->options->state);
+  if (api->is_error(w->options->err))
+    return false;
+  struct string str = api->argon_to_string(repr, w->options->err);
+  if (api->is_error(w->options->err))
+    return false;
+  return write_bytes(w, str.data, str.length);
+}
+
+static bool push_parent(Writer *w, ArgonObject *value) {
+  JsonParents *parents = &w->options->parents;
+  for (size_t i = 0; i < parents->length; i++) {
+    if (parents->items[i] == value) {
+      w->options->api->throw_argon_error(w->options->err,
+                                         w->options->value_error,
+                                         "circular JSON serialisation");
+      return false;
+    }
+  }
+  if (parents->length == parents->capacity) {
+    size_t capacity = parents->capacity ? parents->capacity * 2 : 16;
+    ArgonObject **items = realloc(parents->items, capacity * sizeof(*items));
+    if (!items)
+      return out_of_memory(w);
+    parents->items = items;
+    parents->capacity = capacity;
+  }
+  parents->items[parents->length++] = value;
+  return true;
+}
+
+static bool write_value(Writer *w, ArgonObject *value);
+
+static bool write_array(Writer *w, ArgonObject *value) {
+  ArgonNativeAPI *api = w->options->api;
+  struct array array = api->argon_to_array(value, w->options->err);
+  if (api->is_error(w->options->err) || !push_parent(w, value))
+    return false;
+  size_t depth = w->options->parents.length;
+  if (!WRITE_LITERAL(w, "["))
+    return false;
+  for (size_t i = 0; i < array.size; i++) {
+    if (i && !WRITE_LITERAL(w, ","))
+      return false;
+    if (w->options->pretty && !write_newline(w, depth))
+      return false;
+    if (!write_value(w, array.items[i]))
+      return false;
+  }
+  w->options->parents.length--;
+  if (w->options->pretty && array.size && !write_newline(w, depth - 1))
+    return false;
+  return WRITE_LITERAL(w, "]");
+}
+
+static bool write_dictionary(Writer *w, ArgonObject *value) {
+  ArgonNativeAPI *api = w->options->api;
+  struct dictionary dictionary = api->argon_to_dictionary(value, w->options->err);
+  if (api->is_error(w->options->err) || !push_parent(w, value))
+    return false;
+  size_t depth = w->options->parents.length;
+  if (!WRITE_LITERAL(w, "{"))
+    return false;
+  for (size_t i = 0; i < dictionary.size; i++) {
+    if (i && !WRITE_LITERAL(w, ","))
+      return false;
+    if (w->options->pretty && !write_newline(w, depth))
+      return false;
+    ArgonObject *key = dictionary.keys[i];
+    if (api->argon_get_ArgonType(key) == TYPE_STRING) {
+      struct string str = api->argon_to_string(key, w->options->err);
+      if (!write_string(w, str.data, str.length))
+        return false;
+    } else {
+      // non-string keys are written as the string of their repr
+      ArgonObject *repr = api->repr(key, w->options->err, w->options->state);
+      if (api->is_error(w->options->err))
+        return false;
+      struct string str = api->argon_to_string(repr, w->options->err);
+      if (!write_string(w, str.data, str.length))
+        return false;
+    }
+    if (!(w->options->pretty ? WRITE_LITERAL(w, ": ") : WRITE_LITERAL(w, ":")))
+      return false;
+    if (!write_value(w, dictionary.values[i]))
+      return false;
+  }
+  w->options->parents.length--;
+  if (w->options->pretty && dictionary.size && !write_newline(w, depth - 1))
+    return false;
+  return WRITE_LITERAL(w, "}");
+}
+
+// anything else goes back to argon, which handles __json__ and the TypeError.
+static bool write_fallback(Writer *w, ArgonObject *value) {
+  ArgonNativeAPI *api = w->options->api;
+  JsonParents *parents = &w->options->parents;
+  for (size_t i = 0; i < parents->length; i++) {
+    if (parents->items[i] == value) {
+      api->throw_argon_error(w->options->err, w->options->value_error,
+                             "circular JSON serialisation");
+      return false;
+    }
+  }
+  ArgonObject *argv[] = {
+      value,
+      w->options->pretty ? api->ARGON_TRUE : api->ARGON_FALSE,
+      api->create_argon_array(parents->items, parents->length),
+  };
+  ArgonObject *output = api->call(w->options->fallback, 3, argv, NULL,
+                                  w->options->err, w->options->state);
+  if (api->is_error(w->options->err))
+    return false;
+  struct string str = api->argon_to_string(output, w->options->err);
+  if (api->is_error(w->options->err))
+    return false;
+  return write_bytes(w, str.data, str.length);
+}
+
+static bool write_value(Writer *w, ArgonObject *value) {
+  ArgonNativeAPI *api = w->options->api;
+  if (value == api->ARGON_NULL)
+    return WRITE_LITERAL(w, "null");
+  if (value == api->ARGON_TRUE)
+    return WRITE_LITERAL(w, "true");
+  if (value == api->ARGON_FALSE)
+    return WRITE_LITERAL(w, "false");
+  switch (api->argon_get_ArgonType(value)) {
+  case TYPE_STRING: {
+    struct string str = api->argon_to_string(value, w->options->err);
+    return write_string(w, str.data, str.length);
+  }
+  case TYPE_NUMBER:
+    if (api->argon_is_i64(value)) {
+      char digits[24];
+      int length = snprintf(digits, sizeof(digits), "%" PRId64,
+                            api->argon_to_i64(value, w->options->err));
+      return write_bytes(w, digits, (size_t)length);
+    }
+    return write_repr(w, value);
+  case TYPE_ARRAY:
+    return write_array(w, value);
+  case TYPE_DICTIONARY:
+    return write_dictionary(w, value);
+  default:
+    return write_fallback(w, value);
+  }
+}
+
+char *json_stringify(ArgonObject *value, JsonWriterOptions *options,
+                     size_t *length) {
+  Writer w = {NULL, 0, 0, options};
+  if (!write_value(&w, value)) {
+    free(w.data);
+    return NULL;
+  }
+  *length = w.length;
+  return w.data;
+}
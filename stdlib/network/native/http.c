@@ -0,0 +1,364 @@
+// SPDX-FileCopyrightText: 2026 William Bell
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "http.h"
+#include <string.h>
+
+// longest chunk-size line (size plus extensions) we wait for
+#define HTTP_MAX_CHUNK_LINE 1024
+
+size_t http_find_header_end(const char *data, size_t length, size_t from) {
+  // the terminator may straddle the point the last call stopped at
+  size_t i = from >= 3 ? from - 3 : 0;
+
+  while (i < length) {
+    const char *newline = memchr(data + i, '\n', length - i);
+    if (!newline)
+      return 0;
+    i = (size_t)(newline - data);
+
+    // accept \r\n\r\n and the bare \n\n some clients send
+    if (i >= 1 && data[i - 1] == '\n')
+      return i + 1;
+    if (i >= 2 && data[i - 1] == '\r' && data[i - 2] == '\n')
+      return i + 1;
+    i++;
+  }
+  return 0;
+}
+
+static bool is_token_char(unsigned char c) {
+  if (c >= '0' && c <= '9')
+    return true;
+  if ((c | 0x20) >= 'a' && (c | 0x20) <= 'z')
+    return true;
+  return c != 0 && strchr("!#$%&'*+-.^_`|~", c) != NULL;
+}
+
+bool http_valid_header(const char *name, size_t name_length,
+                       const char *value, size_t value_length) {
+  if (name_length == 0)
+    return false;
+  for (size_t i = 0; i < name_length; i++) {
+    if (!is_token_char((unsigned char)name[i]))
+      return false;
+  }
+  for (size_t i = 0; i < value_length; i++) {
+    if (value[i] == '\r' || value[i] == '\n' || value[i] == '\0')
+      return false;
+  }
+  return true;
+}
+
+static bool slice_is(http_slice_t slice, const char *lower) {
+  size_t length = strlen(lower);
+  if (slice.length != length)
+    return false;
+  for (size_t i = 0; i < length; i++) {
+    unsigned char c = (unsigned char)slice.data[i];
+    if (c >= 'A' && c <= 'Z')
+      c |= 0x20;
+    if (c != (unsigned char)lower[i])
+      return false;
+  }
+  return true;
+}
+
+static http_slice_t trim_spaces(const char *start, const char *end) {
+  while (start < end && (*start == ' ' || *start == '\t'))
+    start++;
+  while (end > start && (end[-1] == ' ' || end[-1] == '\t'))
+    end--;
+  return (http_slice_t){start, (size_t)(end - start)};
+}
+
+// whether any comma separated element of a header value equals lower.
+static bool list_contains(http_slice_t value, const char *lower) {
+  const char *p = value.data;
+  const char *end = value.data + value.length;
+  while (p < end) {
+    const char *comma = memchr(p, ',', (size_t)(end - p));
+    const char *stop = comma ? comma : end;
+    if (slice_is(trim_spaces(p, stop), lower))
+      return true;
+    p = stop + 1;
+  }
+  return false;
+}
+
+static bool last_element_is(http_slice_t value, const char *lower) {
+  const char *end = value.data + value.length;
+  const char *start = end;
+  while (start > value.data && start[-1] != ',')
+    start--;
+  return slice_is(trim_spaces(start, end), lower);
+}
+
+static bool parse_content_length(http_slice_t value, int64_t *out) {
+  if (value.length == 0)
+    return false;
+  int64_t result = 0;
+  for (size_t i = 0; i < value.length; i++) {
+    char c = value.data[i];
+    if (c < '0' || c > '9')
+      return false;
+    if (result > (INT64_MAX - (c - '0')) / 10)
+      return false;
+    result = result * 10 + (c - '0');
+  }
+  *out = result;
+  return true;
+}
+
+// the end of the line starting at p, without its \r\n or \n
+static const char *line_stop(const char *newline, const char *p) {
+  return newline > p && newline[-1] == '\r' ? newline - 1 : newline;
+}
+
+long http_parse_request(const char *data, size_t length,
+                        http_request_t *request) {
+  size_t end = http_find_header_end(data, length, 0);
+  if (!end)
+    return HTTP_INCOMPLETE;
+
+  const char *p = data;
+  const char *limit = data + end;
+
+  request->header_count = 0;
+  request->content_length = -1;
+  request->chunked = false;
+  request->expect_continue = false;
+
+  // request line: method SP target SP HTTP/1.x
+  const char *newline = memchr(p, '\n', (size_t)(limit - p));
+  const char *stop = line_stop(newline, p);
+
+  const char *method_end = p;
+  while (method_end < stop && is_token_char((unsigned char)*method_end))
+    method_end++;
+  if (method_end == p || method_end == stop || *method_end != ' ')
+    return HTTP_MALFORMED;
+  request->method = (http_slice_t){p, (size_t)(method_end - p)};
+
+  const char *target = method_end + 1;
+  const char *target_end = target;
+  while (target_end < stop && (unsigned char)*target_end > ' ' &&
+         *target_end != 0x7f)
+    target_end++;
+  if (target_end == target || target_end == stop || *target_end != ' ')
+    return HTTP_MALFORMED;
+  request->target = (http_slice_t){target, (size_t)(target_end - target)};
+
+  const char *version = target_end + 1;
+  if (stop - version != 8 || memcmp(version, "HTTP/1.", 7) != 0 ||
+      version[7] < '0' || version[7] > '9')
+    return HTTP_MALFORMED;
+  request->version_minor = version[7] - '0';
+  request->keep_alive = request->version_minor >= 1;
+
+  p = newline + 1;
+
+  bool saw_connection = false;
+
+  while (p < limit) {
+    newline = memchr(p, '\n', (size_t)(limit - p));
+    stop = line_stop(newline, p);
+    if (stop == p)
+      break;
+
+    // obsolete line folding is rejected rather than unfolded (RFC 9112 5.2)
+    if (*p == ' ' || *p == '\t')
+      return HTTP_MALFORMED;
+
+    const char *colon = p;
+    while (colon < stop && is_token_char((unsigned char)*colon))
+      colon++;
+    if (colon == p || colon == stop || *colon != ':')
+      return HTTP_MALFORMED;
+
+    if (request->header_count == HTTP_MAX_HEADERS)
+      return HTTP_TOO_MANY_HEADERS;
+
+    http_header_t *header = &request->headers[request->header_count++];
+    header->name = (http_slice_t){p, (size_t)(colon - p)};
+    header->value = trim_spaces(colon + 1, stop);
+
+    if (slice_is(header->name, "content-length")) {
+      int64_t value;
+      if (!parse_content_length(header->value, &value))
+        return HTTP_MALFORMED;
+      if (request->content_length >= 0 && request->content_length != value)
+        return HTTP_MALFORMED;
+      request->content_length = value;
+    } else if (slice_is(header->name, "transfer-encoding")) {
+      // only chunked is understood, and it has to be applied last
+      if (!last_element_is(header->value, "chunked"))
+        return HTTP_MALFORMED;
+      request->chunked = true;
+    } else if (slice_is(header->name, "connection")) {
+      if (list_contains(header->value, "close")) {
+        request->keep_alive = false;
+        saw_connection = true;
+      } else if (!saw_connection &&
+                 list_contains(header->value, "keep-alive")) {
+        request->keep_alive = true;
+      }
+    } else if (slice_is(header->name, "expect")) {
+      request->expect_continue = slice_is(header->value, "100-continue");
+    }
+
+    p = newline + 1;
+  }
+
+  // both framings at once is how requests get smuggled past proxies
+  if (request->chunked && request->content_length >= 0)
+    return HTTP_MALFORMED;
+
+  return (long)end;
+}
+
+static int hex_value(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  c |= 0x20;
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  return -1;
+}
+
+long http_chunk_header(const char *data, size_t length, bool after_data,
+                       uint64_t *size) {
+  size_t pos = 0;
+
+  // the line break closing the previous chunk's data
+  if (after_data) {
+    if (length == 0)
+      return HTTP_INCOMPLETE;
+    if (data[0] == '\r') {
+      if (length < 2)
+        return HTTP_INCOMPLETE;
+      if (data[1] != '\n')
+        return HTTP_MALFORMED;
+      pos = 2;
+    } else if (data[0] == '\n') {
+      pos = 1;
+    } else {
+      return HTTP_MALFORMED;
+    }
+  }
+
+  const char *newline = memchr(data + pos, '\n', length - pos);
+  if (!newline)
+    return length - pos > HTTP_MAX_CHUNK_LINE ? HTTP_MALFORMED
+                                              : HTTP_INCOMPLETE;
+
+  const char *p = data + pos;
+  uint64_t value = 0;
+  int digits = 0;
+  int digit;
+  while ((digit = hex_value(*p)) >= 0) {
+    if (++digits > 15)
+      return HTTP_MALFORMED;
+    value = value * 16 + (uint64_t)digit;
+    p++;
+  }
+  if (digits == 0 ||
+      (*p != ';' && *p != '\r' && *p != '\n' && *p != ' ' && *p != '\t'))
+    return HTTP_MALFORMED;
+
+  *size = value;
+  pos = (size_t)(newline - data) + 1;
+  if (value > 0)
+    return (long)pos;
+
+  // trailer fields, then the blank line ending the message
+  while (true) {
+    newline = memchr(data + pos, '\n', length - pos);
+    if (!newline)
+      return length - pos > HTTP_MAX_CHUNK_LINE ? HTTP_MALFORMED
+                                                : HTTP_INCOMPLETE;
+    bool blank = line_stop(newline, data + pos) == data + pos;
+    pos = (size_t)(newline - data) + 1;
+    if (blank)
+      return (long)pos;
+  }
+}
+
+// walks a chunked encoding, copying the data to out when it isn't NULL.
+static long chunked_walk(const char *data, size_t length, size_t *body_length,
+                         char *out) {
+  size_t pos = 0;
+  size_t body = 0;
+
+  while (true) {
+    uint64_t size;
+    long header = http_chunk_header(data + pos, length - pos, pos > 0, &size);
+    if (header <= 0)
+      return header;
+    pos += (size_t)header;
+
+    if (size == 0) {
+      *body_length = body;
+      return (long)pos;
+    }
+
+    // the line break after the data is checked with the next header
+    if (size >= length - pos)
+      return HTTP_INCOMPLETE;
+
+    if (out)
+      memcpy(out + body, data + pos, (size_t)size);
+    body += (size_t)size;
+    pos += (size_t)size;
+  }
+}
+
+long http_chunked_length(const char *data, size_t length,
+                         size_t *body_length) {
+  return chunked_walk(data, length, body_length, NULL);
+}
+
+void http_chunked_copy(const char *data, size_t length, char *out) {
+  size_t body_length;
+  chunked_walk(data, length, &body_length, out);
+}
+
+const char *http_status_text(int status) {
+  switch (status) {
+  case 100: return "Continue";
+  case 101: return "Switching Protocols";
+  case 200: return "OK";
+  case 201: return "Created";
+  case 202: return "Accepted";
+  case 204: return "No Content";
+  case 206: return "Partial Content";
+  case 301: return "Moved Permanently";
+  case 302: return "Found";
+  case 303: return "See Other";
+  case 304: return "Not Modified";
+  case 307: return "Temporary Redirect";
+  case 308: return "Permanent Redirect";
+  case 400: return "Bad Request";
+  case 401: return "Unauthorized";
+  case 403: return "Forbidden";
+  case 404: return "Not Found";
+  case 405: return "Method Not Allowed";
+  case 408: return "Request Timeout";
+  case 409: return "Conflict";
+  case 410: return "Gone";
+  case 411: return "Length Required";
+  case 413: return "Content Too Large";
+  case 414: return "URI Too Long";
+  case 415: return "Unsupported Media Type";
+  case 422: return "Unprocessable Content";
+  case 429: return "Too Many Requests";
+  case 431: return "Request Header Fields Too Large";
+  case 500: return "Internal Server Error";
+  case 501: return "Not Implemented";
+  case 502: return "Bad Gateway";
+  case 503: return "Service Unavailable";
+  case 504: return "Gateway Timeout";
+  default: return "Unknown";
+  }
+}
@@ -0,0 +1,121 @@
+// SPDX-FileCopyrightText: 2026 William Bell
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "Argon.h"
+#include "socket.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ---------------------------------------------------------------------
+// HTTP/1.1 message parsing. Nothing here copies: every slice points into
+// the caller's buffer and is only valid while that buffer is unchanged.
+// ---------------------------------------------------------------------
+
+#define HTTP_MAX_HEADERS 100
+
+#define HTTP_INCOMPLETE 0
+#define HTTP_MALFORMED (-1)
+#define HTTP_TOO_MANY_HEADERS (-2)
+
+typedef struct http_slice {
+  const char *data;
+  size_t length;
+} http_slice_t;
+
+typedef struct http_header {
+  http_slice_t name;
+  http_slice_t value;
+} http_header_t;
+
+typedef struct http_request {
+  http_slice_t method;
+  http_slice_t target;
+  int version_minor; // HTTP/1.<version_minor>
+  http_header_t headers[HTTP_MAX_HEADERS];
+  size_t header_count;
+  int64_t content_length; // -1 when there is no Content-Length
+  bool chunked;
+  bool keep_alive;
+  bool expect_continue;
+} http_request_t;
+
+// http_find_header_end: offset just past the blank line ending a header
+// block, or 0 if it hasn't arrived yet. from is where the previous call
+// stopped looking, so feeding a growing buffer stays linear.
+size_t http_find_header_end(const char *data, size_t length, size_t from);
+
+// http_parse_request: parses the request line and headers at data. Returns
+// the length of the header block, HTTP_INCOMPLETE, HTTP_MALFORMED or
+// HTTP_TOO_MANY_HEADERS.
+long http_parse_request(const char *data, size_t length,
+                        http_request_t *request);
+
+// http_chunk_header: parses one chunk-size line at data, preceded by the
+// line break ending the previous chunk's data when after_data is set. For the
+// last chunk the trailers and final blank line are included too. Returns the
+// bytes consumed, HTTP_INCOMPLETE or HTTP_MALFORMED, and sets *size to the
+// chunk's data length.
+long http_chunk_header(const char *data, size_t length, bool after_data,
+                       uint64_t *size);
+
+// http_chunked_length: walks a chunked body at data. Returns the encoded
+// length including the last chunk and trailers, HTTP_INCOMPLETE or
+// HTTP_MALFORMED, and sets *body_length to the decoded size.
+long http_chunked_length(const char *data, size_t length,
+                         size_t *body_length);
+
+// http_chunked_copy: writes the decoded body of a complete chunked encoding
+// of the given encoded length (as returned by http_chunked_length) to out.
+void http_chunked_copy(const char *data, size_t length, char *out);
+
+// http_valid_header: whether name is a token and value holds no CR, LF or
+// NUL, so writing "name: value\r\n" can't add headers or end the block.
+bool http_valid_header(const char *name, size_t name_length,
+                       const char *value, size_t value_length);
+
+// http_status_text: the reason phrase for a status code, or "Unknown".
+const char *http_status_text(int status);
+
+// ---------------------------------------------------------------------
+// The server. Each worker thread accepts connections on the shared
+// listening socket and serves one at a time, answering requests in order
+// (pipelined requests included) until the client closes, asks to close,
+// stays idle past keep_alive_ms, or takes longer than request_timeout_ms to
+// send the whole of a request it has started.
+// ---------------------------------------------------------------------
+
+typedef struct http_server_options {
+  int workers;
+  int keep_alive_ms;
+  int request_timeout_ms;
+  int max_requests; // per connection, 0 for no limit
+  size_t max_header_size;
+  size_t max_body_size;
+} http_server_options_t;
+
+typedef struct http_server http_server_t;
+
+// http_server_create: listens on port. handler is called with one request
+// dictionary per request and returns [status, headers, body, next_chunk].
+// Returns NULL if the port can't be opened.
+http_server_t *http_server_create(ArgonNativeAPI *api, int port,
+                                  ArgonObject *handler,
+                                  http_server_options_t options);
+
+// http_server_run: serves until http_server_stop is called, running one
+// worker on the calling thread and the rest on new threads.
+void http_server_run(http_server_t *server, ArgonState *state);
+
+// http_server_stop: safe to call from a handler or any other thread.
+void http_server_stop(http_server_t *server);
+
+// http_server_port: the port actually bound, useful after asking for 0.
+int http_server_port(http_server_t *server);
+
+// http_server_destroy: closes the listening socket. The server must not be
+// running.
+void http_server_destroy(http_server_t *server);
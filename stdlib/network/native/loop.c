@@ -0,0 +1,336 @@
+// SPDX-FileCopyrightText: 2026 William Bell
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "loop.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <windows.h>
+typedef WSAPOLLFD loop_poll_fd_t;
+#define loop_poll(fds, n, ms) WSAPoll((fds), (ULONG)(n), (ms))
+#else
+#include <poll.h>
+#include <time.h>
+typedef struct pollfd loop_poll_fd_t;
+#define loop_poll(fds, n, ms) poll((fds), (nfds_t)(n), (ms))
+#endif
+
+#ifdef __linux__
+#define NET_LOOP_EPOLL
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
+typedef struct net_timer {
+  int64_t deadline;
+  int64_t id;
+} net_timer_t;
+
+struct net_loop {
+#ifdef NET_LOOP_EPOLL
+  int epoll_fd;
+  struct epoll_event *ready;
+  int ready_capacity;
+#else
+  loop_poll_fd_t *fds;
+  size_t fd_capacity;
+#endif
+  size_t watched;
+
+  // binary min-heap on deadline
+  net_timer_t *timers;
+  size_t timer_count;
+  size_t timer_capacity;
+  int64_t next_timer_id;
+};
+
+static int64_t loop_now_ms(void) {
+#ifdef _WIN32
+  return (int64_t)GetTickCount64();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#endif
+}
+
+net_loop_t *net_loop_create(void) {
+  net_loop_t *loop = calloc(1, sizeof(net_loop_t));
+  if (!loop)
+    return NULL;
+#ifdef NET_LOOP_EPOLL
+  loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (loop->epoll_fd < 0) {
+    free(loop);
+    return NULL;
+  }
+#endif
+  loop->next_timer_id = 1;
+  return loop;
+}
+
+void net_loop_destroy(net_loop_t *loop) {
+  if (!loop)
+    return;
+#ifdef NET_LOOP_EPOLL
+  close(loop->epoll_fd);
+  free(loop->ready);
+#else
+  free(loop->fds);
+#endif
+  free(loop->timers);
+  free(loop);
+}
+
+const char *net_loop_backend(void) {
+#ifdef NET_LOOP_EPOLL
+  return "epoll";
+#else
+  return "poll";
+#endif
+}
+
+size_t net_loop_size(net_loop_t *loop) {
+  return loop->watched + loop->timer_count;
+}
+
+#ifdef NET_LOOP_EPOLL
+
+int net_loop_watch(net_loop_t *loop, socket_t s, int events) {
+  if (events == 0) {
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, s, NULL) != 0)
+      return errno == ENOENT ? 0 : -1;
+    loop->watched--;
+    return 0;
+  }
+
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = (events & NET_POLL_READ ? EPOLLIN | EPOLLRDHUP : 0) |
+                 (events & NET_POLL_WRITE ? EPOLLOUT : 0);
+  event.data.fd = s;
+
+  if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, s, &event) == 0)
+    return 0;
+  if (errno != ENOENT)
+    return -1;
+  if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, s, &event) != 0)
+    return -1;
+  loop->watched++;
+  return 0;
+}
+
+static int loop_wait_sockets(net_loop_t *loop, int timeout_ms,
+                             net_loop_event_t *events, int max_events) {
+  if (max_events <= 0)
+    return 0;
+
+  if (loop->ready_capacity < max_events) {
+    struct epoll_event *ready =
+        realloc(loop->ready, (size_t)max_events * sizeof(struct epoll_event));
+    if (!ready)
+      return -1;
+    loop->ready = ready;
+    loop->ready_capacity = max_events;
+  }
+
+  int n = epoll_wait(loop->epoll_fd, loop->ready, max_events, timeout_ms);
+  if (n < 0)
+    return errno == EINTR ? 0 : -1;
+
+  for (int i = 0; i < n; i++) {
+    uint32_t got = loop->ready[i].events;
+    // errors and hangups wake both sides so the owner sees the failing
+    // recv/send rather than the socket going quiet.
+    bool failed = got & (EPOLLERR | EPOLLHUP);
+    events[i].kind = NET_LOOP_SOCKET;
+    events[i].id = loop->ready[i].data.fd;
+    events[i].events =
+        (got & (EPOLLIN | EPOLLRDHUP) || failed ? NET_POLL_READ : 0) |
+        (got & EPOLLOUT || failed ? NET_POLL_WRITE : 0);
+  }
+  return n;
+}
+
+#else
+
+int net_loop_watch(net_loop_t *loop, socket_t s, int events) {
+  size_t slot = loop->watched;
+  for (size_t i = 0; i < loop->watched; i++) {
+    if (loop->fds[i].fd == s) {
+      slot = i;
+      break;
+    }
+  }
+
+  if (events == 0) {
+    if (slot < loop->watched)
+      loop->fds[slot] = loop->fds[--loop->watched];
+    return 0;
+  }
+
+  if (slot == loop->watched) {
+    if (loop->watched == loop->fd_capacity) {
+      size_t capacity = loop->fd_capacity ? loop->fd_capacity * 2 : 64;
+      loop_poll_fd_t *fds =
+          realloc(loop->fds, capacity * sizeof(loop_poll_fd_t));
+      if (!fds)
+        return -1;
+      loop->fds = fds;
+      loop->fd_capacity = capacity;
+    }
+    loop->fds[slot].fd = s;
+    loop->watched++;
+  }
+
+  loop->fds[slot].events = (events & NET_POLL_READ ? POLLIN : 0) |
+                           (events & NET_POLL_WRITE ? POLLOUT : 0);
+  loop->fds[slot].revents = 0;
+  return 0;
+}
+
+static int loop_wait_sockets(net_loop_t *loop, int timeout_ms,
+                             net_loop_event_t *events, int max_events) {
+  if (loop->watched == 0) {
+    // poll with no descriptors is just a sleep, which WSAPoll refuses.
+    if (timeout_ms > 0) {
+#ifdef _WIN32
+      Sleep((DWORD)timeout_ms);
+#else
+      struct timespec ts = {timeout_ms / 1000, (timeout_ms % 1000) * 1000000L};
+      nanosleep(&ts, NULL);
+#endif
+    }
+    return 0;
+  }
+
+  int n = loop_poll(loop->fds, loop->watched, timeout_ms);
+#ifdef _WIN32
+  // WSAPoll reports through WSAGetLastError, not errno
+  if (n < 0)
+    return WSAGetLastError() == WSAEINTR ? 0 : -1;
+#else
+  if (n < 0)
+    return errno == EINTR ? 0 : -1;
+#endif
+
+  int count = 0;
+  for (size_t i = 0; i < loop->watched && count < max_events; i++) {
+    short got = loop->fds[i].revents;
+    if (!got)
+      continue;
+    bool failed = got & (POLLERR | POLLHUP | POLLNVAL);
+    events[count].kind = NET_LOOP_SOCKET;
+    events[count].id = (int64_t)loop->fds[i].fd;
+    events[count].events = (got & POLLIN || failed ? NET_POLL_READ : 0) |
+                           (got & POLLOUT || failed ? NET_POLL_WRITE : 0);
+    count++;
+  }
+  return count;
+}
+
+#endif
+
+static void timer_swap(net_loop_t *loop, size_t a, size_t b) {
+  net_timer_t held = loop->timers[a];
+  loop->timers[a] = loop->timers[b];
+  loop->timers[b] = held;
+}
+
+static void timer_sift_up(net_loop_t *loop, size_t i) {
+  while (i > 0) {
+    size_t parent = (i - 1) / 2;
+    if (loop->timers[parent].deadline <= loop->timers[i].deadline)
+      break;
+    timer_swap(loop, parent, i);
+    i = parent;
+  }
+}
+
+static void timer_sift_down(net_loop_t *loop, size_t i) {
+  while (true) {
+    size_t smallest = i;
+    size_t left = i * 2 + 1;
+    size_t right = left + 1;
+    if (left < loop->timer_count &&
+        loop->timers[left].deadline < loop->timers[smallest].deadline)
+      smallest = left;
+    if (right < loop->timer_count &&
+        loop->timers[right].deadline < loop->timers[smallest].deadline)
+      smallest = right;
+    if (smallest == i)
+      return;
+    timer_swap(loop, smallest, i);
+    i = smallest;
+  }
+}
+
+static void timer_remove_at(net_loop_t *loop, size_t i) {
+  loop->timers[i] = loop->timers[--loop->timer_count];
+  if (i < loop->timer_count) {
+    timer_sift_down(loop, i);
+    timer_sift_up(loop, i);
+  }
+}
+
+int64_t net_loop_timer(net_loop_t *loop, int64_t delay_ms) {
+  if (loop->timer_count == loop->timer_capacity) {
+    size_t capacity = loop->timer_capacity ? loop->timer_capacity * 2 : 16;
+    net_timer_t *timers = realloc(loop->timers, capacity * sizeof(net_timer_t));
+    if (!timers)
+      return -1;
+    loop->timers = timers;
+    loop->timer_capacity = capacity;
+  }
+
+  int64_t id = loop->next_timer_id++;
+  loop->timers[loop->timer_count].deadline =
+      loop_now_ms() + (delay_ms > 0 ? delay_ms : 0);
+  loop->timers[loop->timer_count].id = id;
+  timer_sift_up(loop, loop->timer_count++);
+  return id;
+}
+
+int net_loop_cancel(net_loop_t *loop, int64_t id) {
+  for (size_t i = 0; i < loop->timer_count; i++) {
+    if (loop->timers[i].id == id) {
+      timer_remove_at(loop, i);
+      return 0;
+    }
+  }
+  return -1;
+}
+
+int net_loop_wait(net_loop_t *loop, int timeout_ms, net_loop_event_t *events,
+                  int max_events) {
+  int count = 0;
+  int64_t now = loop_now_ms();
+
+  while (loop->timer_count > 0 && count < max_events &&
+         loop->timers[0].deadline <= now) {
+    events[count].kind = NET_LOOP_TIMER;
+    events[count].id = loop->timers[0].id;
+    events[count].events = 0;
+    count++;
+    timer_remove_at(loop, 0);
+  }
+
+  // expired timers still collect whatever sockets are already ready, but
+  // don't wait for more.
+  if (count > 0) {
+    timeout_ms = 0;
+  } else if (loop->timer_count > 0) {
+    int64_t until = loop->timers[0].deadline - now;
+    if (timeout_ms < 0 || until < timeout_ms)
+      timeout_ms = (int)(until > INT32_MAX ? INT32_MAX : until);
+  }
+
+  int n = loop_wait_sockets(loop, timeout_ms, events + count,
+                            max_events - count);
+  if (n < 0)
+    return count > 0 ? count : -1;
+  return count + n;
+}
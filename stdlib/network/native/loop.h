@@ -0,0 +1,54 @@
+// SPDX-FileCopyrightText: 2026 William Bell
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "socket.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// An event loop multiplexing any number of sockets plus one-shot timers.
+// Backed by epoll on Linux and by poll (WSAPoll on Windows) elsewhere.
+// Sockets are level triggered: a readable socket is reported on every wait
+// until it has been drained or unwatched.
+
+#define NET_LOOP_SOCKET 0
+#define NET_LOOP_TIMER  1
+
+typedef struct net_loop_event {
+  int kind;   // NET_LOOP_SOCKET or NET_LOOP_TIMER
+  int64_t id; // the socket, or the id net_loop_timer returned
+  int events; // NET_POLL_READ / NET_POLL_WRITE bits for sockets
+} net_loop_event_t;
+
+typedef struct net_loop net_loop_t;
+
+// net_loop_create: returns NULL if the backend can't be initialised.
+net_loop_t *net_loop_create(void);
+void net_loop_destroy(net_loop_t *loop);
+
+// net_loop_watch: sets the NET_POLL_* events wanted for s. 0 stops watching
+// it. Sockets must be unwatched before they are closed. Returns 0 on success,
+// -1 on error.
+int net_loop_watch(net_loop_t *loop, socket_t s, int events);
+
+// net_loop_timer: schedules a timer delay_ms from now and returns its id.
+// Returns -1 if it couldn't be allocated.
+int64_t net_loop_timer(net_loop_t *loop, int64_t delay_ms);
+
+// net_loop_cancel: removes a timer that hasn't fired yet. Returns 0 if it was
+// found, -1 otherwise.
+int net_loop_cancel(net_loop_t *loop, int64_t id);
+
+// net_loop_size: watched sockets plus pending timers.
+size_t net_loop_size(net_loop_t *loop);
+
+// net_loop_wait: blocks for up to timeout_ms (-1 waits until the next timer,
+// or forever without one) and fills events with expired timers followed by
+// ready sockets. Returns the number of events, 0 on timeout, -1 on error.
+int net_loop_wait(net_loop_t *loop, int timeout_ms, net_loop_event_t *events,
+                  int max_events);
+
+// net_loop_backend: "epoll" or "poll".
+const char *net_loop_backend(void);
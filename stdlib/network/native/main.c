@@ -4,6 +4,8 @@
 
 #include "Argon.h"
 #include "ArgonFunction.h"
+#include "http.h"
+#include "loop.h"
 #include "socket.h"
 #include <inttypes.h>
 #include <stdint.h>
@@ -171,12 +173,163 @@ ARGON_FUNCTION(net_recv_string, {
   void *data = malloc(size);
 
   int n = net_recv(connection_socket, data, size);
+  if (n < 0)
+    n = 0;
 
   ArgonObject* str_obj = api->string_to_argon((struct string){data, n});
   free(data);
   return str_obj;
 })
 
+// the region of buffer argv[1] starting at argv[2] and running for argv[3]
+// bytes, or to the end when argv[3] is negative.
+static bool recv_region(ArgonNativeAPI *api, ArgonObject **argv,
+                        struct buffer *region, ArgonError *err) {
+  struct buffer target = api->argon_buffer_to_buffer(argv[1], err);
+  if (api->is_error(err))
+    return false;
+  int64_t offset = api->argon_to_i64(argv[2], err);
+  if (api->is_error(err))
+    return false;
+  int64_t size = api->argon_to_i64(argv[3], err);
+  if (api->is_error(err))
+    return false;
+
+  if (offset < 0 || (uint64_t)offset > target.size) {
+    api->throw_argon_error(err, api->IndexError,
+                           "offset %" PRId64 " is outside a buffer of %zu "
+                           "bytes",
+                           offset, target.size);
+    return false;
+  }
+  size_t room = target.size - (size_t)offset;
+  if (size < 0)
+    size = (int64_t)room;
+  if ((uint64_t)size > room) {
+    api->throw_argon_error(err, api->IndexError,
+                           "%" PRId64 " bytes at offset %" PRId64
+                           " overrun a buffer of %zu bytes",
+                           size, offset, target.size);
+    return false;
+  }
+  if (size > INT32_MAX)
+    size = INT32_MAX;
+
+  region->data = (char *)target.data + offset;
+  region->size = (size_t)size;
+  return true;
+}
+
+// the buffers and strings of an Argon array as send parts. The parts point
+// into the objects, which the caller's array keeps alive.
+static net_iovec_t *send_parts(ArgonNativeAPI *api, ArgonObject *list,
+                               size_t *count, ArgonError *err) {
+  struct array items = api->argon_to_array(list, err);
+  if (api->is_error(err))
+    return NULL;
+
+  net_iovec_t *parts =
+      malloc((items.size ? items.size : 1) * sizeof(net_iovec_t));
+  if (!parts) {
+    api->throw_argon_error(err, api->RuntimeError, "out of memory");
+    return NULL;
+  }
+
+  for (size_t i = 0; i < items.size; i++) {
+    if (api->argon_get_ArgonType(items.items[i]) == TYPE_BUFFER) {
+      struct buffer part = api->argon_buffer_to_buffer(items.items[i], err);
+      parts[i] = (net_iovec_t){part.data, part.size};
+    } else {
+      struct string part = api->argon_to_string(items.items[i], err);
+      parts[i] = (net_iovec_t){part.data, part.length};
+    }
+    if (api->is_error(err)) {
+      free(parts);
+      return NULL;
+    }
+  }
+  *count = items.size;
+  return parts;
+}
+
+static bool file_range(ArgonNativeAPI *api, ArgonObject **argv, int *fd,
+                       int64_t *offset, int64_t *count, ArgonError *err) {
+  int64_t descriptor = api->argon_to_i64(argv[1], err);
+  if (api->is_error(err))
+    return false;
+  *offset = api->argon_to_i64(argv[2], err);
+  if (api->is_error(err))
+    return false;
+  *count = api->argon_to_i64(argv[3], err);
+  if (api->is_error(err))
+    return false;
+  if (descriptor < 0 || *offset < 0 || *count < 0) {
+    api->throw_argon_error(err, api->IndexError,
+                           "file descriptor, offset and count must not be "
+                           "negative");
+    return false;
+  }
+  *fd = (int)descriptor;
+  return true;
+}
+
+// net_recv_into(socket, buffer, offset, size): receives straight into
+// buffer[offset:offset+size]. size -1 means up to the end of the buffer.
+ARGON_FUNCTION(net_recv_into, {
+  (void)state;
+  if (api->fix_to_arg_size(4, argc, err))
+    return api->ARGON_NULL;
+
+  struct buffer socket_buf = api->argon_buffer_to_buffer(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  struct buffer region;
+  if (!recv_region(api, argv, &region, err))
+    return api->ARGON_NULL;
+
+  return api->i64_to_argon(net_recv(*(socket_t *)socket_buf.data, region.data,
+                                    (int)region.size));
+})
+
+ARGON_FUNCTION(net_sendv, {
+  (void)state;
+  if (api->fix_to_arg_size(2, argc, err))
+    return api->ARGON_NULL;
+
+  struct buffer socket_buf = api->argon_buffer_to_buffer(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  size_t count = 0;
+  net_iovec_t *parts = send_parts(api, argv[1], &count, err);
+  if (!parts)
+    return api->ARGON_NULL;
+
+  int64_t sent = net_sendv(*(socket_t *)socket_buf.data, parts, count);
+  free(parts);
+  return api->i64_to_argon(sent);
+})
+
+// net_send_file(socket, fd, offset, count)
+ARGON_FUNCTION(net_send_file, {
+  (void)state;
+  if (api->fix_to_arg_size(4, argc, err))
+    return api->ARGON_NULL;
+
+  struct buffer socket_buf = api->argon_buffer_to_buffer(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  int fd;
+  int64_t offset, count;
+  if (!file_range(api, argv, &fd, &offset, &count, err))
+    return api->ARGON_NULL;
+
+  return api->i64_to_argon(
+      net_send_file(*(socket_t *)socket_buf.data, fd, offset, count));
+})
+
 ARGON_FUNCTION(net_close, {
   (void)state;
   if (api->fix_to_arg_size(1, argc, err))
@@ -299,6 +452,345 @@ ARGON_FUNCTION(net_set_opt, {
   return api->i64_to_argon(net_set_opt(sock, (int)opt, (int)value));
 })
 
+ARGON_FUNCTION(net_fileno, {
+  (void)state;
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+
+  struct buffer socket_buf = api->argon_buffer_to_buffer(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  return api->i64_to_argon((int64_t)*(socket_t *)socket_buf.data);
+})
+
+static net_loop_t *loop_from_argon(ArgonNativeAPI *api, ArgonObject *obj,
+                                   ArgonError *err) {
+  struct buffer loop_buf = api->argon_buffer_to_buffer(obj, err);
+  if (api->is_error(err))
+    return NULL;
+  net_loop_t *loop = *(net_loop_t **)loop_buf.data;
+  if (!loop)
+    api->throw_argon_error(err, api->RuntimeError, "event loop is closed");
+  return loop;
+}
+
+// the handle holds a cell with the loop in it, emptied by loop_close, so a
+// loop that is never closed still has its epoll fd released with the handle.
+static void release_loop(void *data, size_t size) {
+  (void)size;
+  net_loop_destroy(*(net_loop_t **)data);
+  free(data);
+}
+
+ARGON_FUNCTION(loop_create, {
+  (void)state;
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+
+  net_loop_t **cell = malloc(sizeof(net_loop_t *));
+  if (!cell)
+    return api->throw_argon_error(err, api->RuntimeError, "out of memory");
+  *cell = net_loop_create();
+  if (!*cell) {
+    free(cell);
+    return api->throw_argon_error(err, argv[0],
+                                  "failed to create an event loop");
+  }
+  return api->create_argon_buffer_external(cell, sizeof(net_loop_t *),
+                                           release_loop);
+})
+
+ARGON_FUNCTION(loop_watch, {
+  (void)state;
+  if (api->fix_to_arg_size(3, argc, err))
+    return api->ARGON_NULL;
+
+  net_loop_t *loop = loop_from_argon(api, argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  int64_t fd = api->argon_to_i64(argv[1], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  int64_t events = api->argon_to_i64(argv[2], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  // a blocking send or recv on a watched socket would stall the whole loop
+  if (events && net_set_nonblocking((socket_t)fd, 1) != 0)
+    return api->i64_to_argon(-1);
+  return api->i64_to_argon(net_loop_watch(loop, (socket_t)fd, (int)events));
+})
+
+ARGON_FUNCTION(loop_timer, {
+  (void)state;
+  if (api->fix_to_arg_size(2, argc, err))
+    return api->ARGON_NULL;
+
+  net_loop_t *loop = loop_from_argon(api, argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  int64_t delay_ms = api->argon_to_i64(argv[1], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  int64_t id = net_loop_timer(loop, delay_ms);
+  if (id < 0)
+    return api->throw_argon_error(err, api->RuntimeError, "out of memory");
+  return api->i64_to_argon(id);
+})
+
+ARGON_FUNCTION(loop_cancel, {
+  (void)state;
+  if (api->fix_to_arg_size(2, argc, err))
+    return api->ARGON_NULL;
+
+  net_loop_t *loop = loop_from_argon(api, argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  int64_t id = api->argon_to_i64(argv[1], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  return net_loop_cancel(loop, id) == 0 ? api->ARGON_TRUE : api->ARGON_FALSE;
+})
+
+ARGON_FUNCTION(loop_size, {
+  (void)state;
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+
+  net_loop_t *loop = loop_from_argon(api, argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  return api->i64_to_argon((int64_t)net_loop_size(loop));
+})
+
+// returns [kind, id, readable, writable] for every event.
+ARGON_FUNCTION(loop_wait, {
+  (void)state;
+  if (api->fix_to_arg_size(3, argc, err))
+    return api->ARGON_NULL;
+
+  net_loop_t *loop = loop_from_argon(api, argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  int64_t timeout_ms = api->argon_to_i64(argv[1], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  net_loop_event_t events[256];
+  int n = net_loop_wait(loop, (int)timeout_ms, events, 256);
+  if (n < 0)
+    return api->throw_argon_error(err, argv[2], "event loop wait failed");
+
+  ArgonObject *items[256];
+  for (int i = 0; i < n; i++) {
+    ArgonObject *fields[4] = {
+        api->i64_to_argon(events[i].kind),
+        api->i64_to_argon(events[i].id),
+        events[i].events & NET_POLL_READ ? api->ARGON_TRUE : api->ARGON_FALSE,
+        events[i].events & NET_POLL_WRITE ? api->ARGON_TRUE
+                                          : api->ARGON_FALSE};
+    items[i] = api->create_argon_array(fields, 4);
+  }
+  return api->create_argon_array(items, (size_t)n);
+})
+
+ARGON_FUNCTION(loop_close, {
+  (void)state;
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+
+  struct buffer loop_buf = api->argon_buffer_to_buffer(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  net_loop_t *loop = *(net_loop_t **)loop_buf.data;
+  *(net_loop_t **)loop_buf.data = NULL;
+  net_loop_destroy(loop);
+  return api->ARGON_NULL;
+})
+
+ARGON_FUNCTION(loop_backend, {
+  (void)argv;
+  (void)state;
+  if (api->fix_to_arg_size(0, argc, err))
+    return api->ARGON_NULL;
+  return ARGON_STRING_FROM_C_STRING((char *)net_loop_backend());
+})
+
+static http_server_t *server_from_argon(ArgonNativeAPI *api, ArgonObject *obj,
+                                        ArgonError *err) {
+  struct buffer server_buf = api->argon_buffer_to_buffer(obj, err);
+  if (api->is_error(err))
+    return NULL;
+  http_server_t *server = *(http_server_t **)server_buf.data;
+  if (!server)
+    api->throw_argon_error(err, api->RuntimeError, "server is closed");
+  return server;
+}
+
+// http_server_create(port, handler, workers, keep_alive_ms,
+//                    request_timeout_ms, max_requests, max_header_size,
+//                    max_body_size, SocketError)
+ARGON_FUNCTION(http_server_create, {
+  (void)state;
+  if (api->fix_to_arg_size(9, argc, err))
+    return api->ARGON_NULL;
+
+  int64_t numbers[8];
+  for (size_t i = 0; i < 8; i++) {
+    if (i == 1)
+      continue;
+    numbers[i] = api->argon_to_i64(argv[i], err);
+    if (api->is_error(err))
+      return api->ARGON_NULL;
+  }
+  // a negative wait would make the workers' polls block forever
+  if (numbers[3] < 0 || numbers[4] < 0 || numbers[3] > INT32_MAX ||
+      numbers[4] > INT32_MAX)
+    return api->throw_argon_error(
+        err, api->RuntimeError,
+        "keep_alive_ms and request_timeout_ms must be between 0 and %d",
+        INT32_MAX);
+
+  http_server_options_t options = {
+      .workers = (int)numbers[2],
+      .keep_alive_ms = (int)numbers[3],
+      .request_timeout_ms = (int)numbers[4],
+      .max_requests = (int)numbers[5],
+      .max_header_size = (size_t)numbers[6],
+      .max_body_size = (size_t)numbers[7],
+  };
+
+  http_server_t *server =
+      http_server_create(api, (int)numbers[0], argv[1], options);
+  if (!server)
+    return api->throw_argon_error(
+        err, argv[8], "failed to listen on port %" PRId64, numbers[0]);
+
+  ArgonObject *buf_obj = api->create_argon_buffer(sizeof(http_server_t *));
+  struct buffer buf = api->argon_buffer_to_buffer(buf_obj, err);
+  if (api->is_error(err)) {
+    http_server_destroy(server);
+    return api->ARGON_NULL;
+  }
+  memcpy(buf.data, &server, buf.size);
+  return buf_obj;
+})
+
+ARGON_FUNCTION(http_server_run, {
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+
+  http_server_t *server = server_from_argon(api, argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  http_server_run(server, state);
+  return api->ARGON_NULL;
+})
+
+ARGON_FUNCTION(http_server_stop, {
+  (void)state;
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+
+  http_server_t *server = server_from_argon(api, argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  http_server_stop(server);
+  return api->ARGON_NULL;
+})
+
+ARGON_FUNCTION(http_server_port, {
+  (void)state;
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+
+  http_server_t *server = server_from_argon(api, argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  return api->i64_to_argon(http_server_port(server));
+})
+
+ARGON_FUNCTION(http_server_close, {
+  (void)state;
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+
+  struct buffer server_buf = api->argon_buffer_to_buffer(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  http_server_t *server = *(http_server_t **)server_buf.data;
+  *(http_server_t **)server_buf.data = NULL;
+  if (server)
+    http_server_destroy(server);
+  return api->ARGON_NULL;
+})
+
+// http_header_end(buffer, from, length): the offset just past the blank line
+// that ends the header block in the first length bytes of buffer, or 0. from
+// is where the last call left off, so reading a response a piece at a time
+// stays linear.
+ARGON_FUNCTION(http_header_end, {
+  (void)state;
+  if (api->fix_to_arg_size(3, argc, err))
+    return api->ARGON_NULL;
+
+  struct buffer buf = api->argon_buffer_to_buffer(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  int64_t from = api->argon_to_i64(argv[1], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  int64_t length = api->argon_to_i64(argv[2], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  if (length < 0 || (uint64_t)length > buf.size)
+    length = (int64_t)buf.size;
+  if (from < 0)
+    from = 0;
+
+  return api->i64_to_argon((int64_t)http_find_header_end(
+      buf.data, (size_t)length, (size_t)from));
+})
+
+// http_chunk_header(buffer, after_data, HTTPError): [consumed, size] for the
+// chunk-size line at the start of buffer, or null until all of it (and for
+// the last chunk, the trailers) has arrived.
+ARGON_FUNCTION(http_chunk_header, {
+  (void)state;
+  if (api->fix_to_arg_size(3, argc, err))
+    return api->ARGON_NULL;
+
+  struct buffer buf = api->argon_buffer_to_buffer(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  uint64_t size;
+  long consumed = http_chunk_header(buf.data, buf.size,
+                                    argv[1] == api->ARGON_TRUE, &size);
+  if (consumed == HTTP_INCOMPLETE)
+    return api->ARGON_NULL;
+  if (consumed < 0)
+    return api->throw_argon_error(err, argv[2], "malformed chunked encoding");
+
+  ArgonObject *fields[2] = {api->i64_to_argon(consumed),
+                            api->i64_to_argon((int64_t)size)};
+  return api->create_argon_array(fields, 2);
+})
+
 #ifndef NET_WITHOUT_TLS
 
 ARGON_FUNCTION(tls_connect, {
@@ -421,6 +913,61 @@ ARGON_FUNCTION(tls_recv_string, {
   return str_obj;
 })
 
+ARGON_FUNCTION(tls_recv_into, {
+  (void)state;
+  if (api->fix_to_arg_size(4, argc, err))
+    return api->ARGON_NULL;
+
+  struct buffer conn_buffer = api->argon_buffer_to_buffer(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  tls_conn_t *conn = conn_buffer.data;
+
+  struct buffer region;
+  if (!recv_region(api, argv, &region, err))
+    return api->ARGON_NULL;
+
+  return api->i64_to_argon(tls_recv(conn, region.data, (int)region.size));
+})
+
+ARGON_FUNCTION(tls_sendv, {
+  (void)state;
+  if (api->fix_to_arg_size(2, argc, err))
+    return api->ARGON_NULL;
+
+  struct buffer conn_buffer = api->argon_buffer_to_buffer(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  tls_conn_t *conn = conn_buffer.data;
+
+  size_t count = 0;
+  net_iovec_t *parts = send_parts(api, argv[1], &count, err);
+  if (!parts)
+    return api->ARGON_NULL;
+
+  int64_t sent = tls_sendv(conn, parts, count);
+  free(parts);
+  return api->i64_to_argon(sent);
+})
+
+ARGON_FUNCTION(tls_send_file, {
+  (void)state;
+  if (api->fix_to_arg_size(4, argc, err))
+    return api->ARGON_NULL;
+
+  struct buffer conn_buffer = api->argon_buffer_to_buffer(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  tls_conn_t *conn = conn_buffer.data;
+
+  int fd;
+  int64_t offset, count;
+  if (!file_range(api, argv, &fd, &offset, &count, err))
+    return api->ARGON_NULL;
+
+  return api->i64_to_argon(tls_send_file(conn, fd, offset, count));
+})
+
 ARGON_FUNCTION(tls_poll, {
   (void)state;
   if (api->fix_to_arg_size(4, argc, err))
@@ -445,6 +992,45 @@ ARGON_FUNCTION(tls_poll, {
       tls_poll(conn, (int)want_read, (int)want_write, (int)timeout_ms));
 })
 
+ARGON_FUNCTION(tls_fileno, {
+  (void)state;
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+
+  struct buffer conn_buffer = api->argon_buffer_to_buffer(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  tls_conn_t *conn = conn_buffer.data;
+
+  return api->i64_to_argon((int64_t)conn->sock);
+})
+
+ARGON_FUNCTION(tls_session_reused, {
+  (void)state;
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+
+  struct buffer conn_buffer = api->argon_buffer_to_buffer(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  tls_conn_t *conn = conn_buffer.data;
+
+  return tls_session_reused(conn) ? api->ARGON_TRUE : api->ARGON_FALSE;
+})
+
+ARGON_FUNCTION(tls_pending, {
+  (void)state;
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+
+  struct buffer conn_buffer = api->argon_buffer_to_buffer(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  tls_conn_t *conn = conn_buffer.data;
+
+  return api->i64_to_argon(tls_pending(conn));
+})
+
 ARGON_FUNCTION(tls_close, {
   (void)state;
   if (api->fix_to_arg_size(1, argc, err))
@@ -491,12 +1077,31 @@ void argon_module_init(ArgonState *vm, ArgonNativeAPI *api, ArgonError *err,
   REGISTER_ARGON_FUNCTION(net_send_string)
   REGISTER_ARGON_FUNCTION(net_recv)
   REGISTER_ARGON_FUNCTION(net_recv_string)
+  REGISTER_ARGON_FUNCTION(net_recv_into)
+  REGISTER_ARGON_FUNCTION(net_sendv)
+  REGISTER_ARGON_FUNCTION(net_send_file)
   REGISTER_ARGON_FUNCTION(net_close)
   REGISTER_ARGON_FUNCTION(net_connect)
   REGISTER_ARGON_FUNCTION(net_set_nonblocking)
   REGISTER_ARGON_FUNCTION(net_poll)
   REGISTER_ARGON_FUNCTION(net_peek)
   REGISTER_ARGON_FUNCTION(net_set_opt)
+  REGISTER_ARGON_FUNCTION(net_fileno)
+  REGISTER_ARGON_FUNCTION(loop_create)
+  REGISTER_ARGON_FUNCTION(loop_watch)
+  REGISTER_ARGON_FUNCTION(loop_timer)
+  REGISTER_ARGON_FUNCTION(loop_cancel)
+  REGISTER_ARGON_FUNCTION(loop_size)
+  REGISTER_ARGON_FUNCTION(loop_wait)
+  REGISTER_ARGON_FUNCTION(loop_close)
+  REGISTER_ARGON_FUNCTION(loop_backend)
+  REGISTER_ARGON_FUNCTION(http_server_create)
+  REGISTER_ARGON_FUNCTION(http_server_run)
+  REGISTER_ARGON_FUNCTION(http_server_stop)
+  REGISTER_ARGON_FUNCTION(http_server_port)
+  REGISTER_ARGON_FUNCTION(http_server_close)
+  REGISTER_ARGON_FUNCTION(http_header_end)
+  REGISTER_ARGON_FUNCTION(http_chunk_header)
   REGISTER_ARGON_FUNCTION(tls_supported)
 #ifndef NET_WITHOUT_TLS
   REGISTER_ARGON_FUNCTION(tls_connect)
@@ -504,7 +1109,13 @@ void argon_module_init(ArgonState *vm, ArgonNativeAPI *api, ArgonError *err,
   REGISTER_ARGON_FUNCTION(tls_send_string)
   REGISTER_ARGON_FUNCTION(tls_recv)
   REGISTER_ARGON_FUNCTION(tls_recv_string)
+  REGISTER_ARGON_FUNCTION(tls_recv_into)
+  REGISTER_ARGON_FUNCTION(tls_sendv)
+  REGISTER_ARGON_FUNCTION(tls_send_file)
   REGISTER_ARGON_FUNCTION(tls_poll)
+  REGISTER_ARGON_FUNCTION(tls_fileno)
+  REGISTER_ARGON_FUNCTION(tls_pending)
+  REGISTER_ARGON_FUNCTION(tls_session_reused)
   REGISTER_ARGON_FUNCTION(tls_close)
 #endif
 }
\ No newline at end of file
@@ -0,0 +1,717 @@
+// SPDX-FileCopyrightText: 2026 William Bell
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+// The server keeps Argon objects (the handler) in memory from api->malloc,
+// which the collector scans, and only touches the interpreter from threads
+// that have called register_thread.
+
+#include "http.h"
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+// how long a blocked worker goes between checks for http_server_stop
+#define HTTP_STOP_POLL_MS 200
+#define HTTP_READ_SIZE (16 * 1024)
+#define HTTP_FLUSH_SIZE (64 * 1024)
+// bodies from this size are sent from the handler's object, not copied
+#define HTTP_DIRECT_SIZE (16 * 1024)
+
+struct http_server {
+  ArgonNativeAPI *api;
+  ArgonObject *handler;
+  socket_t listener;
+  int port;
+  http_server_options_t options;
+  atomic_bool stopping;
+};
+
+typedef struct http_bytes {
+  char *data;
+  size_t length;
+  size_t capacity;
+} http_bytes_t;
+
+static bool bytes_reserve(http_bytes_t *bytes, size_t extra) {
+  if (bytes->capacity - bytes->length >= extra)
+    return true;
+  size_t capacity = bytes->capacity ? bytes->capacity : HTTP_READ_SIZE;
+  while (capacity - bytes->length < extra)
+    capacity *= 2;
+  char *data = realloc(bytes->data, capacity);
+  if (!data)
+    return false;
+  bytes->data = data;
+  bytes->capacity = capacity;
+  return true;
+}
+
+static bool bytes_append(http_bytes_t *bytes, const void *data,
+                         size_t length) {
+  if (!bytes_reserve(bytes, length))
+    return false;
+  memcpy(bytes->data + bytes->length, data, length);
+  bytes->length += length;
+  return true;
+}
+
+static bool bytes_append_string(http_bytes_t *bytes, const char *string) {
+  return bytes_append(bytes, string, strlen(string));
+}
+
+static void bytes_consume(http_bytes_t *bytes, size_t length) {
+  memmove(bytes->data, bytes->data + length, bytes->length - length);
+  bytes->length -= length;
+}
+
+http_server_t *http_server_create(ArgonNativeAPI *api, int port,
+                                  ArgonObject *handler,
+                                  http_server_options_t options) {
+  socket_t listener = net_listen(port);
+#ifdef _WIN32
+  if (listener == INVALID_SOCKET)
+#else
+  if (listener < 0)
+#endif
+    return NULL;
+
+  // workers poll the listener together, so the ones that lose the race for a
+  // connection must not block in accept.
+  net_set_nonblocking(listener, 1);
+
+  struct sockaddr_in address;
+  socklen_t address_length = sizeof(address);
+  if (getsockname(listener, (struct sockaddr *)&address, &address_length) == 0)
+    port = ntohs(address.sin_port);
+
+  http_server_t *server = api->malloc(sizeof(http_server_t));
+  server->api = api;
+  server->handler = handler;
+  server->listener = listener;
+  server->port = port;
+  server->options = options;
+  if (server->options.workers < 1)
+    server->options.workers = 1;
+  atomic_init(&server->stopping, false);
+  return server;
+}
+
+int http_server_port(http_server_t *server) { return server->port; }
+
+void http_server_stop(http_server_t *server) {
+  atomic_store(&server->stopping, true);
+}
+
+void http_server_destroy(http_server_t *server) {
+  net_close(server->listener);
+  server->api->free(server);
+}
+
+static bool send_all(socket_t s, const char *data, size_t length) {
+  while (length > 0) {
+    int chunk = length > INT32_MAX ? INT32_MAX : (int)length;
+    int sent = net_send(s, data, chunk);
+    if (sent <= 0)
+      return false;
+    data += sent;
+    length -= (size_t)sent;
+  }
+  return true;
+}
+
+static bool flush(socket_t s, http_bytes_t *out) {
+  bool sent = send_all(s, out->data, out->length);
+  out->length = 0;
+  return sent;
+}
+
+// reads more of the connection into in. gives up after idle_ms without data,
+// when the peer closes, or when the server is stopping.
+static bool receive(http_server_t *server, socket_t s, http_bytes_t *in,
+                    int idle_ms) {
+  if (!bytes_reserve(in, HTTP_READ_SIZE))
+    return false;
+
+  int waited = 0;
+  while (true) {
+    if (atomic_load(&server->stopping))
+      return false;
+    int slice = idle_ms - waited < HTTP_STOP_POLL_MS ? idle_ms - waited
+                                                     : HTTP_STOP_POLL_MS;
+    int ready = net_poll(s, 1, 0, slice);
+    if (ready < 0)
+      return false;
+    if (ready > 0)
+      break;
+    waited += slice;
+    if (waited >= idle_ms)
+      return false;
+  }
+
+  size_t room = in->capacity - in->length;
+  int n = net_recv(s, in->data + in->length,
+                   room > INT32_MAX ? INT32_MAX : (int)room);
+  if (n <= 0)
+    return false;
+  in->length += (size_t)n;
+  return true;
+}
+
+static int64_t now_ms(void) {
+#ifdef _WIN32
+  return (int64_t)GetTickCount64();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#endif
+}
+
+// how long to wait for more of the connection. between requests that's the
+// keep-alive; once a request has started it's also capped by what is left of
+// request_timeout_ms, which partial progress doesn't extend. 0 means the
+// request ran out of time.
+static int wait_budget(http_server_options_t *options, int64_t started) {
+  if (!started || options->request_timeout_ms == 0)
+    return options->keep_alive_ms;
+  int64_t left = started + options->request_timeout_ms - now_ms();
+  if (left <= 0)
+    return 0;
+  return left < options->keep_alive_ms ? (int)left : options->keep_alive_ms;
+}
+
+static void append_error(http_bytes_t *out, int status) {
+  char line[160];
+  snprintf(line, sizeof(line),
+           "HTTP/1.1 %d %s\r\nContent-Length: 0\r\nConnection: close\r\n\r\n",
+           status, http_status_text(status));
+  bytes_append_string(out, line);
+}
+
+static ArgonObject *slice_to_argon(ArgonNativeAPI *api, const char *data,
+                                   size_t length) {
+  return api->string_to_argon((struct string){(char *)data, length});
+}
+
+// the request handed to the handler: method, target, path, query, version,
+// headers (names lower cased, repeats joined with ", ") and body.
+static ArgonObject *build_request(http_server_t *server, ArgonState *state,
+                                  http_request_t *request, const char *body,
+                                  size_t body_encoded, size_t body_length,
+                                  ArgonError *err) {
+  ArgonNativeAPI *api = server->api;
+  ArgonHashmap *fields = api->create_hashmap();
+
+  api->add_to_hashmap_string_key(
+      fields, "method",
+      slice_to_argon(api, request->method.data, request->method.length));
+  api->add_to_hashmap_string_key(
+      fields, "target",
+      slice_to_argon(api, request->target.data, request->target.length));
+
+  const char *query = memchr(request->target.data, '?', request->target.length);
+  size_t path_length =
+      query ? (size_t)(query - request->target.data) : request->target.length;
+  api->add_to_hashmap_string_key(
+      fields, "path", slice_to_argon(api, request->target.data, path_length));
+  api->add_to_hashmap_string_key(
+      fields, "query",
+      query ? slice_to_argon(api, query + 1,
+                             request->target.length - path_length - 1)
+            : slice_to_argon(api, "", 0));
+
+  api->add_to_hashmap_string_key(
+      fields, "version",
+      slice_to_argon(api, request->version_minor ? "HTTP/1.1" : "HTTP/1.0",
+                     8));
+
+  ArgonHashmap *headers = api->create_hashmap();
+  char name[256];
+  for (size_t i = 0; i < request->header_count; i++) {
+    http_header_t *header = &request->headers[i];
+    size_t length = header->name.length < sizeof(name) ? header->name.length
+                                                       : sizeof(name);
+    for (size_t j = 0; j < length; j++) {
+      char c = header->name.data[j];
+      name[j] = c >= 'A' && c <= 'Z' ? (char)(c | 0x20) : c;
+    }
+    ArgonObject *key = slice_to_argon(api, name, length);
+    ArgonObject *value =
+        slice_to_argon(api, header->value.data, header->value.length);
+
+    ArgonObject *existing = api->get_from_hashmap(headers, key, state, err);
+    if (api->is_error(err))
+      return NULL;
+    if (existing) {
+      struct string before = api->argon_to_string(existing, err);
+      if (api->is_error(err))
+        return NULL;
+      size_t joined_length = before.length + 2 + header->value.length;
+      char *joined = malloc(joined_length);
+      if (!joined) {
+        api->throw_argon_error(err, api->RuntimeError, "out of memory");
+        return NULL;
+      }
+      memcpy(joined, before.data, before.length);
+      memcpy(joined + before.length, ", ", 2);
+      memcpy(joined + before.length + 2, header->value.data,
+             header->value.length);
+      value = slice_to_argon(api, joined, joined_length);
+      free(joined);
+    }
+    api->add_to_hashmap(headers, key, value, state, err);
+    if (api->is_error(err))
+      return NULL;
+  }
+  api->add_to_hashmap_string_key(fields, "headers",
+                                 api->hashmap_to_dictionary(headers));
+
+  ArgonObject *body_object = api->create_argon_buffer(body_length);
+  struct buffer body_buffer = api->argon_buffer_to_buffer(body_object, err);
+  if (api->is_error(err))
+    return NULL;
+  if (request->chunked)
+    http_chunked_copy(body, body_encoded, body_buffer.data);
+  else if (body_length)
+    memcpy(body_buffer.data, body, body_length);
+  api->add_to_hashmap_string_key(fields, "body", body_object);
+
+  return api->hashmap_to_dictionary(fields);
+}
+
+// the bytes of a string or buffer body.
+static bool body_bytes(ArgonNativeAPI *api, ArgonObject *body,
+                       struct string *out, ArgonError *err) {
+  if (body == api->ARGON_NULL) {
+    *out = (struct string){"", 0};
+    return true;
+  }
+  if (api->argon_get_ArgonType(body) == TYPE_BUFFER) {
+    struct buffer buffer = api->argon_buffer_to_buffer(body, err);
+    *out = (struct string){buffer.data, buffer.size};
+  } else {
+    *out = api->argon_to_string(body, err);
+  }
+  return !api->is_error(err);
+}
+
+static bool header_is(struct string name, const char *lower) {
+  if (name.length != strlen(lower))
+    return false;
+  for (size_t i = 0; i < name.length; i++) {
+    char c = name.data[i];
+    if ((c >= 'A' && c <= 'Z' ? (char)(c | 0x20) : c) != lower[i])
+      return false;
+  }
+  return true;
+}
+
+static bool value_is(struct string value, const char *lower) {
+  return header_is(value, lower);
+}
+
+// appends one chunk of a streamed body, framed when chunked is set.
+static bool append_chunk(http_bytes_t *out, struct string chunk,
+                         bool chunked) {
+  if (chunk.length == 0)
+    return true;
+  if (chunked) {
+    char size[24];
+    snprintf(size, sizeof(size), "%zx\r\n", chunk.length);
+    if (!bytes_append_string(out, size))
+      return false;
+  }
+  if (!bytes_append(out, chunk.data, chunk.length))
+    return false;
+  return !chunked || bytes_append(out, "\r\n", 2);
+}
+
+// writes the handler's [status, headers, body, next_chunk] to out, streaming
+// next_chunk's results straight to the socket. *keep_alive is cleared when
+// the response ends the connection. returns false if the connection broke.
+static bool write_response(http_server_t *server, ArgonState *state,
+                           socket_t s, http_request_t *request,
+                           ArgonObject *result, http_bytes_t *out,
+                           bool *keep_alive, ArgonError *err) {
+  ArgonNativeAPI *api = server->api;
+
+  struct array response = api->argon_to_array(result, err);
+  if (api->is_error(err))
+    return true;
+  if (response.size != 4) {
+    api->throw_argon_error(err, api->RuntimeError,
+                           "handler response must have 4 items");
+    return true;
+  }
+
+  int64_t status = api->argon_to_i64(response.items[0], err);
+  if (api->is_error(err))
+    return true;
+  if (status < 100 || status > 999) {
+    api->throw_argon_error(err, api->RuntimeError, "invalid status %" PRId64,
+                           status);
+    return true;
+  }
+
+  struct dictionary headers = {0};
+  if (response.items[1] != api->ARGON_NULL) {
+    headers = api->argon_to_dictionary(response.items[1], err);
+    if (api->is_error(err))
+      return true;
+  }
+
+  struct string body;
+  if (!body_bytes(api, response.items[2], &body, err))
+    return true;
+
+  ArgonObject *next_chunk = response.items[3];
+  bool streaming = next_chunk != api->ARGON_NULL;
+  bool head = request->method.length == 4 &&
+              memcmp(request->method.data, "HEAD", 4) == 0;
+  bool bodiless = head || status == 204 || status == 304 || status < 200;
+
+  char line[96];
+  snprintf(line, sizeof(line), "HTTP/1.1 %d %s\r\n", (int)status,
+           http_status_text((int)status));
+  bytes_append_string(out, line);
+
+  bool has_length = false;
+  bool has_connection = false;
+  for (size_t i = 0; i < headers.size; i++) {
+    struct string name = api->argon_to_string(headers.keys[i], err);
+    if (api->is_error(err))
+      return true;
+    struct string value = api->argon_to_string(headers.values[i], err);
+    if (api->is_error(err))
+      return true;
+    if (!http_valid_header(name.data, name.length, value.data, value.length)) {
+      api->throw_argon_error(err, api->RuntimeError,
+                             "invalid response header %.*s", (int)name.length,
+                             name.data);
+      return true;
+    }
+
+    // framing is the server's job, so the handler can't override it
+    if (header_is(name, "transfer-encoding"))
+      continue;
+    if (header_is(name, "content-length")) {
+      if (streaming)
+        continue;
+      has_length = true;
+    }
+    if (header_is(name, "connection")) {
+      has_connection = true;
+      if (value_is(value, "close"))
+        *keep_alive = false;
+    }
+    bytes_append(out, name.data, name.length);
+    bytes_append(out, ": ", 2);
+    bytes_append(out, value.data, value.length);
+    bytes_append(out, "\r\n", 2);
+  }
+
+  // HTTP/1.0 clients can't read chunked bodies, so a stream is sent raw and
+  // ended by closing the connection.
+  bool chunked = streaming && request->version_minor >= 1;
+  if (streaming && !chunked)
+    *keep_alive = false;
+
+  if (chunked && !bodiless) {
+    bytes_append_string(out, "Transfer-Encoding: chunked\r\n");
+  } else if (!streaming && !has_length && status >= 200 && status != 204 &&
+             status != 304) {
+    snprintf(line, sizeof(line), "Content-Length: %zu\r\n", body.length);
+    bytes_append_string(out, line);
+  }
+
+  if (!*keep_alive && !has_connection)
+    bytes_append_string(out, "Connection: close\r\n");
+  else if (*keep_alive && request->version_minor == 0 && !has_connection)
+    bytes_append_string(out, "Connection: keep-alive\r\n");
+  bytes_append(out, "\r\n", 2);
+
+  if (bodiless)
+    return true;
+
+  if (!chunked && body.length >= HTTP_DIRECT_SIZE) {
+    // large bodies go out next to the buffered bytes instead of through them
+    net_iovec_t parts[2] = {{out->data, out->length},
+                            {body.data, body.length}};
+    int64_t total = (int64_t)(out->length + body.length);
+    out->length = 0;
+    if (net_sendv(s, parts, 2) != total)
+      return false;
+  } else if (!append_chunk(out, body, chunked)) {
+    return false;
+  }
+
+  if (!streaming)
+    return true;
+
+  while (true) {
+    ArgonObject *chunk = api->call(next_chunk, 0, NULL, NULL, err, state);
+    if (api->is_error(err)) {
+      // the status line is already out, so all that's left is to cut the
+      // connection short.
+      *keep_alive = false;
+      flush(s, out);
+      return false;
+    }
+    if (chunk == api->ARGON_NULL)
+      break;
+    struct string bytes;
+    if (!body_bytes(api, chunk, &bytes, err)) {
+      *keep_alive = false;
+      flush(s, out);
+      return false;
+    }
+    if (!append_chunk(out, bytes, chunked))
+      return false;
+    if (out->length >= HTTP_FLUSH_SIZE && !flush(s, out))
+      return false;
+  }
+
+  if (chunked)
+    return bytes_append_string(out, "0\r\n\r\n");
+  return true;
+}
+
+// answers requests on one connection until it closes. responses to
+// pipelined requests are collected and sent together once no complete
+// request is left in the buffer.
+static void serve_connection(http_server_t *server, socket_t s,
+                             ArgonState *state) {
+  ArgonNativeAPI *api = server->api;
+  http_server_options_t *options = &server->options;
+  http_bytes_t in = {0};
+  http_bytes_t out = {0};
+  size_t scanned = 0;
+  int64_t started = 0;
+  int served = 0;
+  bool sent_continue = false;
+  bool keep_alive = true;
+
+  while (keep_alive && !atomic_load(&server->stopping)) {
+    // stray line breaks between requests are allowed and ignored
+    size_t blank = 0;
+    while (blank < in.length &&
+           (in.data[blank] == '\r' || in.data[blank] == '\n'))
+      blank++;
+    if (blank) {
+      bytes_consume(&in, blank);
+      scanned = 0;
+    }
+    if (in.length && !started)
+      started = now_ms();
+
+    size_t header_end = http_find_header_end(in.data, in.length, scanned);
+    if (!header_end) {
+      scanned = in.length;
+      if (in.length >= options->max_header_size) {
+        append_error(&out, 431);
+        break;
+      }
+      if (!flush(s, &out))
+        break;
+      int budget = wait_budget(options, started);
+      if (!budget || !receive(server, s, &in, budget)) {
+        if (started && !wait_budget(options, started))
+          append_error(&out, 408);
+        break;
+      }
+      continue;
+    }
+
+    http_request_t request;
+    long parsed = http_parse_request(in.data, header_end, &request);
+    if (parsed < 0) {
+      append_error(&out, parsed == HTTP_TOO_MANY_HEADERS ? 431 : 400);
+      break;
+    }
+
+    const char *body = in.data + header_end;
+    size_t available = in.length - header_end;
+    size_t body_encoded = 0;
+    size_t body_length = 0;
+    bool complete = true;
+
+    if (request.chunked) {
+      long length = http_chunked_length(body, available, &body_length);
+      if (length == HTTP_MALFORMED) {
+        append_error(&out, 400);
+        break;
+      }
+      if (length == HTTP_INCOMPLETE) {
+        complete = false;
+        if (available > options->max_body_size + options->max_body_size / 8 +
+                            HTTP_READ_SIZE) {
+          append_error(&out, 413);
+          break;
+        }
+      } else {
+        body_encoded = (size_t)length;
+      }
+    } else if (request.content_length > 0) {
+      if ((uint64_t)request.content_length > options->max_body_size) {
+        append_error(&out, 413);
+        break;
+      }
+      body_encoded = body_length = (size_t)request.content_length;
+      complete = available >= body_encoded;
+    }
+
+    if (complete && body_length > options->max_body_size) {
+      append_error(&out, 413);
+      break;
+    }
+
+    if (!complete) {
+      if (request.expect_continue && !sent_continue) {
+        bytes_append_string(&out, "HTTP/1.1 100 Continue\r\n\r\n");
+        sent_continue = true;
+      }
+      if (!flush(s, &out))
+        break;
+      int budget = wait_budget(options, started);
+      if (!budget || !receive(server, s, &in, budget)) {
+        if (started && !wait_budget(options, started))
+          append_error(&out, 408);
+        break;
+      }
+      continue;
+    }
+
+    served++;
+    keep_alive = request.keep_alive &&
+                 (options->max_requests == 0 || served < options->max_requests);
+
+    ArgonObject *error_object = api->create_err_object();
+    ArgonError *call_err = api->err_object_to_err(error_object, NULL);
+
+    ArgonObject *argon_request = build_request(
+        server, state, &request, body, body_encoded, body_length, call_err);
+    ArgonObject *result = NULL;
+    if (!api->is_error(call_err))
+      result = api->call(server->handler, 1, &argon_request, NULL, call_err,
+                         state);
+
+    size_t response_start = out.length;
+    bool connected = true;
+    if (!api->is_error(call_err))
+      connected = write_response(server, state, s, &request, result, &out,
+                                 &keep_alive, call_err);
+
+    if (!connected)
+      break;
+
+    if (api->is_error(call_err)) {
+      // nothing useful was written yet, so replace it with a 500
+      out.length = response_start;
+      append_error(&out, 500);
+      break;
+    }
+
+    bytes_consume(&in, header_end + body_encoded);
+    scanned = 0;
+    started = 0;
+    sent_continue = false;
+
+    if (out.length >= HTTP_FLUSH_SIZE && !flush(s, &out))
+      break;
+  }
+
+  flush(s, &out);
+  free(in.data);
+  free(out.data);
+}
+
+static void run_worker(http_server_t *server, ArgonState *state) {
+  while (!atomic_load(&server->stopping)) {
+    int ready = net_poll(server->listener, 1, 0, HTTP_STOP_POLL_MS);
+    if (ready <= 0)
+      continue;
+
+    socket_t s = net_accept(server->listener);
+#ifdef _WIN32
+    if (s == INVALID_SOCKET)
+#else
+    if (s < 0)
+#endif
+      continue;
+
+    // some platforms hand out accepted sockets non-blocking like the
+    // listener
+    net_set_nonblocking(s, 0);
+    net_set_opt(s, NET_OPT_NODELAY, 1);
+    serve_connection(server, s, state);
+    net_close(s);
+  }
+}
+
+static void worker_main(http_server_t *server) {
+  ArgonNativeAPI *api = server->api;
+  api->register_thread();
+  ArgonObject *registers = NULL;
+  ArgonState *state = api->new_state(&registers);
+  run_worker(server, state);
+  api->unregister_thread();
+}
+
+#ifdef _WIN32
+typedef HANDLE http_thread_t;
+
+static DWORD WINAPI worker_entry(LPVOID arg) {
+  worker_main(arg);
+  return 0;
+}
+
+static bool start_worker(http_thread_t *thread, http_server_t *server) {
+  *thread = CreateThread(NULL, 0, worker_entry, server, 0, NULL);
+  return *thread != NULL;
+}
+
+static void join_worker(http_thread_t thread) {
+  WaitForSingleObject(thread, INFINITE);
+  CloseHandle(thread);
+}
+#else
+typedef pthread_t http_thread_t;
+
+static void *worker_entry(void *arg) {
+  worker_main(arg);
+  return NULL;
+}
+
+static bool start_worker(http_thread_t *thread, http_server_t *server) {
+  return pthread_create(thread, NULL, worker_entry, server) == 0;
+}
+
+static void join_worker(http_thread_t thread) { pthread_join(thread, NULL); }
+#endif
+
+void http_server_run(http_server_t *server, ArgonState *state) {
+  atomic_store(&server->stopping, false);
+
+  size_t extra = (size_t)server->options.workers - 1;
+  http_thread_t *threads = extra ? calloc(extra, sizeof(http_thread_t)) : NULL;
+  size_t started = 0;
+  if (threads) {
+    while (started < extra && start_worker(&threads[started], server))
+      started++;
+  }
+
+  run_worker(server, state);
+
+  for (size_t i = 0; i < started; i++)
+    join_worker(threads[i]);
+  free(threads);
+}
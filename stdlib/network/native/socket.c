@@ -4,10 +4,12 @@
 
 #include "socket.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #ifdef _WIN32
 #include <winsock2.h>
 #include <ws2tcpip.h>
+#include <io.h>
 typedef WSAPOLLFD poll_fd_t;
 #define poll_sockets(fds, n, ms) WSAPoll((fds), (n), (ms))
 #define POLLIN 0x0100
@@ -18,14 +20,27 @@ typedef WSAPOLLFD poll_fd_t;
 #include <netdb.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h> /* TCP_NODELAY */
+#include <errno.h>
 #include <poll.h>
 #include <stdbool.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 typedef struct pollfd poll_fd_t;
 #define poll_sockets(fds, n, ms) poll((fds), (n), (ms))
 #endif
 
+#ifdef __linux__
+#include <pthread.h>
+#include <signal.h>
+#include <sys/sendfile.h>
+#endif
+
+// parts handed to one sendmsg / WSASend call
+#define NET_IOV_BATCH 64
+// read size when a file has to go through user space
+#define NET_FILE_CHUNK (64 * 1024)
+
 int net_init(void) {
 #ifdef _WIN32
   WSADATA wsa;
@@ -63,7 +78,7 @@ socket_t net_listen(int port) {
   if (bind(s, (struct sockaddr *)&addr, sizeof(addr)) < 0)
     return -1;
 
-  if (listen(s, 16) < 0)
+  if (listen(s, SOMAXCONN) < 0)
     return -1;
 
   return s;
@@ -71,15 +86,27 @@ socket_t net_listen(int port) {
 
 socket_t net_accept(socket_t server) { return accept(server, NULL, NULL); }
 
+static bool would_block(void) {
+#ifdef _WIN32
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
 int net_send(socket_t s, const void *buf, int len) {
 #ifdef _WIN32
-  return send(s, buf, len, 0);
+  int n = send(s, buf, len, 0);
 #else
-  return (int)send(s, buf, len, MSG_NOSIGNAL);
+  int n = (int)send(s, buf, len, MSG_NOSIGNAL);
 #endif
+  return n < 0 && would_block() ? NET_WOULD_BLOCK : n;
 }
 
-int net_recv(socket_t s, void *buf, int len) { return recv(s, buf, len, 0); }
+int net_recv(socket_t s, void *buf, int len) {
+  int n = recv(s, buf, len, 0);
+  return n < 0 && would_block() ? NET_WOULD_BLOCK : n;
+}
 
 void net_close(socket_t s) {
 #ifdef _WIN32
@@ -218,6 +245,184 @@ int net_set_opt(socket_t s, int opt, int value) {
   }
 }
 
+// drops the first sent bytes from parts, returning the index of the first
+// part with anything left.
+static size_t iovec_advance(net_iovec_t *parts, size_t first, size_t count,
+                            size_t sent) {
+  while (first < count && sent >= parts[first].length) {
+    sent -= parts[first].length;
+    first++;
+  }
+  if (first < count) {
+    parts[first].data = (const char *)parts[first].data + sent;
+    parts[first].length -= sent;
+  }
+  return first;
+}
+
+int64_t net_sendv(socket_t s, net_iovec_t *parts, size_t count) {
+  int64_t total = 0;
+  size_t first = iovec_advance(parts, 0, count, 0);
+
+  while (first < count) {
+#ifdef _WIN32
+    WSABUF batch[NET_IOV_BATCH];
+    DWORD n = 0;
+    for (size_t i = first; i < count && n < NET_IOV_BATCH; i++) {
+      // WSABUF lengths are 32 bit, so huge parts go over several calls
+      ULONG length = parts[i].length > 0x40000000 ? 0x40000000
+                                                  : (ULONG)parts[i].length;
+      batch[n].buf = (char *)parts[i].data;
+      batch[n].len = length;
+      n++;
+      if (length < parts[i].length)
+        break;
+    }
+    DWORD sent = 0;
+    if (WSASend(s, batch, n, &sent, 0, NULL, NULL) != 0)
+      return WSAGetLastError() == WSAEWOULDBLOCK && total ? total : -1;
+#else
+    struct iovec batch[NET_IOV_BATCH];
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    size_t n = 0;
+    for (size_t i = first; i < count && n < NET_IOV_BATCH; i++) {
+      batch[n].iov_base = (void *)parts[i].data;
+      batch[n].iov_len = parts[i].length;
+      n++;
+    }
+    message.msg_iov = batch;
+    message.msg_iovlen = n;
+    ssize_t sent = sendmsg(s, &message, MSG_NOSIGNAL);
+    if (sent < 0) {
+      if (errno == EINTR)
+        continue;
+      return (errno == EAGAIN || errno == EWOULDBLOCK) && total ? total : -1;
+    }
+#endif
+    total += (int64_t)sent;
+    first = iovec_advance(parts, first, count, (size_t)sent);
+  }
+  return total;
+}
+
+// reads up to length bytes at offset without moving the file position.
+static int64_t file_read_at(int fd, void *buf, size_t length, int64_t offset) {
+#ifdef _WIN32
+  HANDLE file = (HANDLE)_get_osfhandle(fd);
+  if (file == INVALID_HANDLE_VALUE)
+    return -1;
+  OVERLAPPED at;
+  memset(&at, 0, sizeof(at));
+  at.Offset = (DWORD)((uint64_t)offset & 0xffffffff);
+  at.OffsetHigh = (DWORD)((uint64_t)offset >> 32);
+  DWORD got = 0;
+  if (!ReadFile(file, buf, (DWORD)length, &got, &at))
+    return GetLastError() == ERROR_HANDLE_EOF ? 0 : -1;
+  return (int64_t)got;
+#else
+  ssize_t got;
+  do {
+    got = pread(fd, buf, length, (off_t)offset);
+  } while (got < 0 && errno == EINTR);
+  return (int64_t)got;
+#endif
+}
+
+// the user space path: read a chunk, send it all, repeat.
+static int64_t file_send_copied(void *conn, int (*send_fn)(void *, const void *,
+                                                          int),
+                                int fd, int64_t offset, int64_t count) {
+  char *chunk = malloc(NET_FILE_CHUNK);
+  if (!chunk)
+    return -1;
+
+  int64_t total = 0;
+  while (total < count) {
+    int64_t want = count - total < NET_FILE_CHUNK ? count - total
+                                                  : NET_FILE_CHUNK;
+    int64_t got = file_read_at(fd, chunk, (size_t)want, offset + total);
+    if (got < 0) {
+      free(chunk);
+      return -1;
+    }
+    if (got == 0)
+      break;
+
+    int64_t sent = 0;
+    while (sent < got) {
+      int n = send_fn(conn, chunk + sent, (int)(got - sent));
+      if (n <= 0) {
+        free(chunk);
+        return total + sent > 0 ? total + sent : -1;
+      }
+      sent += n;
+    }
+    total += got;
+  }
+  free(chunk);
+  return total;
+}
+
+static int socket_send_fn(void *conn, const void *buf, int len) {
+  return net_send(*(socket_t *)conn, buf, len);
+}
+
+int64_t net_send_file(socket_t s, int fd, int64_t offset, int64_t count) {
+  if (offset < 0 || count < 0)
+    return -1;
+#ifdef __linux__
+  // sendfile raises SIGPIPE on a closed socket and has no MSG_NOSIGNAL, so
+  // the signal is held off for this thread and swallowed if it came.
+  sigset_t pipe_set, previous;
+  sigemptyset(&pipe_set);
+  sigaddset(&pipe_set, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &pipe_set, &previous);
+
+  int64_t total = 0;
+  bool broken = false;
+  while (total < count) {
+    off_t at = (off_t)(offset + total);
+    size_t want = (size_t)(count - total) > 0x7ffff000
+                      ? 0x7ffff000
+                      : (size_t)(count - total);
+    ssize_t sent = sendfile(s, fd, &at, want);
+    if (sent < 0) {
+      if (errno == EINTR)
+        continue;
+      broken = errno == EPIPE;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        if (!total)
+          total = -1;
+        break;
+      }
+      if (errno == EINVAL || errno == ENOSYS) {
+        // not something sendfile can read from, such as a pipe
+        int64_t copied =
+            file_send_copied(&s, socket_send_fn, fd, offset + total,
+                             count - total);
+        total = copied < 0 ? (total ? total : -1) : total + copied;
+      } else if (!total) {
+        total = -1;
+      }
+      break;
+    }
+    if (sent == 0)
+      break;
+    total += sent;
+  }
+
+  if (broken && !sigismember(&previous, SIGPIPE)) {
+    struct timespec none = {0, 0};
+    sigtimedwait(&pipe_set, NULL, &none);
+  }
+  pthread_sigmask(SIG_SETMASK, &previous, NULL);
+  return total;
+#else
+  return file_send_copied(&s, socket_send_fn, fd, offset, count);
+#endif
+}
+
 #ifndef NET_WITHOUT_TLS
 
 #include <openssl/err.h>
@@ -322,24 +527,108 @@ static int tls_load_default_ca(SSL_CTX *ctx) {
 #endif
 }
 
-bool tls_connect(const char *host, int port, int verify_peer,
-                       const char *ca_path, tls_conn_t *conn) {
-  tls_global_init_once();
+// Connections with the same verification settings share one SSL_CTX, so the
+// trust store is loaded once instead of on every connect. The sessions
+// servers hand out (TLS 1.3 tickets arrive after the handshake) are kept per
+// host and port, and later connections resume them instead of running a full
+// handshake.
+
+#define TLS_MAX_CONTEXTS 8
+#define TLS_MAX_SESSIONS 64
+
+typedef struct tls_shared_ctx {
+  int verify_peer;
+  char *ca_path;
+  SSL_CTX *ctx;
+} tls_shared_ctx_t;
+
+typedef struct tls_cached_session {
+  char *key;
+  SSL_SESSION *session;
+} tls_cached_session_t;
+
+static tls_shared_ctx_t tls_contexts[TLS_MAX_CONTEXTS];
+static size_t tls_context_count = 0;
+static tls_cached_session_t tls_sessions[TLS_MAX_SESSIONS];
+static size_t tls_next_eviction = 0;
+static int tls_key_index = -1;
 
-  socket_t sock = net_connect(host, port);
 #ifdef _WIN32
-  if (sock == INVALID_SOCKET)
+static SRWLOCK tls_cache_lock = SRWLOCK_INIT;
+#define tls_cache_acquire() AcquireSRWLockExclusive(&tls_cache_lock)
+#define tls_cache_release() ReleaseSRWLockExclusive(&tls_cache_lock)
 #else
-  if (sock < 0)
+#include <pthread.h>
+static pthread_mutex_t tls_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+#define tls_cache_acquire() pthread_mutex_lock(&tls_cache_lock)
+#define tls_cache_release() pthread_mutex_unlock(&tls_cache_lock)
 #endif
-    return false;
 
-  const SSL_METHOD *method = TLS_client_method();
-  SSL_CTX *ctx = SSL_CTX_new(method);
-  if (!ctx) {
-    net_close(sock);
-    return false;
+static void tls_free_key(void *parent, void *key, CRYPTO_EX_DATA *data,
+                         int index, long argl, void *argp) {
+  (void)parent;
+  (void)data;
+  (void)index;
+  (void)argl;
+  (void)argp;
+  free(key);
+}
+
+// new session callback: keeps the session under the key its connection was
+// opened with. Returning 1 tells OpenSSL we took the reference.
+static int tls_remember_session(SSL *ssl, SSL_SESSION *session) {
+  const char *key = SSL_get_ex_data(ssl, tls_key_index);
+  if (!key || !SSL_SESSION_is_resumable(session))
+    return 0;
+
+  tls_cache_acquire();
+  tls_cached_session_t *slot = NULL;
+  for (size_t i = 0; i < TLS_MAX_SESSIONS && !slot; i++) {
+    if (tls_sessions[i].key && strcmp(tls_sessions[i].key, key) == 0)
+      slot = &tls_sessions[i];
+  }
+  for (size_t i = 0; i < TLS_MAX_SESSIONS && !slot; i++) {
+    if (!tls_sessions[i].key)
+      slot = &tls_sessions[i];
+  }
+  if (!slot) {
+    slot = &tls_sessions[tls_next_eviction];
+    tls_next_eviction = (tls_next_eviction + 1) % TLS_MAX_SESSIONS;
+  }
+
+  if (slot->key && strcmp(slot->key, key) != 0) {
+    free(slot->key);
+    slot->key = NULL;
+  }
+  if (!slot->key)
+    slot->key = strdup(key);
+  if (slot->session)
+    SSL_SESSION_free(slot->session);
+  int kept = slot->key != NULL;
+  slot->session = kept ? session : NULL;
+  tls_cache_release();
+
+  return kept;
+}
+
+static SSL_SESSION *tls_find_session(const char *key) {
+  SSL_SESSION *session = NULL;
+  tls_cache_acquire();
+  for (size_t i = 0; i < TLS_MAX_SESSIONS; i++) {
+    if (tls_sessions[i].key && strcmp(tls_sessions[i].key, key) == 0) {
+      session = tls_sessions[i].session;
+      SSL_SESSION_up_ref(session);
+      break;
+    }
   }
+  tls_cache_release();
+  return session;
+}
+
+static SSL_CTX *tls_new_ctx(int verify_peer, const char *ca_path) {
+  SSL_CTX *ctx = SSL_CTX_new(TLS_client_method());
+  if (!ctx)
+    return NULL;
 
   /* Modern TLS only: 1.2 minimum. */
   SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
@@ -347,20 +636,78 @@ bool tls_connect(const char *host, int port, int verify_peer,
   if (verify_peer) {
     SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER, NULL);
     int loaded = 0;
-    if (ca_path && ca_path[0]) {
+    if (ca_path) {
       loaded = SSL_CTX_load_verify_locations(ctx, ca_path, NULL) == 1;
     } else {
       loaded = tls_load_default_ca(ctx);
     }
     if (!loaded) {
       SSL_CTX_free(ctx);
-      net_close(sock);
-      return false;
+      return NULL;
     }
   } else {
     SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, NULL);
   }
 
+  SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT |
+                                          SSL_SESS_CACHE_NO_INTERNAL_STORE);
+  SSL_CTX_sess_set_new_cb(ctx, tls_remember_session);
+  return ctx;
+}
+
+// returns a context with a reference owned by the caller.
+static SSL_CTX *tls_shared_ctx(int verify_peer, const char *ca_path) {
+  tls_cache_acquire();
+  if (tls_key_index < 0)
+    tls_key_index = SSL_get_ex_new_index(0, NULL, NULL, NULL, tls_free_key);
+
+  for (size_t i = 0; i < tls_context_count; i++) {
+    tls_shared_ctx_t *shared = &tls_contexts[i];
+    bool same_ca = shared->ca_path && ca_path
+                       ? strcmp(shared->ca_path, ca_path) == 0
+                       : shared->ca_path == ca_path;
+    if (shared->verify_peer == verify_peer && same_ca) {
+      SSL_CTX_up_ref(shared->ctx);
+      tls_cache_release();
+      return shared->ctx;
+    }
+  }
+
+  SSL_CTX *ctx = tls_new_ctx(verify_peer, ca_path);
+  if (ctx && tls_context_count < TLS_MAX_CONTEXTS) {
+    char *ca_copy = ca_path ? strdup(ca_path) : NULL;
+    if (!ca_path || ca_copy) {
+      tls_contexts[tls_context_count++] =
+          (tls_shared_ctx_t){verify_peer, ca_copy, ctx};
+      SSL_CTX_up_ref(ctx);
+    }
+  }
+  tls_cache_release();
+  return ctx;
+}
+
+bool tls_connect(const char *host, int port, int verify_peer,
+                       const char *ca_path, tls_conn_t *conn) {
+  tls_global_init_once();
+
+  if (ca_path && !ca_path[0])
+    ca_path = NULL;
+  verify_peer = verify_peer ? 1 : 0;
+
+  socket_t sock = net_connect(host, port);
+#ifdef _WIN32
+  if (sock == INVALID_SOCKET)
+#else
+  if (sock < 0)
+#endif
+    return false;
+
+  SSL_CTX *ctx = tls_shared_ctx(verify_peer, ca_path);
+  if (!ctx) {
+    net_close(sock);
+    return false;
+  }
+
   SSL *ssl = SSL_new(ctx);
   if (!ssl) {
     SSL_CTX_free(ctx);
@@ -377,6 +724,22 @@ bool tls_connect(const char *host, int port, int verify_peer,
     SSL_set_verify(ssl, SSL_VERIFY_PEER, NULL);
   }
 
+  /* Sessions are only resumed by connections to the same host and port with
+   * the same verification settings as the one that got them. */
+  size_t key_size = strlen(host) + (ca_path ? strlen(ca_path) : 0) + 32;
+  char *key = malloc(key_size);
+  if (key) {
+    snprintf(key, key_size, "%d|%s|%s:%d", verify_peer, ca_path ? ca_path : "",
+             host, port);
+    SSL_SESSION *session = tls_find_session(key);
+    if (session) {
+      SSL_set_session(ssl, session);
+      SSL_SESSION_free(session);
+    }
+    if (SSL_set_ex_data(ssl, tls_key_index, key) != 1)
+      free(key);
+  }
+
   if (SSL_set_fd(ssl, (int)sock) != 1) {
     SSL_free(ssl);
     SSL_CTX_free(ctx);
@@ -397,12 +760,50 @@ bool tls_connect(const char *host, int port, int verify_peer,
   return true;
 }
 
+int64_t tls_sendv(tls_conn_t *conn, net_iovec_t *parts, size_t count) {
+  int64_t total = 0;
+  for (size_t i = 0; i < count; i++) {
+    const char *data = parts[i].data;
+    size_t left = parts[i].length;
+    while (left > 0) {
+      int n = tls_send(conn, data, left > INT32_MAX ? INT32_MAX : (int)left);
+      if (n <= 0)
+        return total ? total : -1;
+      data += n;
+      left -= (size_t)n;
+      total += n;
+    }
+  }
+  return total;
+}
+
+static int tls_send_fn(void *conn, const void *buf, int len) {
+  return tls_send(conn, buf, len);
+}
+
+int64_t tls_send_file(tls_conn_t *conn, int fd, int64_t offset,
+                      int64_t count) {
+  if (offset < 0 || count < 0)
+    return -1;
+  return file_send_copied(conn, tls_send_fn, fd, offset, count);
+}
+
+int tls_session_reused(tls_conn_t *conn) {
+  if (!conn || !conn->ssl)
+    return 0;
+  return SSL_session_reused(conn->ssl);
+}
+
 int tls_send(tls_conn_t *conn, const void *buf, int len) {
   if (!conn)
     return -1;
   int n = SSL_write(conn->ssl, buf, len);
-  if (n <= 0)
+  if (n <= 0) {
+    int reason = SSL_get_error(conn->ssl, n);
+    if (reason == SSL_ERROR_WANT_READ || reason == SSL_ERROR_WANT_WRITE)
+      return NET_WOULD_BLOCK;
     return -1;
+  }
   return n;
 }
 
@@ -414,11 +815,19 @@ int tls_recv(tls_conn_t *conn, void *buf, int len) {
     int reason = SSL_get_error(conn->ssl, n);
     if (reason == SSL_ERROR_ZERO_RETURN)
       return 0; /* clean shutdown */
+    if (reason == SSL_ERROR_WANT_READ || reason == SSL_ERROR_WANT_WRITE)
+      return NET_WOULD_BLOCK;
     return -1;
   }
   return n;
 }
 
+int tls_pending(tls_conn_t *conn) {
+  if (!conn || !conn->ssl)
+    return 0;
+  return SSL_pending(conn->ssl);
+}
+
 int tls_poll(tls_conn_t *conn, int want_read, int want_write, int timeout_ms) {
   if (!conn)
     return -1;
@@ -16,10 +16,15 @@
   typedef int socket_t;
 #endif
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 int  net_init(void);
 void net_cleanup(void);
 socket_t net_listen(int port);
+// net_send / net_recv return NET_WOULD_BLOCK when a non-blocking socket
+// isn't ready, and -1 on other errors.
+#define NET_WOULD_BLOCK (-2)
 socket_t net_accept(socket_t server);
 int  net_send(socket_t s, const void *buf, int len);
 int  net_recv(socket_t s, void *buf, int len);
@@ -48,6 +53,25 @@ int net_peek(socket_t s, void *buf, int len);
 #define NET_OPT_SNDTIMEO   5   // SO_SNDTIMEO  (value = ms)
 int net_set_opt(socket_t s, int opt, int value);
 
+// One piece of a scatter/gather send.
+typedef struct net_iovec {
+  const void *data;
+  size_t length;
+} net_iovec_t;
+
+// net_sendv: sends the parts in order with as few system calls as possible
+// (sendmsg / WSASend), without joining them first. parts is advanced in
+// place as it goes. Returns the bytes sent, which is short of the total only
+// if a non-blocking socket would block, or -1 on error.
+int64_t net_sendv(socket_t s, net_iovec_t *parts, size_t count);
+
+// net_send_file: sends count bytes of the open file descriptor fd starting at
+// offset, inside the kernel where the platform allows (sendfile on Linux).
+// The file's own position is left alone. Returns the bytes sent, short of
+// count at end of file or if a non-blocking socket would block, or -1 on
+// error.
+int64_t net_send_file(socket_t s, int fd, int64_t offset, int64_t count);
+
 // ---------------------------------------------------------------------
 // Optional TLS support (client-side only), backed by OpenSSL.
 // Compiled in only when NET_WITH_TLS is defined by the build system.
@@ -66,12 +90,15 @@ typedef struct tls_conn {
 //                    (recommended); zero disables verification entirely.
 //   ca_path       - optional path to a CA bundle (PEM) file. NULL uses the
 //                    system default trust store.
+// A session cached from an earlier connection to the same host and port is
+// resumed when the server accepts it.
 // Returns a heap-allocated tls_conn_t* on success, NULL on failure.
 bool tls_connect(const char *host, int port, int verify_peer,
                        const char *ca_path, tls_conn_t *conn);
 
 // tls_send / tls_recv: like net_send/net_recv but over the TLS session.
-// Return >0 bytes transferred, 0 on clean shutdown, <0 on error.
+// Return >0 bytes transferred, 0 on clean shutdown, NET_WOULD_BLOCK when
+// OpenSSL needs the socket to be ready first, -1 on error.
 int tls_send(tls_conn_t *conn, const void *buf, int len);
 int tls_recv(tls_conn_t *conn, void *buf, int len);
 
@@ -79,6 +106,20 @@ int tls_recv(tls_conn_t *conn, void *buf, int len);
 // readable/writable. Same bitmask semantics as net_poll.
 int tls_poll(tls_conn_t *conn, int want_read, int want_write, int timeout_ms);
 
+// tls_pending: bytes OpenSSL has already decrypted and buffered. The socket
+// won't poll readable for these, so event loops have to check it themselves.
+int tls_pending(tls_conn_t *conn);
+
+// tls_sendv / tls_send_file: net_sendv and net_send_file over the TLS
+// session. Encryption happens in user space, so the file is read through a
+// buffer rather than handed to the kernel.
+int64_t tls_sendv(tls_conn_t *conn, net_iovec_t *parts, size_t count);
+int64_t tls_send_file(tls_conn_t *conn, int fd, int64_t offset, int64_t count);
+
+// tls_session_reused: non-zero when the handshake resumed a session cached
+// from an earlier connection to the same host and port.
+int tls_session_reused(tls_conn_t *conn);
+
 // tls_close: shuts down the TLS session, closes the socket, and frees conn.
 void tls_close(tls_conn_t *conn);
 
@@ -20,6 +20,17 @@ static ArgonObject *make_string(ArgonNativeAPI *api, const char *data,
   return api->string_to_argon((struct string){(char *)data, len});
 }
 
+// Helper: the bytes to match against, from a string or a buffer such as a
+// mapped file
+static struct string subject_of(ArgonObject *obj, ArErr *err,
+                                ArgonNativeAPI *api) {
+  if (api->argon_get_ArgonType(obj) == TYPE_BUFFER) {
+    struct buffer buffer = api->argon_buffer_to_buffer(obj, err);
+    return (struct string){buffer.data, buffer.size};
+  }
+  return api->argon_to_string(obj, err);
+}
+
 // compile(pattern, RegexError) -> buffer<pcre2_code*>
 ARGON_FUNCTION(compile, {
   pcre2_code *re;
@@ -71,7 +82,7 @@ ARGON_FUNCTION(match, {
   if (!re)
     return api->ARGON_NULL;
 
-  struct string subject = api->argon_to_string(argv[1], err);
+  struct string subject = subject_of(argv[1], err, api);
   if (api->is_error(err))
     return api->ARGON_NULL;
 
@@ -90,7 +101,7 @@ ARGON_FUNCTION(find, {
   if (!re)
     return api->ARGON_NULL;
 
-  struct string subject = api->argon_to_string(argv[1], err);
+  struct string subject = subject_of(argv[1], err, api);
   if (api->is_error(err))
     return api->ARGON_NULL;
 
@@ -138,7 +149,7 @@ ARGON_FUNCTION(find_all, {
   if (!re)
     return api->ARGON_NULL;
 
-  struct string subject = api->argon_to_string(argv[1], err);
+  struct string subject = subject_of(argv[1], err, api);
   if (api->is_error(err))
     return api->ARGON_NULL;
 
@@ -204,7 +215,7 @@ ARGON_FUNCTION(replace, {
   if (!re)
     return api->ARGON_NULL;
 
-  struct string subject = api->argon_to_string(argv[1], err);
+  struct string subject = subject_of(argv[1], err, api);
   if (api->is_error(err))
     return api->ARGON_NULL;
   struct string replacement = api->argon_to_string(argv[2], err);
@@ -236,7 +247,7 @@ ARGON_FUNCTION(replace_all, {
   if (!re)
     return api->ARGON_NULL;
 
-  struct string subject = api->argon_to_string(argv[1], err);
+  struct string subject = subject_of(argv[1], err, api);
   if (api->is_error(err))
     return api->ARGON_NULL;
   struct string replacement = api->argon_to_string(argv[2], err);
@@ -269,7 +280,7 @@ ARGON_FUNCTION(split, {
   if (!re)
     return api->ARGON_NULL;
 
-  struct string subject = api->argon_to_string(argv[1], err);
+  struct string subject = subject_of(argv[1], err, api);
   if (api->is_error(err))
     return api->ARGON_NULL;
 
@@ -317,7 +328,7 @@ ARGON_FUNCTION(group, {
   if (!re)
     return api->ARGON_NULL;
 
-  struct string subject = api->argon_to_string(argv[1], err);
+  struct string subject = subject_of(argv[1], err, api);
   if (api->is_error(err))
     return api->ARGON_NULL;
 
@@ -3,29 +3,20 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "Argon.h"
+#include "ArgonTypes.h"
 
 #include "../../file/native/handle.h"
+#include "process.h"
 
+#include <inttypes.h>
 #include <stdlib.h>
 #include <string.h>
-#ifdef _WIN32
-#include <windows.h>
-#include <io.h>
-#else
-#include <sys/wait.h>
-#include <unistd.h>
-#endif
-
-typedef struct {
-#ifdef _WIN32
-  HANDLE process;
-#else
-  pid_t pid;
-#endif
 
-  bool waited;
-  int exit_code;
-} ProcessHandle;
+// stream arguments that aren't files, matching PIPE, DEVNULL and STDOUT in
+// init.ar
+#define STREAM_PIPE (-1)
+#define STREAM_DEVNULL (-2)
+#define STREAM_STDOUT (-3)
 
 static char **argon_array_to_argv(ArgonNativeAPI *api, ArgonObject *array_obj,
                                   ArgonError *err) {
@@ -34,15 +25,19 @@ static char **argon_array_to_argv(ArgonNativeAPI *api, ArgonObject *array_obj,
   if (api->is_error(err))
     return NULL;
 
-  char **argv = malloc(sizeof(char *) * (array.size + 1));
+  char **argv = calloc(array.size + 1, sizeof(char *));
 
-  if (!argv)
+  if (!argv) {
+    api->throw_argon_error(err, api->RuntimeError, "out of memory");
     return NULL;
+  }
 
   for (size_t i = 0; i < array.size; i++) {
     struct string str = api->argon_to_string(array.items[i], err);
 
     if (api->is_error(err)) {
+      for (size_t j = 0; j < i; j++)
+        free(argv[j]);
       free(argv);
       return NULL;
     }
@@ -68,165 +63,425 @@ static void free_argv(char **argv) {
 
   free(argv);
 }
+
+static bool stream_from_argon(ArgonNativeAPI *api, ArgonObject *object,
+                              process_stream_t *stream, ArgonError *err) {
+  if (api->argon_is_i64(object)) {
+    int64_t kind = api->argon_to_i64(object, err);
+    if (kind == STREAM_PIPE)
+      stream->kind = PROCESS_PIPE;
+    else if (kind == STREAM_DEVNULL)
+      stream->kind = PROCESS_DEVNULL;
+    else if (kind == STREAM_STDOUT)
+      stream->kind = PROCESS_STDOUT;
+    else {
+      api->throw_argon_error(err, api->TypeError, "unknown stream %" PRId64,
+                             kind);
+      return false;
+    }
+    return true;
+  }
+
+  struct buffer handle_buffer = api->argon_buffer_to_buffer(object, err);
+  if (api->is_error(err))
+    return false;
+
+  FileHandle *handle = (FileHandle *)handle_buffer.data;
+  stream->kind = handle->type != FILE_NULL ? PROCESS_FILE : PROCESS_INHERIT;
+  stream->file = handle->fp;
+  return true;
+}
+
+static process_t *process_from_argon(ArgonNativeAPI *api, ArgonObject *object,
+                                     ArgonError *err) {
+  struct buffer process_buffer = api->argon_buffer_to_buffer(object, err);
+
+  if (api->is_error(err))
+    return NULL;
+
+  return (process_t *)process_buffer.data;
+}
+
+static void release_process(void *data, size_t size) {
+  (void)size;
+  process_release((process_t *)data);
+  free(data);
+}
+
+static void release_capture(void *data, size_t size) {
+  (void)size;
+  free(data);
+}
+
+// hands over what has been captured from pipe which, as a string when text
+// is set and otherwise as a buffer over the capture itself.
+static ArgonObject *take_capture(ArgonNativeAPI *api, process_t *process,
+                                 int which, bool text) {
+  process_capture_t *capture = &process->captured[which];
+
+  if (text || capture->length == 0) {
+    ArgonObject *result =
+        text ? api->string_to_argon((struct string){capture->data,
+                                                    capture->length})
+             : api->create_argon_buffer(0);
+    free(capture->data);
+    *capture = (process_capture_t){NULL, 0, 0};
+    return result;
+  }
+
+  ArgonObject *result = api->create_argon_buffer_external(
+      capture->data, capture->length, release_capture);
+  *capture = (process_capture_t){NULL, 0, 0};
+  return result;
+}
+
+static bool stdin_open(process_t *process) {
+#ifdef _WIN32
+  return process->pipes[0] != NULL;
+#else
+  return process->pipes[0] >= 0;
+#endif
+}
+
+// pumps until input has all gone into the stdin pipe or the child closed it,
+// collecting output on the way so neither side can stall the other.
+static bool feed_input(ArgonNativeAPI *api, process_t *process,
+                       const char *data, size_t length, ArgonError *err) {
+  process->input = data;
+  process->input_length = length;
+  process->input_written = 0;
+
+  while (stdin_open(process) &&
+         process->input_written < process->input_length) {
+    if (process_pump(&process, 1, -1) < 0) {
+      api->throw_argon_error(err, api->RuntimeError,
+                             "failed to wait for the process");
+      break;
+    }
+  }
+
+  process->input = NULL;
+  process->input_length = 0;
+  return !api->is_error(err);
+}
+
+static bool data_from_argon(ArgonNativeAPI *api, ArgonObject *object,
+                            const char **data, size_t *length,
+                            ArgonError *err) {
+  if (api->argon_get_ArgonType(object) == TYPE_BUFFER) {
+    struct buffer buffer = api->argon_buffer_to_buffer(object, err);
+    *data = buffer.data;
+    *length = buffer.size;
+  } else {
+    struct string string = api->argon_to_string(object, err);
+    *data = string.data;
+    *length = string.length;
+  }
+  return !api->is_error(err);
+}
+
+// process_start(args, stdin, stdout, stderr, env, cwd, SubprocessError).
+// the streams are file handles or STREAM_* values; env is null or an array
+// of "NAME=value" strings.
 ARGON_FUNCTION(process_start, {
-  if (api->fix_to_arg_size(5, argc, err))
+  if (api->fix_to_arg_size(7, argc, err))
     return api->ARGON_NULL;
 
+  process_stream_t streams[3];
+  memset(streams, 0, sizeof(streams));
+  for (int i = 0; i < 3; i++) {
+    if (!stream_from_argon(api, argv[i + 1], &streams[i], err))
+      return api->ARGON_NULL;
+  }
+  if (streams[0].kind == PROCESS_STDOUT || streams[1].kind == PROCESS_STDOUT)
+    return api->throw_argon_error(err, api->TypeError,
+                                  "only stderr can be sent to stdout");
+
   char **process_args = argon_array_to_argv(api, argv[0], err);
 
   if (api->is_error(err))
     return api->ARGON_NULL;
 
-  struct buffer stdin_buffer = api->argon_buffer_to_buffer(argv[1], err);
-  struct buffer stdout_buffer = api->argon_buffer_to_buffer(argv[2], err);
-  struct buffer stderr_buffer = api->argon_buffer_to_buffer(argv[3], err);
-  char* cwd = NULL;
+  if (!process_args[0]) {
+    free_argv(process_args);
+    return api->throw_argon_error(err, argv[6], "no program to run");
+  }
+
+  char **env = NULL;
   if (argv[4] != api->ARGON_NULL) {
-    cwd = api->argon_to_string(argv[4], err).data;
-    if (api->is_error(err)) return api->ARGON_NULL;
+    env = argon_array_to_argv(api, argv[4], err);
+    if (api->is_error(err)) {
+      free_argv(process_args);
+      return api->ARGON_NULL;
+    }
+  }
+
+  char *cwd = NULL;
+  if (argv[5] != api->ARGON_NULL) {
+    struct string cwd_string = api->argon_to_string(argv[5], err);
+    if (api->is_error(err)) {
+      free_argv(process_args);
+      free_argv(env);
+      return api->ARGON_NULL;
+    }
+    cwd = malloc(cwd_string.length + 1);
+    memcpy(cwd, cwd_string.data, cwd_string.length);
+    cwd[cwd_string.length] = '\0';
+  }
+
+  process_t *process = calloc(1, sizeof(process_t));
+  int error = process ? process_spawn(process, process_args, streams, env, cwd)
+                      : -1;
+
+  ArgonObject *result = api->ARGON_NULL;
+  if (!process) {
+    api->throw_argon_error(err, api->RuntimeError, "out of memory");
+  } else if (error) {
+    api->throw_argon_error(err, argv[6], "failed to start '%s': %s",
+                           process_args[0], process_error_text(error));
+    free(process);
+  } else {
+    result = api->create_argon_buffer_external(process, sizeof(process_t),
+                                               release_process);
   }
 
-  FileHandle *stdin_handle = (FileHandle *)stdin_buffer.data;
-  FileHandle *stdout_handle = (FileHandle *)stdout_buffer.data;
-  FileHandle *stderr_handle = (FileHandle *)stderr_buffer.data;
+  free_argv(process_args);
+  free_argv(env);
+  free(cwd);
+  return result;
+})
 
-  ArgonObject *process = api->create_argon_buffer(sizeof(ProcessHandle));
+ARGON_FUNCTION(process_pid, {
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
 
-  struct buffer process_buffer = api->argon_buffer_to_buffer(process, err);
+  process_t *process = process_from_argon(api, argv[0], err);
 
-  ProcessHandle *handle = (ProcessHandle *)process_buffer.data;
+  if (!process)
+    return api->ARGON_NULL;
 
-#ifdef _WIN32
+  return api->i64_to_argon((int64_t)process->pid);
+})
 
-  STARTUPINFOA si;
-  PROCESS_INFORMATION pi;
+// process_poll(process) -> the exit code, or null while it is still running.
+ARGON_FUNCTION(process_poll, {
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+
+  process_t *process = process_from_argon(api, argv[0], err);
 
-  memset(&si, 0, sizeof(si));
-  memset(&pi, 0, sizeof(pi));
+  if (!process || !process_reap(process, false))
+    return api->ARGON_NULL;
 
-  si.cb = sizeof(si);
+  return api->i64_to_argon(process->exit_code);
+})
 
-  si.dwFlags |= STARTF_USESTDHANDLES;
+// process_wait(process) -> exit code. piped output is collected while
+// waiting, so a child with a lot to say can't block on a full pipe.
+ARGON_FUNCTION(process_wait, {
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
 
-  si.hStdInput = stdin_handle->type != FILE_NULL
-                     ? (HANDLE)_get_osfhandle(fileno(stdin_handle->fp))
-                     : GetStdHandle(STD_INPUT_HANDLE);
+  process_t *process = process_from_argon(api, argv[0], err);
 
-  si.hStdOutput = stdout_handle->type != FILE_NULL
-                      ? (HANDLE)_get_osfhandle(fileno(stdout_handle->fp))
-                      : GetStdHandle(STD_OUTPUT_HANDLE);
+  if (!process)
+    return api->ARGON_NULL;
 
-  si.hStdError = stderr_handle->type != FILE_NULL
-                     ? (HANDLE)_get_osfhandle(fileno(stderr_handle->fp))
-                     : GetStdHandle(STD_ERROR_HANDLE);
+  if (process_wait_any(&process, 1, -1) < 0)
+    return api->throw_argon_error(err, api->RuntimeError,
+                                  "failed to wait for the process");
 
-  // Windows wants a single command line, not argv[]
-  size_t cmd_len = 0;
+  return api->i64_to_argon(process->exit_code);
+})
 
-  for (size_t i = 0; process_args[i]; i++)
-    cmd_len += strlen(process_args[i]) + 3;
+// process_communicate(process, input) -> exit code. writes input (null for
+// none) to the stdin pipe, closes it and waits with output collected.
+ARGON_FUNCTION(process_communicate, {
+  if (api->fix_to_arg_size(2, argc, err))
+    return api->ARGON_NULL;
 
-  char *cmdline = malloc(cmd_len + 1);
+  process_t *process = process_from_argon(api, argv[0], err);
 
-  cmdline[0] = '\0';
+  if (!process)
+    return api->ARGON_NULL;
 
-  for (size_t i = 0; process_args[i]; i++) {
-    strcat(cmdline, "\"");
-    strcat(cmdline, process_args[i]);
-    strcat(cmdline, "\" ");
+  if (argv[1] != api->ARGON_NULL) {
+    const char *data;
+    size_t length;
+    if (!data_from_argon(api, argv[1], &data, &length, err) ||
+        !feed_input(api, process, data, length, err))
+      return api->ARGON_NULL;
   }
+  process_close_stream(process, 0);
 
-  BOOL ok =
-      CreateProcessA(NULL, cmdline, NULL, NULL, TRUE, 0, NULL, cwd, &si, &pi);
+  if (process_wait_any(&process, 1, -1) < 0)
+    return api->throw_argon_error(err, api->RuntimeError,
+                                  "failed to wait for the process");
 
-  free(cmdline);
+  return api->i64_to_argon(process->exit_code);
+})
 
-  if (!ok) {
-    free_argv(process_args);
+// process_output(process, which, text) -> everything collected from stdout
+// (1) or stderr (2) so far.
+ARGON_FUNCTION(process_output, {
+  if (api->fix_to_arg_size(3, argc, err))
     return api->ARGON_NULL;
-  }
 
-  CloseHandle(pi.hThread);
+  process_t *process = process_from_argon(api, argv[0], err);
 
-  handle->process = pi.hProcess;
+  if (!process)
+    return api->ARGON_NULL;
 
-#else
+  int64_t which = api->argon_to_i64(argv[1], err);
 
-  pid_t pid = fork();
+  if (api->is_error(err))
+    return api->ARGON_NULL;
 
-  if (pid == 0) {
-    if (cwd && chdir(cwd) == -1)
-        _exit(127);
+  return take_capture(api, process, which == 2 ? 2 : 1,
+                      argv[2] == api->ARGON_TRUE);
+})
 
-    if (stdin_handle->type != FILE_NULL)
-      dup2(fileno(stdin_handle->fp), STDIN_FILENO);
+// process_read(process, which, size, text) -> up to size bytes from stdout
+// (1) or stderr (2) without blocking. empty when nothing has arrived yet and
+// null once the stream has ended.
+ARGON_FUNCTION(process_read, {
+  if (api->fix_to_arg_size(4, argc, err))
+    return api->ARGON_NULL;
 
-    if (stdout_handle->type != FILE_NULL)
-      dup2(fileno(stdout_handle->fp), STDOUT_FILENO);
+  process_t *process = process_from_argon(api, argv[0], err);
 
-    if (stderr_handle->type != FILE_NULL)
-      dup2(fileno(stderr_handle->fp), STDERR_FILENO);
+  if (!process)
+    return api->ARGON_NULL;
 
-    execvp(process_args[0], process_args);
+  int64_t which = api->argon_to_i64(argv[1], err);
+  int64_t size = api->argon_to_i64(argv[2], err);
 
-    exit(127);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  which = which == 2 ? 2 : 1;
+  bool text = argv[3] == api->ARGON_TRUE;
+  process_capture_t *capture = &process->captured[which];
+
+  if (size <= 0)
+    return text ? ARGON_STRING_FROM_C_STRING("") : api->create_argon_buffer(0);
+
+  // output collected by an earlier wait or write goes first
+  if (capture->length) {
+    size_t length = capture->length < (size_t)size ? capture->length
+                                                   : (size_t)size;
+    ArgonObject *result;
+    if (text) {
+      result = api->string_to_argon((struct string){capture->data, length});
+    } else {
+      result = api->create_argon_buffer(length);
+      memcpy(api->argon_buffer_to_buffer(result, err).data, capture->data,
+             length);
+    }
+    memmove(capture->data, capture->data + length, capture->length - length);
+    capture->length -= length;
+    return result;
   }
 
-  handle->pid = pid;
+  char *data = malloc((size_t)size);
 
-#endif
+  if (!data)
+    return api->throw_argon_error(err, api->RuntimeError, "out of memory");
 
-  free_argv(process_args);
+  long got = process_read(process, (int)which, data, (size_t)size);
 
-  handle->waited = false;
-  handle->exit_code = -1;
+  ArgonObject *result;
+  if (got == 0) {
+    result = api->ARGON_NULL;
+  } else if (got < 0) {
+    result = text ? ARGON_STRING_FROM_C_STRING("") : api->create_argon_buffer(0);
+  } else if (text) {
+    result = api->string_to_argon((struct string){data, (size_t)got});
+  } else {
+    result = api->create_argon_buffer((size_t)got);
+    memcpy(api->argon_buffer_to_buffer(result, err).data, data, (size_t)got);
+  }
 
-  return process;
+  free(data);
+  return result;
 })
 
-ARGON_FUNCTION(process_wait, {
-  if (api->fix_to_arg_size(1, argc, err))
+// process_write(process, data, SubprocessError) -> bytes written to the
+// stdin pipe, which may be short if the child closed it.
+ARGON_FUNCTION(process_write, {
+  if (api->fix_to_arg_size(3, argc, err))
     return api->ARGON_NULL;
 
-  struct buffer process_buffer = api->argon_buffer_to_buffer(argv[0], err);
+  process_t *process = process_from_argon(api, argv[0], err);
 
-  if (api->is_error(err))
+  if (!process)
     return api->ARGON_NULL;
 
-  ProcessHandle *handle = (ProcessHandle *)process_buffer.data;
+  if (!stdin_open(process))
+    return api->throw_argon_error(err, argv[2], "stdin is not an open pipe");
 
-  if (handle->waited)
-    return api->i64_to_argon(handle->exit_code);
+  const char *data;
+  size_t length;
+  if (!data_from_argon(api, argv[1], &data, &length, err) ||
+      !feed_input(api, process, data, length, err))
+    return api->ARGON_NULL;
 
-#ifdef _WIN32
+  return api->i64_to_argon((int64_t)process->input_written);
+})
 
-  WaitForSingleObject(handle->process, INFINITE);
+ARGON_FUNCTION(process_close_stdin, {
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
 
-  DWORD code;
+  process_t *process = process_from_argon(api, argv[0], err);
 
-  if (GetExitCodeProcess(handle->process, &code)) {
-    handle->exit_code = (int)code;
-  } else {
-    handle->exit_code = -1;
-  }
+  if (!process)
+    return api->ARGON_NULL;
 
-  CloseHandle(handle->process);
+  process_close_stream(process, 0);
+  return api->ARGON_NULL;
+})
 
-#else
+// process_wait_any(processes, timeout_ms) -> the index of a process that has
+// exited with its output collected, or -1 if timeout_ms (-1 for no limit)
+// passed first.
+ARGON_FUNCTION(process_wait_any, {
+  if (api->fix_to_arg_size(2, argc, err))
+    return api->ARGON_NULL;
 
-  int status;
+  struct array items = api->argon_to_array(argv[0], err);
+  int64_t timeout_ms = api->argon_to_i64(argv[1], err);
 
-  if (waitpid(handle->pid, &status, 0) == -1)
+  if (api->is_error(err))
     return api->ARGON_NULL;
 
-  if (WIFEXITED(status))
-    handle->exit_code = WEXITSTATUS(status);
+  if (items.size == 0)
+    return api->i64_to_argon(-1);
 
-#endif
+  process_t **processes = malloc(items.size * sizeof(process_t *));
+
+  if (!processes)
+    return api->throw_argon_error(err, api->RuntimeError, "out of memory");
 
-  handle->waited = true;
+  for (size_t i = 0; i < items.size; i++) {
+    processes[i] = process_from_argon(api, items.items[i], err);
+    if (!processes[i]) {
+      free(processes);
+      return api->ARGON_NULL;
+    }
+  }
 
-  return api->i64_to_argon(handle->exit_code);
+  int index = process_wait_any(processes, items.size,
+                               timeout_ms < 0           ? -1
+                               : timeout_ms > INT32_MAX ? INT32_MAX
+                                                        : (int)timeout_ms);
+  free(processes);
+
+  if (index == -2)
+    return api->throw_argon_error(err, api->RuntimeError,
+                                  "failed to wait for the processes");
+
+  return api->i64_to_argon(index);
 })
 
 void argon_module_init(ArgonState *vm, ArgonNativeAPI *api, ArgonError *err,
@@ -234,5 +489,13 @@ void argon_module_init(ArgonState *vm, ArgonNativeAPI *api, ArgonError *err,
   (void)vm;
   (void)err;
   REGISTER_ARGON_FUNCTION(process_start)
+  REGISTER_ARGON_FUNCTION(process_pid)
+  REGISTER_ARGON_FUNCTION(process_poll)
   REGISTER_ARGON_FUNCTION(process_wait)
-}
\ No newline at end of file
+  REGISTER_ARGON_FUNCTION(process_communicate)
+  REGISTER_ARGON_FUNCTION(process_output)
+  REGISTER_ARGON_FUNCTION(process_read)
+  REGISTER_ARGON_FUNCTION(process_write)
+  REGISTER_ARGON_FUNCTION(process_close_stdin)
+  REGISTER_ARGON_FUNCTION(process_wait_any)
+}
@@ -0,0 +1,861 @@
+// SPDX-FileCopyrightText: 2026 William Bell
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef _WIN32
+#define _GNU_SOURCE
+#endif
+#include "process.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#ifdef __APPLE__
+#include <crt_externs.h>
+#define environ (*_NSGetEnviron())
+#elif !defined(_WIN32)
+extern char **environ;
+#endif
+
+// how much is asked of a pipe per read
+#define PROCESS_READ_CHUNK (64 * 1024)
+
+// posix_spawn can only change directory through this extension; without it
+// a child that needs a cwd is started with fork instead.
+#if defined(__GLIBC__) &&                                                      \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+#define PROCESS_SPAWN_CHDIR posix_spawn_file_actions_addchdir_np
+#elif defined(__APPLE__)
+#define PROCESS_SPAWN_CHDIR posix_spawn_file_actions_addchdir_np
+#endif
+
+static int64_t process_now_ms(void) {
+#ifdef _WIN32
+  return (int64_t)GetTickCount64();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#endif
+}
+
+// makes room for at least PROCESS_READ_CHUNK more bytes.
+static bool capture_reserve(process_capture_t *capture) {
+  if (capture->capacity - capture->length >= PROCESS_READ_CHUNK)
+    return true;
+  size_t capacity = capture->capacity ? capture->capacity * 2 : 0;
+  if (capacity < capture->length + PROCESS_READ_CHUNK)
+    capacity = capture->length + PROCESS_READ_CHUNK;
+  char *data = realloc(capture->data, capacity);
+  if (!data)
+    return false;
+  capture->data = data;
+  capture->capacity = capacity;
+  return true;
+}
+
+// whether an "A=b" entry and a "A=c" entry name the same variable.
+static bool same_variable(const char *a, const char *b) {
+  const char *a_end = strchr(a, '=');
+  const char *b_end = strchr(b, '=');
+  size_t a_length = a_end ? (size_t)(a_end - a) : strlen(a);
+  size_t b_length = b_end ? (size_t)(b_end - b) : strlen(b);
+  if (a_length != b_length)
+    return false;
+#ifdef _WIN32
+  // environment names are case insensitive on Windows
+  return _strnicmp(a, b, a_length) == 0;
+#else
+  return memcmp(a, b, a_length) == 0;
+#endif
+}
+
+// the parent's entries that env doesn't override, followed by env. The
+// strings are borrowed, only the array is allocated.
+static char **merge_environment(char **parent, char **env) {
+  size_t parent_count = 0, env_count = 0;
+  while (parent[parent_count])
+    parent_count++;
+  while (env[env_count])
+    env_count++;
+
+  char **merged = malloc((parent_count + env_count + 1) * sizeof(char *));
+  if (!merged)
+    return NULL;
+
+  size_t n = 0;
+  for (size_t i = 0; i < parent_count; i++) {
+    bool overridden = false;
+    for (size_t j = 0; j < env_count && !overridden; j++)
+      overridden = same_variable(parent[i], env[j]);
+    if (!overridden)
+      merged[n++] = parent[i];
+  }
+  for (size_t j = 0; j < env_count; j++)
+    merged[n++] = env[j];
+  merged[n] = NULL;
+  return merged;
+}
+
+bool process_done(process_t *process) {
+  for (int which = 1; which <= 2; which++) {
+#ifdef _WIN32
+    if (process->pipes[which])
+      return false;
+#else
+    if (process->pipes[which] >= 0)
+      return false;
+#endif
+  }
+  return process_reap(process, false);
+}
+
+int process_wait_any(process_t **processes, size_t count, int timeout_ms) {
+  int64_t deadline = timeout_ms < 0 ? -1 : process_now_ms() + timeout_ms;
+  while (true) {
+    for (size_t i = 0; i < count; i++) {
+      if (process_done(processes[i]))
+        return (int)i;
+    }
+
+    int wait_ms = -1;
+    if (deadline >= 0) {
+      int64_t remaining = deadline - process_now_ms();
+      if (remaining <= 0)
+        return -1;
+      wait_ms = remaining > INT32_MAX ? INT32_MAX : (int)remaining;
+    }
+    if (process_pump(processes, count, wait_ms) < 0)
+      return -2;
+  }
+}
+
+#ifndef _WIN32
+
+const char *process_error_text(int error) { return strerror(error); }
+
+static int open_pipe(int fds[2]) {
+#ifdef __linux__
+  return pipe2(fds, O_CLOEXEC);
+#else
+  if (pipe(fds) != 0)
+    return -1;
+  fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+  fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+  return 0;
+#endif
+}
+
+static void close_fd(int *fd) {
+  if (*fd >= 0) {
+    close(*fd);
+    *fd = -1;
+  }
+}
+
+// the descriptor the child should see as stream i, or -1 to leave it alone.
+// -2 stands for the null device and -3 for the child's stdout.
+static int child_descriptor(process_stream_t stream, int piped) {
+  switch (stream.kind) {
+  case PROCESS_FILE:
+    return fileno(stream.file);
+  case PROCESS_PIPE:
+    return piped;
+  case PROCESS_DEVNULL:
+    return -2;
+  case PROCESS_STDOUT:
+    return -3;
+  default:
+    return -1;
+  }
+}
+
+#ifndef PROCESS_SPAWN_CHDIR
+// fork/exec for when posix_spawn can't set the working directory.
+static int process_fork_spawn(pid_t *pid, char **args, int child_fds[3],
+                              char **envp, const char *cwd) {
+  int status_pipe[2];
+  if (open_pipe(status_pipe) != 0)
+    return errno;
+
+  pid_t child = fork();
+  if (child < 0) {
+    int error = errno;
+    close(status_pipe[0]);
+    close(status_pipe[1]);
+    return error;
+  }
+
+  if (child == 0) {
+    int error = 0;
+    if (chdir(cwd) != 0)
+      error = errno;
+    for (int i = 0; i < 3 && !error; i++) {
+      int fd = child_fds[i];
+      if (fd == -2)
+        fd = open("/dev/null", O_RDWR);
+      else if (fd == -3)
+        fd = STDOUT_FILENO;
+      if (fd == -1)
+        continue;
+      if (fd < 0 || dup2(fd, i) < 0)
+        error = errno;
+    }
+    if (!error) {
+      environ = envp;
+      execvp(args[0], args);
+      error = errno;
+    }
+    // the parent reads why exec didn't happen from the status pipe
+    (void)!write(status_pipe[1], &error, sizeof(error));
+    _exit(127);
+  }
+
+  close(status_pipe[1]);
+  int error = 0;
+  ssize_t got;
+  do {
+    got = read(status_pipe[0], &error, sizeof(error));
+  } while (got < 0 && errno == EINTR);
+  close(status_pipe[0]);
+
+  if (got == sizeof(error)) {
+    waitpid(child, NULL, 0);
+    return error;
+  }
+  *pid = child;
+  return 0;
+}
+#endif
+
+static int posix_spawn_process(pid_t *pid, char **args, int child_fds[3],
+                               char **envp, const char *cwd) {
+  // posix_spawn starts the child without copying the parent's page tables
+  // (glibc clones with CLONE_VFORK), which matters with a large heap and
+  // when starting many short lived processes.
+  posix_spawn_file_actions_t actions;
+  posix_spawnattr_t attributes;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawnattr_init(&attributes);
+
+#ifdef PROCESS_SPAWN_CHDIR
+  if (cwd)
+    PROCESS_SPAWN_CHDIR(&actions, cwd);
+#else
+  (void)cwd;
+#endif
+  for (int i = 0; i < 3; i++) {
+    if (child_fds[i] == -2)
+      posix_spawn_file_actions_addopen(&actions, i, "/dev/null", O_RDWR, 0);
+    else if (child_fds[i] == -3)
+      posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, i);
+    else if (child_fds[i] >= 0)
+      posix_spawn_file_actions_adddup2(&actions, child_fds[i], i);
+  }
+
+  // children start with every signal unblocked and SIGPIPE back to its
+  // default, whatever the interpreter's threads have set.
+  sigset_t signals;
+  sigemptyset(&signals);
+  posix_spawnattr_setsigmask(&attributes, &signals);
+  sigaddset(&signals, SIGPIPE);
+  posix_spawnattr_setsigdefault(&attributes, &signals);
+  posix_spawnattr_setflags(&attributes,
+                           POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+  int error = posix_spawnp(pid, args[0], &actions, &attributes, args, envp);
+
+  posix_spawn_file_actions_destroy(&actions);
+  posix_spawnattr_destroy(&attributes);
+  return error;
+}
+
+int process_spawn(process_t *process, char **args, process_stream_t streams[3],
+                  char **env, const char *cwd) {
+  process->pid = -1;
+  process->pidfd = -1;
+  for (int i = 0; i < 3; i++)
+    process->pipes[i] = -1;
+
+  int child_fds[3];
+  int child_ends[3] = {-1, -1, -1};
+  int error = 0;
+
+  for (int i = 0; i < 3 && !error; i++) {
+    if (streams[i].kind == PROCESS_FILE)
+      fflush(streams[i].file);
+
+    if (streams[i].kind == PROCESS_PIPE) {
+      int fds[2];
+      if (open_pipe(fds) != 0) {
+        error = errno;
+        break;
+      }
+      // stdin is written by the parent, stdout and stderr read
+      process->pipes[i] = i == 0 ? fds[1] : fds[0];
+      child_ends[i] = i == 0 ? fds[0] : fds[1];
+      fcntl(process->pipes[i], F_SETFL,
+            fcntl(process->pipes[i], F_GETFL) | O_NONBLOCK);
+    }
+    child_fds[i] = child_descriptor(streams[i], child_ends[i]);
+  }
+
+  char **envp = environ;
+  if (!error && env) {
+    envp = merge_environment(environ, env);
+    if (!envp)
+      error = ENOMEM;
+  }
+
+  if (!error) {
+#ifndef PROCESS_SPAWN_CHDIR
+    if (cwd)
+      error = process_fork_spawn(&process->pid, args, child_fds, envp, cwd);
+    else
+#endif
+      error = posix_spawn_process(&process->pid, args, child_fds, envp, cwd);
+  }
+
+  if (envp != environ)
+    free(envp);
+  for (int i = 0; i < 3; i++)
+    close_fd(&child_ends[i]);
+
+  if (error) {
+    for (int i = 0; i < 3; i++)
+      close_fd(&process->pipes[i]);
+    return error;
+  }
+
+#if defined(__linux__) && defined(SYS_pidfd_open)
+  // lets the pump sleep in poll until the child exits, rather than
+  // checking on it with a timer. Needs Linux 5.3.
+  process->pidfd = (int)syscall(SYS_pidfd_open, process->pid, 0);
+  if (process->pidfd >= 0)
+    fcntl(process->pidfd, F_SETFD, FD_CLOEXEC);
+#endif
+  return 0;
+}
+
+// writes to a pipe whose reader may have gone without taking SIGPIPE.
+static ssize_t pipe_write(int fd, const void *data, size_t length) {
+  sigset_t pipe_set, previous;
+  sigemptyset(&pipe_set);
+  sigaddset(&pipe_set, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &pipe_set, &previous);
+
+  ssize_t written = write(fd, data, length);
+  int error = errno;
+
+  if (written < 0 && error == EPIPE && !sigismember(&previous, SIGPIPE)) {
+    sigset_t pending;
+    sigpending(&pending);
+    if (sigismember(&pending, SIGPIPE)) {
+      int signal_number;
+      sigwait(&pipe_set, &signal_number);
+    }
+  }
+  pthread_sigmask(SIG_SETMASK, &previous, NULL);
+  errno = error;
+  return written;
+}
+
+static void capture_append_read(process_t *process, int which) {
+  process_capture_t *capture = &process->captured[which];
+  while (process->pipes[which] >= 0) {
+    if (!capture_reserve(capture))
+      return;
+    ssize_t got = read(process->pipes[which], capture->data + capture->length,
+                       capture->capacity - capture->length);
+    if (got > 0) {
+      capture->length += (size_t)got;
+      continue;
+    }
+    if (got < 0 && errno == EINTR)
+      continue;
+    if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return;
+    close_fd(&process->pipes[which]);
+  }
+}
+
+static void input_write(process_t *process) {
+  while (process->input_written < process->input_length) {
+    ssize_t written = pipe_write(process->pipes[0],
+                                 process->input + process->input_written,
+                                 process->input_length - process->input_written);
+    if (written > 0) {
+      process->input_written += (size_t)written;
+      continue;
+    }
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return;
+    // the child closed its stdin, so the rest of the input is dropped
+    process->input_written = process->input_length;
+    close_fd(&process->pipes[0]);
+  }
+}
+
+int process_pump(process_t **processes, size_t count, int timeout_ms) {
+  struct pollfd *fds = malloc((count * 3 + 1) * sizeof(struct pollfd));
+  process_t **owners = malloc((count * 3 + 1) * sizeof(process_t *));
+  int *streams = malloc((count * 3 + 1) * sizeof(int));
+  if (!fds || !owners || !streams) {
+    free(fds);
+    free(owners);
+    free(streams);
+    return -1;
+  }
+
+  size_t n = 0;
+  bool unwatched = false;
+  for (size_t i = 0; i < count; i++) {
+    // a child reaped by poll() may still have output left in its pipes
+    process_t *process = processes[i];
+    size_t first = n;
+
+    if (process->pipes[0] >= 0 &&
+        process->input_written < process->input_length) {
+      fds[n] = (struct pollfd){process->pipes[0], POLLOUT, 0};
+      owners[n] = process, streams[n++] = 0;
+    }
+    for (int which = 1; which <= 2; which++) {
+      if (process->pipes[which] >= 0) {
+        fds[n] = (struct pollfd){process->pipes[which], POLLIN, 0};
+        owners[n] = process, streams[n++] = which;
+      }
+    }
+
+    if (n == first && !process->exited) {
+      // nothing left to move, only the exit to wait for
+      if (process->pidfd >= 0) {
+        fds[n] = (struct pollfd){process->pidfd, POLLIN, 0};
+        owners[n] = process, streams[n++] = 3;
+      } else {
+        unwatched = true;
+      }
+    }
+  }
+
+  // children without a pidfd are checked on every few milliseconds
+  if (unwatched && (timeout_ms < 0 || timeout_ms > 5))
+    timeout_ms = 5;
+  // everything has exited and drained, so there is nothing to wait for
+  if (n == 0 && !unwatched) {
+    free(fds);
+    free(owners);
+    free(streams);
+    return 0;
+  }
+
+  int ready = poll(fds, (nfds_t)n, timeout_ms);
+  int result = 0;
+  if (ready < 0) {
+    result = errno == EINTR ? 0 : -1;
+  } else {
+    for (size_t i = 0; i < n && ready > 0; i++) {
+      if (!fds[i].revents)
+        continue;
+      ready--;
+      if (streams[i] == 0)
+        input_write(owners[i]);
+      else if (streams[i] < 3)
+        capture_append_read(owners[i], streams[i]);
+    }
+  }
+
+  free(fds);
+  free(owners);
+  free(streams);
+  return result;
+}
+
+bool process_reap(process_t *process, bool block) {
+  if (process->exited)
+    return true;
+
+  int status;
+  pid_t got;
+  do {
+    got = waitpid(process->pid, &status, block ? 0 : WNOHANG);
+  } while (got < 0 && errno == EINTR);
+
+  if (got == 0)
+    return false;
+
+  process->exited = true;
+  if (got < 0)
+    process->exit_code = -1;
+  else if (WIFEXITED(status))
+    process->exit_code = WEXITSTATUS(status);
+  else if (WIFSIGNALED(status))
+    process->exit_code = -WTERMSIG(status);
+  else
+    process->exit_code = -1;
+  close_fd(&process->pidfd);
+  return true;
+}
+
+long process_read(process_t *process, int which, char *out, size_t size) {
+  while (process->pipes[which] >= 0) {
+    ssize_t got = read(process->pipes[which], out, size);
+    if (got > 0)
+      return (long)got;
+    if (got < 0 && errno == EINTR)
+      continue;
+    if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return -1;
+    close_fd(&process->pipes[which]);
+  }
+  return 0;
+}
+
+void process_close_stream(process_t *process, int which) {
+  close_fd(&process->pipes[which]);
+}
+
+void process_release(process_t *process) {
+  for (int i = 0; i < 3; i++) {
+    close_fd(&process->pipes[i]);
+    free(process->captured[i].data);
+    process->captured[i] = (process_capture_t){NULL, 0, 0};
+  }
+  if (process->pid > 0)
+    process_reap(process, false);
+  close_fd(&process->pidfd);
+}
+
+#else
+
+const char *process_error_text(int error) {
+  static __thread char text[256];
+  if (!FormatMessageA(FORMAT_MESSAGE_FROM_SYSTEM |
+                          FORMAT_MESSAGE_IGNORE_INSERTS,
+                      NULL, (DWORD)error, 0, text, sizeof(text), NULL))
+    snprintf(text, sizeof(text), "error %d", error);
+  return text;
+}
+
+static void close_handle(HANDLE *handle) {
+  if (*handle) {
+    CloseHandle(*handle);
+    *handle = NULL;
+  }
+}
+
+// a NUL separated block of env over the parent's environment, as
+// CreateProcess wants it.
+static char *environment_block(char **env) {
+  char *strings = GetEnvironmentStringsA();
+  if (!strings)
+    return NULL;
+
+  size_t count = 0;
+  for (char *p = strings; *p; p += strlen(p) + 1)
+    count++;
+  char **parent = malloc((count + 1) * sizeof(char *));
+  if (!parent) {
+    FreeEnvironmentStringsA(strings);
+    return NULL;
+  }
+  count = 0;
+  for (char *p = strings; *p; p += strlen(p) + 1) {
+    // entries such as "=C:=C:\" are per drive directories, not variables
+    if (*p != '=')
+      parent[count++] = p;
+  }
+  parent[count] = NULL;
+
+  char **merged = merge_environment(parent, env);
+  char *block = NULL;
+  if (merged) {
+    size_t length = 1;
+    for (size_t i = 0; merged[i]; i++)
+      length += strlen(merged[i]) + 1;
+    block = malloc(length);
+    if (block) {
+      char *p = block;
+      for (size_t i = 0; merged[i]; i++) {
+        size_t entry = strlen(merged[i]) + 1;
+        memcpy(p, merged[i], entry);
+        p += entry;
+      }
+      *p = '\0';
+    }
+  }
+
+  free(merged);
+  free(parent);
+  FreeEnvironmentStringsA(strings);
+  return block;
+}
+
+int process_spawn(process_t *process, char **args, process_stream_t streams[3],
+                  char **env, const char *cwd) {
+  SECURITY_ATTRIBUTES inherit = {sizeof(inherit), NULL, TRUE};
+  static const DWORD standard[3] = {STD_INPUT_HANDLE, STD_OUTPUT_HANDLE,
+                                    STD_ERROR_HANDLE};
+  HANDLE child_handles[3];
+  HANDLE owned[3] = {NULL, NULL, NULL};
+  int error = 0;
+
+  for (int i = 0; i < 3; i++)
+    process->pipes[i] = NULL;
+  process->handle = NULL;
+
+  for (int i = 0; i < 3 && !error; i++) {
+    switch (streams[i].kind) {
+    case PROCESS_FILE:
+      fflush(streams[i].file);
+      child_handles[i] = (HANDLE)_get_osfhandle(fileno(streams[i].file));
+      break;
+    case PROCESS_DEVNULL:
+      owned[i] = CreateFileA("NUL", GENERIC_READ | GENERIC_WRITE,
+                             FILE_SHARE_READ | FILE_SHARE_WRITE, &inherit,
+                             OPEN_EXISTING, 0, NULL);
+      if (owned[i] == INVALID_HANDLE_VALUE) {
+        owned[i] = NULL;
+        error = (int)GetLastError();
+      }
+      child_handles[i] = owned[i];
+      break;
+    case PROCESS_PIPE: {
+      HANDLE read_end, write_end;
+      if (!CreatePipe(&read_end, &write_end, &inherit, 0)) {
+        error = (int)GetLastError();
+        break;
+      }
+      process->pipes[i] = i == 0 ? write_end : read_end;
+      owned[i] = i == 0 ? read_end : write_end;
+      child_handles[i] = owned[i];
+      SetHandleInformation(process->pipes[i], HANDLE_FLAG_INHERIT, 0);
+      if (i == 0) {
+        // so the pump can offer input without stalling on a full pipe
+        DWORD mode = PIPE_READMODE_BYTE | PIPE_NOWAIT;
+        SetNamedPipeHandleState(write_end, &mode, NULL, NULL);
+      }
+      break;
+    }
+    case PROCESS_STDOUT:
+      child_handles[i] = child_handles[1];
+      break;
+    default:
+      child_handles[i] = GetStdHandle(standard[i]);
+      break;
+    }
+  }
+
+  char *block = NULL;
+  if (!error && env) {
+    block = environment_block(env);
+    if (!block)
+      error = ERROR_NOT_ENOUGH_MEMORY;
+  }
+
+  if (!error) {
+    STARTUPINFOA si;
+    PROCESS_INFORMATION pi;
+    memset(&si, 0, sizeof(si));
+    memset(&pi, 0, sizeof(pi));
+    si.cb = sizeof(si);
+    si.dwFlags |= STARTF_USESTDHANDLES;
+    si.hStdInput = child_handles[0];
+    si.hStdOutput = child_handles[1];
+    si.hStdError = child_handles[2];
+
+    // Windows wants a single command line, not argv[]
+    size_t cmd_len = 0;
+    for (size_t i = 0; args[i]; i++)
+      cmd_len += strlen(args[i]) + 3;
+    char *cmdline = malloc(cmd_len + 1);
+    if (!cmdline) {
+      error = ERROR_NOT_ENOUGH_MEMORY;
+    } else {
+      cmdline[0] = '\0';
+      for (size_t i = 0; args[i]; i++) {
+        strcat(cmdline, "\"");
+        strcat(cmdline, args[i]);
+        strcat(cmdline, "\" ");
+      }
+
+      if (CreateProcessA(NULL, cmdline, NULL, NULL, TRUE, 0, block, cwd, &si,
+                         &pi)) {
+        CloseHandle(pi.hThread);
+        process->handle = pi.hProcess;
+        process->pid = pi.dwProcessId;
+      } else {
+        error = (int)GetLastError();
+      }
+      free(cmdline);
+    }
+  }
+
+  free(block);
+  for (int i = 0; i < 3; i++)
+    close_handle(&owned[i]);
+  if (error) {
+    for (int i = 0; i < 3; i++)
+      close_handle(&process->pipes[i]);
+  }
+  return error;
+}
+
+static void capture_append_read(process_t *process, int which) {
+  process_capture_t *capture = &process->captured[which];
+  while (process->pipes[which]) {
+    DWORD available = 0;
+    if (!PeekNamedPipe(process->pipes[which], NULL, 0, NULL, &available,
+                       NULL)) {
+      close_handle(&process->pipes[which]);
+      return;
+    }
+    if (available == 0 || !capture_reserve(capture))
+      return;
+    DWORD want = (DWORD)(capture->capacity - capture->length);
+    if (want > available)
+      want = available;
+    DWORD got = 0;
+    if (!ReadFile(process->pipes[which], capture->data + capture->length, want,
+                  &got, NULL)) {
+      close_handle(&process->pipes[which]);
+      return;
+    }
+    capture->length += got;
+  }
+}
+
+static bool input_write(process_t *process) {
+  bool moved = false;
+  while (process->input_written < process->input_length) {
+    size_t left = process->input_length - process->input_written;
+    DWORD written = 0;
+    if (!WriteFile(process->pipes[0], process->input + process->input_written,
+                   left > 65536 ? 65536 : (DWORD)left, &written, NULL)) {
+      // the child closed its stdin, so the rest of the input is dropped
+      process->input_written = process->input_length;
+      close_handle(&process->pipes[0]);
+      return true;
+    }
+    if (written == 0)
+      return moved;
+    process->input_written += written;
+    moved = true;
+  }
+  return moved;
+}
+
+int process_pump(process_t **processes, size_t count, int timeout_ms) {
+  // anonymous pipes can't be waited on, so they are checked in turn with
+  // short sleeps in between.
+  int64_t deadline = timeout_ms < 0 ? -1 : process_now_ms() + timeout_ms;
+  while (true) {
+    bool moved = false;
+    HANDLE exits[MAXIMUM_WAIT_OBJECTS];
+    DWORD exit_count = 0;
+    bool piped = false;
+
+    for (size_t i = 0; i < count; i++) {
+      // a child reaped by poll() may still have output left in its pipes
+      process_t *process = processes[i];
+      if (process->pipes[0] &&
+          process->input_written < process->input_length) {
+        moved |= input_write(process);
+        piped = true;
+      }
+      for (int which = 1; which <= 2; which++) {
+        if (!process->pipes[which])
+          continue;
+        size_t before = process->captured[which].length;
+        capture_append_read(process, which);
+        moved |= process->captured[which].length != before ||
+                 !process->pipes[which];
+        piped |= process->pipes[which] != NULL;
+      }
+      if (!process->exited && !process->pipes[1] && !process->pipes[2] &&
+          exit_count < MAXIMUM_WAIT_OBJECTS)
+        exits[exit_count++] = process->handle;
+    }
+    // everything has exited and drained, so there is nothing to wait for
+    if (moved || (!piped && exit_count == 0))
+      return 0;
+
+    int64_t remaining = deadline < 0 ? INT32_MAX : deadline - process_now_ms();
+    if (remaining <= 0)
+      return 0;
+    DWORD wait_ms = piped ? 1 : (DWORD)remaining;
+    if (exit_count > 0) {
+      if (WaitForMultipleObjects(exit_count, exits, FALSE, wait_ms) !=
+          WAIT_TIMEOUT)
+        return 0;
+    } else {
+      Sleep(wait_ms);
+    }
+  }
+}
+
+bool process_reap(process_t *process, bool block) {
+  if (process->exited)
+    return true;
+  if (WaitForSingleObject(process->handle, block ? INFINITE : 0) !=
+      WAIT_OBJECT_0)
+    return false;
+
+  DWORD code;
+  process->exit_code =
+      GetExitCodeProcess(process->handle, &code) ? (int)code : -1;
+  process->exited = true;
+  close_handle(&process->handle);
+  return true;
+}
+
+long process_read(process_t *process, int which, char *out, size_t size) {
+  if (!process->pipes[which])
+    return 0;
+  DWORD available = 0;
+  if (!PeekNamedPipe(process->pipes[which], NULL, 0, NULL, &available, NULL)) {
+    close_handle(&process->pipes[which]);
+    return 0;
+  }
+  if (available == 0)
+    return -1;
+  DWORD got = 0;
+  if (!ReadFile(process->pipes[which], out,
+                (DWORD)(size < available ? size : available), &got, NULL)) {
+    close_handle(&process->pipes[which]);
+    return 0;
+  }
+  return (long)got;
+}
+
+void process_close_stream(process_t *process, int which) {
+  close_handle(&process->pipes[which]);
+}
+
+void process_release(process_t *process) {
+  for (int i = 0; i < 3; i++) {
+    close_handle(&process->pipes[i]);
+    free(process->captured[i].data);
+    process->captured[i] = (process_capture_t){NULL, 0, 0};
+  }
+  if (process->handle && !process_reap(process, false))
+    close_handle(&process->handle);
+}
+
+#endif
@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText: 2026 William Bell
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#endif
+
+// What one of a child's standard streams is connected to.
+typedef enum {
+  PROCESS_INHERIT, // the parent's own stream
+  PROCESS_FILE,    // an open FILE
+  PROCESS_PIPE,    // a pipe the parent reads (or, for stdin, writes)
+  PROCESS_DEVNULL, // the null device
+  PROCESS_STDOUT   // stderr only: wherever stdout goes
+} process_stream_kind_t;
+
+typedef struct process_stream {
+  process_stream_kind_t kind;
+  FILE *file; // PROCESS_FILE only
+} process_stream_t;
+
+// output read off a pipe and not yet handed to the caller
+typedef struct process_capture {
+  char *data;
+  size_t length;
+  size_t capacity;
+} process_capture_t;
+
+typedef struct process {
+#ifdef _WIN32
+  HANDLE handle;
+  DWORD pid;
+  HANDLE pipes[3]; // parent ends of piped streams, NULL otherwise
+#else
+  pid_t pid;
+  int pipes[3]; // parent ends of piped streams, -1 otherwise
+  int pidfd;    // readable once the child exits, -1 where unsupported
+#endif
+  // [1] stdout and [2] stderr; [0] is unused
+  process_capture_t captured[3];
+
+  // bytes still to be written to the stdin pipe while pumping
+  const char *input;
+  size_t input_length;
+  size_t input_written;
+
+  bool exited;
+  int exit_code; // negated signal number if the child was killed
+} process_t;
+
+// process_spawn: starts args[0], searched for on PATH, with the given
+// streams. env is NULL to inherit the parent's environment, or a NULL
+// terminated list of "NAME=value" entries set on top of it. cwd may be NULL.
+// Returns 0, or an error code for process_error_text.
+int process_spawn(process_t *process, char **args, process_stream_t streams[3],
+                  char **env, const char *cwd);
+
+// process_error_text: describes an error code from process_spawn.
+const char *process_error_text(int error);
+
+// process_pump: moves data through the pipes of count processes, waiting up to
+// timeout_ms (-1 for no limit) for any of them to be ready. Output is
+// appended to captured and pending input is written. Returns -1 on error.
+int process_pump(process_t **processes, size_t count, int timeout_ms);
+
+// process_reap: whether the child has exited, collecting its exit code if
+// so. Only waits for it when block is set.
+bool process_reap(process_t *process, bool block);
+
+// process_done: whether both output pipes have been drained and the child
+// has exited.
+bool process_done(process_t *process);
+
+// process_wait_any: pumps until one of the processes is done and returns its
+// index, or -1 if timeout_ms (-1 for no limit) passes first, or -2 on error.
+int process_wait_any(process_t **processes, size_t count, int timeout_ms);
+
+// process_read: reads what is waiting on pipe which (1 or 2) into out without
+// blocking. Returns the bytes read, 0 at end of stream, -1 if nothing is
+// waiting yet.
+long process_read(process_t *process, int which, char *out, size_t size);
+
+// process_close_stream: closes the parent end of pipe which.
+void process_close_stream(process_t *process, int which);
+
+// process_release: closes every pipe and frees the captures. A child that
+// has already exited is reaped; one that hasn't is left running.
+void process_release(process_t *process);
@@ -0,0 +1,240 @@
+// SPDX-FileCopyrightText: 2026 William Bell
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+// Tasks and their results hold Argon objects while only C code points at
+// them, so, like the thread arguments in main.c, they are allocated with
+// api->malloc (uncollectable) and freed once both the worker and the Future
+// are done with them.
+
+#include "executor.h"
+#include <stdlib.h>
+
+struct executor {
+  ArgonNativeAPI *api;
+  mt_mutex_t *mutex;
+  mt_cond_t *work;     /* workers wait here for tasks */
+  mt_cond_t *finished; /* executor_task_wait callers wait here */
+  executor_task_t *head;
+  executor_task_t *tail;
+  int idle;    /* workers waiting on work */
+  int waiters; /* threads waiting on finished */
+  bool shutdown;
+  bool stopped; /* the workers have been joined or detached */
+  int worker_count;
+  mt_thread_t *threads;
+  /* one for the Argon object, one per worker and one per live task */
+  atomic_int refs;
+};
+
+static void executor_destroy(executor_t *executor) {
+  if (executor->finished)
+    mt_cond_destroy(executor->finished);
+  if (executor->work)
+    mt_cond_destroy(executor->work);
+  if (executor->mutex)
+    mt_mutex_destroy(executor->mutex);
+  free(executor->threads);
+  free(executor);
+}
+
+static void executor_unref(executor_t *executor) {
+  if (atomic_fetch_sub(&executor->refs, 1) == 1)
+    executor_destroy(executor);
+}
+
+void executor_task_release(executor_task_t *task) {
+  if (atomic_fetch_sub(&task->refs, 1) != 1)
+    return;
+  executor_t *executor = task->executor;
+  executor->api->free(task);
+  executor_unref(executor);
+}
+
+static void *executor_worker(void *arg) {
+  executor_t *executor = arg;
+  ArgonNativeAPI *api = executor->api;
+
+  // registered once for the worker's whole life rather than per task
+  api->register_thread();
+  ArgonObject *registers = NULL;
+  ArgonState *state = api->new_state(&registers);
+
+  mt_mutex_lock(executor->mutex);
+  while (true) {
+    while (!executor->head && !executor->shutdown) {
+      executor->idle++;
+      mt_cond_wait(executor->work, executor->mutex, -1);
+      executor->idle--;
+    }
+
+    // queued tasks still run after shutdown; the worker leaves once the
+    // queue is empty
+    executor_task_t *task = executor->head;
+    if (!task)
+      break;
+    executor->head = task->next;
+    if (!executor->head)
+      executor->tail = NULL;
+    mt_mutex_unlock(executor->mutex);
+
+    task->result =
+        api->call(task->fn, task->argc, task->args, NULL, task->err, state);
+    task->failed = api->is_error(task->err);
+
+    mt_mutex_lock(executor->mutex);
+    atomic_store(&task->done, 1);
+    if (executor->waiters)
+      mt_cond_broadcast(executor->finished);
+    mt_mutex_unlock(executor->mutex);
+
+    executor_task_release(task);
+    mt_mutex_lock(executor->mutex);
+  }
+  mt_mutex_unlock(executor->mutex);
+
+  api->unregister_thread();
+  executor_unref(executor);
+  return NULL;
+}
+
+executor_t *executor_create(ArgonNativeAPI *api, int workers) {
+  executor_t *executor = calloc(1, sizeof(*executor));
+  if (!executor)
+    return NULL;
+
+  executor->api = api;
+  executor->mutex = mt_mutex_create();
+  executor->work = mt_cond_create();
+  executor->finished = mt_cond_create();
+  executor->threads = calloc((size_t)workers, sizeof(mt_thread_t));
+  if (!executor->mutex || !executor->work || !executor->finished ||
+      !executor->threads) {
+    executor_destroy(executor);
+    return NULL;
+  }
+
+  atomic_init(&executor->refs, 1);
+  for (int i = 0; i < workers; i++) {
+    atomic_fetch_add(&executor->refs, 1);
+    if (mt_thread_start(&executor->threads[i], executor_worker, executor) !=
+        0) {
+      atomic_fetch_sub(&executor->refs, 1);
+      break;
+    }
+    executor->worker_count++;
+  }
+
+  if (executor->worker_count == 0) {
+    executor_destroy(executor);
+    return NULL;
+  }
+  return executor;
+}
+
+int executor_submit(executor_t *executor, ArgonObject *fn, ArgonObject **args,
+                    size_t argc, size_t count, executor_task_t **tasks,
+                    ArgonError *err) {
+  ArgonNativeAPI *api = executor->api;
+
+  // everything is allocated before taking the lock, which is then held
+  // once for the whole batch
+  for (size_t i = 0; i < count; i++) {
+    executor_task_t *task =
+        api->malloc(sizeof(executor_task_t) + argc * sizeof(ArgonObject *));
+    if (!task) {
+      while (i > 0)
+        api->free(tasks[--i]);
+      return -1;
+    }
+    task->fn = fn;
+    task->result = api->ARGON_NULL;
+    task->err_object = api->create_err_object();
+    task->err = api->err_object_to_err(task->err_object, err);
+    task->executor = executor;
+    task->next = NULL;
+    atomic_init(&task->done, 0);
+    task->failed = false;
+    atomic_init(&task->refs, 2);
+    task->argc = argc;
+    for (size_t j = 0; j < argc; j++)
+      task->args[j] = args[i * argc + j];
+    if (i > 0)
+      tasks[i - 1]->next = task;
+    tasks[i] = task;
+  }
+  if (count == 0)
+    return 0;
+
+  mt_mutex_lock(executor->mutex);
+  if (executor->shutdown) {
+    mt_mutex_unlock(executor->mutex);
+    for (size_t i = 0; i < count; i++)
+      api->free(tasks[i]);
+    return -1;
+  }
+
+  atomic_fetch_add(&executor->refs, (int)count);
+  if (executor->tail)
+    executor->tail->next = tasks[0];
+  else
+    executor->head = tasks[0];
+  executor->tail = tasks[count - 1];
+
+  // wake as many idle workers as there is work for
+  if (count >= (size_t)executor->idle) {
+    mt_cond_broadcast(executor->work);
+  } else {
+    for (size_t i = 0; i < count; i++)
+      mt_cond_signal(executor->work);
+  }
+  mt_mutex_unlock(executor->mutex);
+  return 0;
+}
+
+bool executor_task_wait(executor_task_t *task, int64_t timeout_ms) {
+  if (atomic_load(&task->done))
+    return true;
+
+  executor_t *executor = task->executor;
+  int64_t deadline = timeout_ms < 0 ? -1 : mt_now_ms() + timeout_ms;
+
+  mt_mutex_lock(executor->mutex);
+  executor->waiters++;
+  while (!atomic_load(&task->done)) {
+    int64_t remaining = -1;
+    if (deadline >= 0) {
+      remaining = deadline - mt_now_ms();
+      if (remaining <= 0)
+        break;
+    }
+    mt_cond_wait(executor->finished, executor->mutex, remaining);
+  }
+  executor->waiters--;
+  mt_mutex_unlock(executor->mutex);
+
+  return atomic_load(&task->done);
+}
+
+void executor_shutdown(executor_t *executor, bool wait) {
+  mt_mutex_lock(executor->mutex);
+  bool first = !executor->stopped;
+  executor->shutdown = true;
+  executor->stopped = true;
+  mt_cond_broadcast(executor->work);
+  mt_mutex_unlock(executor->mutex);
+
+  if (!first)
+    return;
+  for (int i = 0; i < executor->worker_count; i++) {
+    if (wait)
+      mt_thread_join(&executor->threads[i]);
+    else
+      mt_thread_detach(&executor->threads[i]);
+  }
+}
+
+void executor_release(executor_t *executor) {
+  executor_shutdown(executor, false);
+  executor_unref(executor);
+}
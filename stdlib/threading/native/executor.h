@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2026 William Bell
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef THREADING_EXECUTOR_H
+#define THREADING_EXECUTOR_H
+
+#include "Argon.h"
+#include "thread.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* =========================
+   Executor: a fixed set of worker threads that stay registered with the GC
+   and run queued calls, each call's outcome kept in its task for a Future.
+   ========================= */
+
+typedef struct executor executor_t;
+
+typedef struct executor_task {
+  ArgonObject *fn;
+  ArgonObject *result;
+  ArgonObject *err_object; /* an Err_object the call reports into */
+  ArgonError *err;
+  executor_t *executor;
+  struct executor_task *next;
+  atomic_int done;
+  bool failed;
+  /* one for the queue/worker and one for the Future */
+  atomic_int refs;
+  size_t argc;
+  ArgonObject *args[];
+} executor_task_t;
+
+/* NULL if the threads couldn't be started */
+executor_t *executor_create(ArgonNativeAPI *api, int workers);
+
+/* Allocates count tasks calling fn, each with argc arguments taken in turn
+   from args (so task i gets args[i * argc ...]), and queues them together.
+   Fills tasks and returns 0, or -1 if the executor is shut down or out of
+   memory. */
+int executor_submit(executor_t *executor, ArgonObject *fn, ArgonObject **args,
+                    size_t argc, size_t count, executor_task_t **tasks,
+                    ArgonError *err);
+
+/* Waits for a task, timeout_ms < 0 meaning forever. Returns whether it
+   finished. */
+bool executor_task_wait(executor_task_t *task, int64_t timeout_ms);
+
+/* Drops a reference to a task from executor_submit */
+void executor_task_release(executor_task_t *task);
+
+/* Stops taking tasks. Workers finish what is queued, then exit; with wait
+   set this returns once they have. Later calls do nothing. */
+void executor_shutdown(executor_t *executor, bool wait);
+
+/* Drops the caller's reference, shutting down without waiting first */
+void executor_release(executor_t *executor);
+
+#endif
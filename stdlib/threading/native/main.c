@@ -30,6 +30,7 @@
 // fully understand the interaction between threads, atomic state, and the GC.
 
 #include "Argon.h"
+#include "executor.h"
 #include "thread.h"
 #include <stdatomic.h>
 #include <stdio.h>
@@ -194,10 +195,653 @@ ARGON_FUNCTION(Get_thread_id, {
   return api->i64_to_argon(mt_thread_current_id());
 })
 
+/* =========================
+   Synchronisation primitives
+
+   Each is an external buffer over the native object, which is destroyed
+   once the buffer is collected.
+   ========================= */
+
+static ArgonNativeAPI *module_api;
+
+static void *native_object(ArgonNativeAPI *api, ArgonObject *object,
+                           ArgonError *err) {
+  struct buffer buf = api->argon_buffer_to_buffer(object, err);
+  if (api->is_error(err))
+    return NULL;
+  return buf.data;
+}
+
+static ArgonObject *wrap_native(ArgonNativeAPI *api, void *object, size_t size,
+                                void (*release)(void *data, size_t size),
+                                const char *what, ArgonError *err) {
+  if (!object)
+    return api->throw_argon_error(err, api->RuntimeError, "Failed to create %s",
+                                  what);
+  return api->create_argon_buffer_external(object, size, release);
+}
+
+/* a timeout in seconds, or null for none, as milliseconds (-1 for none) */
+static int64_t timeout_ms(ArgonNativeAPI *api, ArgonObject *timeout,
+                          ArgonError *err) {
+  if (timeout == api->ARGON_NULL)
+    return -1;
+  double seconds = api->argon_to_double(timeout, err);
+  if (seconds <= 0)
+    return 0;
+  return (int64_t)(seconds * 1000);
+}
+
+static void release_mutex(void *data, size_t size) {
+  (void)size;
+  mt_mutex_destroy(data);
+}
+
+static void release_rwlock(void *data, size_t size) {
+  (void)size;
+  mt_rwlock_destroy(data);
+}
+
+static void release_cond(void *data, size_t size) {
+  (void)size;
+  mt_cond_destroy(data);
+}
+
+static void release_sem(void *data, size_t size) {
+  (void)size;
+  mt_sem_destroy(data);
+}
+
+static void release_barrier(void *data, size_t size) {
+  (void)size;
+  mt_barrier_destroy(data);
+}
+
+ARGON_FUNCTION(Mutex_create, {
+  if (api->fix_to_arg_size(0, argc, err))
+    return api->ARGON_NULL;
+  return wrap_native(api, mt_mutex_create(), sizeof(mt_mutex_t), release_mutex,
+                     "mutex", err);
+})
+
+ARGON_FUNCTION(Mutex_lock, {
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+  mt_mutex_t *m = native_object(api, argv[0], err);
+  if (!m)
+    return api->ARGON_NULL;
+  if (mt_mutex_held(m))
+    return api->throw_argon_error(err, api->RuntimeError,
+                                  "Mutex is already held by this thread");
+  mt_mutex_lock(m);
+  return api->ARGON_NULL;
+})
+
+ARGON_FUNCTION(Mutex_try_lock, {
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+  mt_mutex_t *m = native_object(api, argv[0], err);
+  if (!m)
+    return api->ARGON_NULL;
+  return mt_mutex_trylock(m) ? api->ARGON_TRUE : api->ARGON_FALSE;
+})
+
+ARGON_FUNCTION(Mutex_unlock, {
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+  mt_mutex_t *m = native_object(api, argv[0], err);
+  if (m && mt_mutex_unlock(m) != 0)
+    return api->throw_argon_error(err, api->RuntimeError,
+                                  "Mutex is not held by this thread");
+  return api->ARGON_NULL;
+})
+
+ARGON_FUNCTION(RWLock_create, {
+  if (api->fix_to_arg_size(0, argc, err))
+    return api->ARGON_NULL;
+  return wrap_native(api, mt_rwlock_create(), sizeof(mt_rwlock_t),
+                     release_rwlock, "read/write lock", err);
+})
+
+/* RWLock_lock(lock, write) */
+ARGON_FUNCTION(RWLock_lock, {
+  if (api->fix_to_arg_size(2, argc, err))
+    return api->ARGON_NULL;
+  mt_rwlock_t *l = native_object(api, argv[0], err);
+  if (!l)
+    return api->ARGON_NULL;
+  if (mt_rwlock_write_held(l))
+    return api->throw_argon_error(
+        err, api->RuntimeError,
+        "RWLock is already held for writing by this thread");
+  if (argv[1] == api->ARGON_TRUE)
+    mt_rwlock_write_lock(l);
+  else
+    mt_rwlock_read_lock(l);
+  return api->ARGON_NULL;
+})
+
+/* RWLock_unlock(lock, write) */
+ARGON_FUNCTION(RWLock_unlock, {
+  if (api->fix_to_arg_size(2, argc, err))
+    return api->ARGON_NULL;
+  mt_rwlock_t *l = native_object(api, argv[0], err);
+  if (!l)
+    return api->ARGON_NULL;
+  if (argv[1] == api->ARGON_TRUE) {
+    if (mt_rwlock_write_unlock(l) != 0)
+      return api->throw_argon_error(
+          err, api->RuntimeError,
+          "RWLock is not held for writing by this thread");
+  } else if (mt_rwlock_read_unlock(l) != 0) {
+    return api->throw_argon_error(err, api->RuntimeError,
+                                  "RWLock is not held for reading");
+  }
+  return api->ARGON_NULL;
+})
+
+ARGON_FUNCTION(Condition_create, {
+  if (api->fix_to_arg_size(0, argc, err))
+    return api->ARGON_NULL;
+  return wrap_native(api, mt_cond_create(), sizeof(mt_cond_t), release_cond,
+                     "condition", err);
+})
+
+/* Condition_wait(condition, mutex, timeout) -> false if it timed out */
+ARGON_FUNCTION(Condition_wait, {
+  if (api->fix_to_arg_size(3, argc, err))
+    return api->ARGON_NULL;
+  mt_cond_t *c = native_object(api, argv[0], err);
+  mt_mutex_t *m = c ? native_object(api, argv[1], err) : NULL;
+  int64_t ms = m ? timeout_ms(api, argv[2], err) : 0;
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  if (!mt_mutex_held(m))
+    return api->throw_argon_error(err, api->RuntimeError,
+                                  "Mutex is not held by this thread");
+  return mt_cond_wait(c, m, ms) ? api->ARGON_FALSE : api->ARGON_TRUE;
+})
+
+/* Condition_notify(condition, all) */
+ARGON_FUNCTION(Condition_notify, {
+  if (api->fix_to_arg_size(2, argc, err))
+    return api->ARGON_NULL;
+  mt_cond_t *c = native_object(api, argv[0], err);
+  if (!c)
+    return api->ARGON_NULL;
+  if (argv[1] == api->ARGON_TRUE)
+    mt_cond_broadcast(c);
+  else
+    mt_cond_signal(c);
+  return api->ARGON_NULL;
+})
+
+ARGON_FUNCTION(Semaphore_create, {
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+  int64_t count = api->argon_to_i64(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  if (count < 0)
+    return api->throw_argon_error(err, api->RuntimeError,
+                                  "Semaphore count can't be negative");
+  return wrap_native(api, mt_sem_create(count), sizeof(void *), release_sem,
+                     "semaphore", err);
+})
+
+/* Semaphore_acquire(semaphore, timeout) -> false if it timed out */
+ARGON_FUNCTION(Semaphore_acquire, {
+  if (api->fix_to_arg_size(2, argc, err))
+    return api->ARGON_NULL;
+  mt_sem_t *s = native_object(api, argv[0], err);
+  int64_t ms = s ? timeout_ms(api, argv[1], err) : 0;
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  return mt_sem_acquire(s, ms) ? api->ARGON_TRUE : api->ARGON_FALSE;
+})
+
+/* Semaphore_release(semaphore, n) */
+ARGON_FUNCTION(Semaphore_release, {
+  if (api->fix_to_arg_size(2, argc, err))
+    return api->ARGON_NULL;
+  mt_sem_t *s = native_object(api, argv[0], err);
+  int64_t n = s ? api->argon_to_i64(argv[1], err) : 0;
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  if (n < 1)
+    return api->throw_argon_error(err, api->RuntimeError,
+                                  "Semaphore must be released at least once");
+  mt_sem_release(s, n);
+  return api->ARGON_NULL;
+})
+
+ARGON_FUNCTION(Semaphore_value, {
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+  mt_sem_t *s = native_object(api, argv[0], err);
+  if (!s)
+    return api->ARGON_NULL;
+  return api->i64_to_argon(mt_sem_value(s));
+})
+
+ARGON_FUNCTION(Barrier_create, {
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+  int64_t parties = api->argon_to_i64(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  if (parties < 1)
+    return api->throw_argon_error(err, api->RuntimeError,
+                                  "Barrier needs at least one party");
+  return wrap_native(api, mt_barrier_create(parties), sizeof(void *),
+                     release_barrier, "barrier", err);
+})
+
+ARGON_FUNCTION(Barrier_wait, {
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+  mt_barrier_t *b = native_object(api, argv[0], err);
+  if (!b)
+    return api->ARGON_NULL;
+  return api->i64_to_argon(mt_barrier_wait(b));
+})
+
+/* =========================
+   Atomic integers, kept in an ordinary GC buffer since there is nothing
+   to release
+   ========================= */
+
+static atomic_int_fast64_t *atomic_object(ArgonNativeAPI *api,
+                                          ArgonObject *object,
+                                          ArgonError *err) {
+  struct buffer buf = api->argon_buffer_to_buffer(object, err);
+  if (api->is_error(err))
+    return NULL;
+  if (buf.size != sizeof(atomic_int_fast64_t)) {
+    api->throw_argon_error(err, api->TypeError, "Invalid Atomic object");
+    return NULL;
+  }
+  return buf.data;
+}
+
+ARGON_FUNCTION(Atomic_create, {
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+  int64_t value = api->argon_to_i64(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  ArgonObject *object = api->create_argon_buffer(sizeof(atomic_int_fast64_t));
+  atomic_int_fast64_t *a = atomic_object(api, object, err);
+  if (!a)
+    return api->ARGON_NULL;
+  atomic_init(a, value);
+  return object;
+})
+
+ARGON_FUNCTION(Atomic_load, {
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+  atomic_int_fast64_t *a = atomic_object(api, argv[0], err);
+  if (!a)
+    return api->ARGON_NULL;
+  return api->i64_to_argon(atomic_load(a));
+})
+
+ARGON_FUNCTION(Atomic_store, {
+  if (api->fix_to_arg_size(2, argc, err))
+    return api->ARGON_NULL;
+  atomic_int_fast64_t *a = atomic_object(api, argv[0], err);
+  int64_t value = a ? api->argon_to_i64(argv[1], err) : 0;
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  atomic_store(a, value);
+  return api->ARGON_NULL;
+})
+
+/* Atomic_add(atomic, n) -> the value after adding */
+ARGON_FUNCTION(Atomic_add, {
+  if (api->fix_to_arg_size(2, argc, err))
+    return api->ARGON_NULL;
+  atomic_int_fast64_t *a = atomic_object(api, argv[0], err);
+  int64_t n = a ? api->argon_to_i64(argv[1], err) : 0;
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  return api->i64_to_argon(atomic_fetch_add(a, n) + n);
+})
+
+/* Atomic_exchange(atomic, value) -> the value before */
+ARGON_FUNCTION(Atomic_exchange, {
+  if (api->fix_to_arg_size(2, argc, err))
+    return api->ARGON_NULL;
+  atomic_int_fast64_t *a = atomic_object(api, argv[0], err);
+  int64_t value = a ? api->argon_to_i64(argv[1], err) : 0;
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  return api->i64_to_argon(atomic_exchange(a, value));
+})
+
+/* Atomic_compare_exchange(atomic, expected, value) -> whether it swapped */
+ARGON_FUNCTION(Atomic_compare_exchange, {
+  if (api->fix_to_arg_size(3, argc, err))
+    return api->ARGON_NULL;
+  atomic_int_fast64_t *a = atomic_object(api, argv[0], err);
+  int_fast64_t expected = a ? api->argon_to_i64(argv[1], err) : 0;
+  int64_t value = a ? api->argon_to_i64(argv[2], err) : 0;
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  return atomic_compare_exchange_strong(a, &expected, value) ? api->ARGON_TRUE
+                                                             : api->ARGON_FALSE;
+})
+
+/* =========================
+   Thread local storage for Local
+
+   Each thread's dictionary sits in an uncollectable cell so the GC can see
+   it while only a TLS slot points at it. When a thread exits its cell goes
+   on a spare list for the next thread rather than being freed, since the
+   exiting thread has already left the GC.
+
+   A collected Local can't free its struct, mutex or cells: a thread that
+   started exiting before the key went may still be about to use them. They
+   go on a free list for the next Local instead, so what is kept is bounded
+   by the most Locals (and threads using each) alive at once.
+   ========================= */
+
+struct local_cell {
+  ArgonObject *values;
+  struct local *owner;
+  int64_t thread;           /* the thread using it, or 0 when spare */
+  struct local_cell *next;  /* every cell of the owner */
+  struct local_cell *spare; /* the next cell free for reuse */
+};
+
+struct local {
+  mt_tls_t *key;
+  mt_mutex_t *mutex;
+  struct local_cell *cells;
+  struct local_cell *spares;
+  struct local *next_free;
+};
+
+static mt_mutex_t *free_locals_mutex;
+static struct local *free_locals;
+
+/* runs on the exiting thread, so a cell handed to another thread since (its
+   Local collected and reused) is left alone */
+static void MT_TLS_CALLBACK local_thread_exit(void *value) {
+  struct local_cell *cell = value;
+  struct local *local = cell->owner;
+  mt_mutex_lock(local->mutex);
+  if (cell->thread == mt_thread_current_id()) {
+    cell->values = NULL;
+    cell->thread = 0;
+    cell->spare = local->spares;
+    local->spares = cell;
+  }
+  mt_mutex_unlock(local->mutex);
+}
+
+static void release_local(void *data, size_t size) {
+  (void)size;
+  struct local *local = data;
+
+  /* may run local_thread_exit itself on Windows, hence not holding the
+     mutex */
+  mt_tls_destroy(local->key);
+  local->key = NULL;
+
+  mt_mutex_lock(local->mutex);
+  local->spares = NULL;
+  for (struct local_cell *cell = local->cells; cell; cell = cell->next) {
+    cell->values = NULL;
+    cell->thread = 0;
+    cell->spare = local->spares;
+    local->spares = cell;
+  }
+  mt_mutex_unlock(local->mutex);
+
+  mt_mutex_lock(free_locals_mutex);
+  local->next_free = free_locals;
+  free_locals = local;
+  mt_mutex_unlock(free_locals_mutex);
+}
+
+ARGON_FUNCTION(Local_create, {
+  if (api->fix_to_arg_size(0, argc, err))
+    return api->ARGON_NULL;
+
+  mt_mutex_lock(free_locals_mutex);
+  struct local *local = free_locals;
+  if (local)
+    free_locals = local->next_free;
+  mt_mutex_unlock(free_locals_mutex);
+
+  if (!local) {
+    local = calloc(1, sizeof(*local));
+    if (local) {
+      local->mutex = mt_mutex_create();
+      if (!local->mutex) {
+        free(local);
+        local = NULL;
+      }
+    }
+  }
+  if (local) {
+    local->key = mt_tls_create(local_thread_exit);
+    if (!local->key) {
+      mt_mutex_lock(free_locals_mutex);
+      local->next_free = free_locals;
+      free_locals = local;
+      mt_mutex_unlock(free_locals_mutex);
+      local = NULL;
+    }
+  }
+  return wrap_native(api, local, sizeof(*local), release_local,
+                     "thread local storage", err);
+})
+
+/* Local_values(local) -> the calling thread's dictionary */
+ARGON_FUNCTION(Local_values, {
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+
+  struct local *local = native_object(api, argv[0], err);
+  if (!local)
+    return api->ARGON_NULL;
+
+  struct local_cell *cell = mt_tls_get(local->key);
+  if (cell)
+    return cell->values;
+
+  mt_mutex_lock(local->mutex);
+  cell = local->spares;
+  if (cell) {
+    local->spares = cell->spare;
+  } else {
+    cell = api->malloc(sizeof(*cell));
+    if (cell) {
+      cell->owner = local;
+      cell->next = local->cells;
+      local->cells = cell;
+    }
+  }
+  if (cell)
+    cell->thread = mt_thread_current_id();
+  mt_mutex_unlock(local->mutex);
+
+  if (!cell)
+    return api->throw_argon_error(err, api->RuntimeError, "out of memory");
+
+  cell->values = api->hashmap_to_dictionary(api->create_hashmap());
+  mt_tls_set(local->key, cell);
+  return cell->values;
+})
+
+/* =========================
+   Executor and futures
+   ========================= */
+
+static void release_executor(void *data, size_t size) {
+  (void)size;
+  executor_release(data);
+}
+
+static void release_future(void *data, size_t size) {
+  (void)size;
+  executor_task_release(data);
+}
+
+/* Executor_create(workers), workers <= 0 meaning one per processor */
+ARGON_FUNCTION(Executor_create, {
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+  int64_t workers = api->argon_to_i64(argv[0], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+  if (workers <= 0)
+    workers = mt_cpu_count();
+  if (workers > 1024)
+    workers = 1024;
+  return wrap_native(api, executor_create(api, (int)workers), sizeof(void *),
+                     release_executor, "executor", err);
+})
+
+/* Executor_submit(executor, fn, args) -> a future */
+ARGON_FUNCTION(Executor_submit, {
+  if (api->fix_to_arg_size(3, argc, err))
+    return api->ARGON_NULL;
+  executor_t *executor = native_object(api, argv[0], err);
+  if (!executor)
+    return api->ARGON_NULL;
+  struct array args = api->argon_to_array(argv[2], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  executor_task_t *task;
+  if (executor_submit(executor, argv[1], args.items, args.size, 1, &task,
+                      err) != 0)
+    return api->throw_argon_error(
+        err, api->RuntimeError,
+        "Executor is shut down or out of memory");
+  return api->create_argon_buffer_external(task, sizeof(executor_task_t),
+                                           release_future);
+})
+
+/* Executor_map(executor, fn, items) -> a future per item, queued as one
+   batch */
+ARGON_FUNCTION(Executor_map, {
+  if (api->fix_to_arg_size(3, argc, err))
+    return api->ARGON_NULL;
+  executor_t *executor = native_object(api, argv[0], err);
+  if (!executor)
+    return api->ARGON_NULL;
+  struct array items = api->argon_to_array(argv[2], err);
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  size_t count = items.size ? items.size : 1;
+  executor_task_t **tasks = malloc(count * sizeof(executor_task_t *));
+  ArgonObject **futures = api->malloc(count * sizeof(ArgonObject *));
+  if (!tasks || !futures) {
+    free(tasks);
+    if (futures)
+      api->free(futures);
+    return api->throw_argon_error(err, api->RuntimeError, "Out of memory");
+  }
+  if (executor_submit(executor, argv[1], items.items, 1, items.size, tasks,
+                      err) != 0) {
+    free(tasks);
+    api->free(futures);
+    return api->throw_argon_error(
+        err, api->RuntimeError, "Executor is shut down or out of memory");
+  }
+
+  for (size_t i = 0; i < items.size; i++)
+    futures[i] = api->create_argon_buffer_external(
+        tasks[i], sizeof(executor_task_t), release_future);
+  free(tasks);
+  ArgonObject *result = api->create_argon_array(futures, items.size);
+  api->free(futures);
+  return result;
+})
+
+/* Executor_shutdown(executor, wait) */
+ARGON_FUNCTION(Executor_shutdown, {
+  if (api->fix_to_arg_size(2, argc, err))
+    return api->ARGON_NULL;
+  executor_t *executor = native_object(api, argv[0], err);
+  if (executor)
+    executor_shutdown(executor, argv[1] == api->ARGON_TRUE);
+  return api->ARGON_NULL;
+})
+
+ARGON_FUNCTION(Future_done, {
+  if (api->fix_to_arg_size(1, argc, err))
+    return api->ARGON_NULL;
+  executor_task_t *task = native_object(api, argv[0], err);
+  if (!task)
+    return api->ARGON_NULL;
+  return atomic_load(&task->done) ? api->ARGON_TRUE : api->ARGON_FALSE;
+})
+
+/* Future_result(future, timeout, TimeoutError) -> what the call returned.
+   an error the call threw is thrown again here, as Join does for Thread. */
+ARGON_FUNCTION(Future_result, {
+  if (api->fix_to_arg_size(3, argc, err))
+    return api->ARGON_NULL;
+  executor_task_t *task = native_object(api, argv[0], err);
+  int64_t ms = task ? timeout_ms(api, argv[1], err) : 0;
+  if (api->is_error(err))
+    return api->ARGON_NULL;
+
+  if (!executor_task_wait(task, ms))
+    return api->throw_argon_error(err, argv[2],
+                                  "Future didn't finish in time");
+  if (task->failed) {
+    api->set_err(task->err_object, err);
+    return api->ARGON_NULL;
+  }
+  return task->result;
+})
+
 INIT_ARGON_MODULE({
   REGISTER_ARGON_FUNCTION(Thread)
   REGISTER_ARGON_FUNCTION(Join)
   REGISTER_ARGON_FUNCTION(Detach)
   REGISTER_ARGON_FUNCTION(Err_object)
   REGISTER_ARGON_FUNCTION(Get_thread_id)
+
+  module_api = api;
+  if (!free_locals_mutex)
+    free_locals_mutex = mt_mutex_create();
+  REGISTER_ARGON_FUNCTION(Mutex_create)
+  REGISTER_ARGON_FUNCTION(Mutex_lock)
+  REGISTER_ARGON_FUNCTION(Mutex_try_lock)
+  REGISTER_ARGON_FUNCTION(Mutex_unlock)
+  REGISTER_ARGON_FUNCTION(RWLock_create)
+  REGISTER_ARGON_FUNCTION(RWLock_lock)
+  REGISTER_ARGON_FUNCTION(RWLock_unlock)
+  REGISTER_ARGON_FUNCTION(Condition_create)
+  REGISTER_ARGON_FUNCTION(Condition_wait)
+  REGISTER_ARGON_FUNCTION(Condition_notify)
+  REGISTER_ARGON_FUNCTION(Semaphore_create)
+  REGISTER_ARGON_FUNCTION(Semaphore_acquire)
+  REGISTER_ARGON_FUNCTION(Semaphore_release)
+  REGISTER_ARGON_FUNCTION(Semaphore_value)
+  REGISTER_ARGON_FUNCTION(Barrier_create)
+  REGISTER_ARGON_FUNCTION(Barrier_wait)
+  REGISTER_ARGON_FUNCTION(Atomic_create)
+  REGISTER_ARGON_FUNCTION(Atomic_load)
+  REGISTER_ARGON_FUNCTION(Atomic_store)
+  REGISTER_ARGON_FUNCTION(Atomic_add)
+  REGISTER_ARGON_FUNCTION(Atomic_exchange)
+  REGISTER_ARGON_FUNCTION(Atomic_compare_exchange)
+  REGISTER_ARGON_FUNCTION(Local_create)
+  REGISTER_ARGON_FUNCTION(Local_values)
+  REGISTER_ARGON_FUNCTION(Executor_create)
+  REGISTER_ARGON_FUNCTION(Executor_submit)
+  REGISTER_ARGON_FUNCTION(Executor_map)
+  REGISTER_ARGON_FUNCTION(Executor_shutdown)
+  REGISTER_ARGON_FUNCTION(Future_done)
+  REGISTER_ARGON_FUNCTION(Future_result)
 })
\ No newline at end of file
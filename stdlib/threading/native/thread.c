@@ -6,6 +6,11 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#ifndef _WIN32
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#endif
 
 /* =========================
    Thread implementation
@@ -68,6 +73,17 @@ int64_t mt_thread_current_id(void) {
 #endif
 }
 
+int mt_cpu_count(void) {
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (int)count : 1;
+#endif
+}
+
 /* =========================
    Mutex
    ========================= */
@@ -91,14 +107,45 @@ void mt_mutex_lock(mt_mutex_t *m) {
 #else
   pthread_mutex_lock(&m->mutex);
 #endif
+  atomic_store_explicit(&m->owner, mt_thread_current_id(),
+                        memory_order_relaxed);
 }
 
-void mt_mutex_unlock(mt_mutex_t *m) {
+int mt_mutex_trylock(mt_mutex_t *m) {
+#ifdef _WIN32
+  if (!TryEnterCriticalSection(&m->cs))
+    return 0;
+  /* critical sections are recursive, pthread mutexes aren't */
+  if (mt_mutex_held(m)) {
+    LeaveCriticalSection(&m->cs);
+    return 0;
+  }
+#else
+  if (pthread_mutex_trylock(&m->mutex) != 0)
+    return 0;
+#endif
+  atomic_store_explicit(&m->owner, mt_thread_current_id(),
+                        memory_order_relaxed);
+  return 1;
+}
+
+/* only the holder ever stores its own id, so a relaxed load can't see the
+   calling thread's id unless it really holds the mutex */
+int mt_mutex_held(mt_mutex_t *m) {
+  return atomic_load_explicit(&m->owner, memory_order_relaxed) ==
+         mt_thread_current_id();
+}
+
+int mt_mutex_unlock(mt_mutex_t *m) {
+  if (!mt_mutex_held(m))
+    return -1;
+  atomic_store_explicit(&m->owner, 0, memory_order_relaxed);
 #ifdef _WIN32
   LeaveCriticalSection(&m->cs);
 #else
   pthread_mutex_unlock(&m->mutex);
 #endif
+  return 0;
 }
 
 void mt_mutex_destroy(mt_mutex_t *m) {
@@ -110,23 +157,333 @@ void mt_mutex_destroy(mt_mutex_t *m) {
   free(m);
 }
 
+/* =========================
+   Reader/writer lock
+   ========================= */
+
+mt_rwlock_t *mt_rwlock_create(void) {
+  mt_rwlock_t *l = calloc(1, sizeof(*l));
+  if (!l)
+    return NULL;
+
+#ifdef _WIN32
+  InitializeSRWLock(&l->lock);
+#else
+  if (pthread_rwlock_init(&l->lock, NULL) != 0) {
+    free(l);
+    return NULL;
+  }
+#endif
+  return l;
+}
+
+void mt_rwlock_read_lock(mt_rwlock_t *l) {
+#ifdef _WIN32
+  AcquireSRWLockShared(&l->lock);
+#else
+  pthread_rwlock_rdlock(&l->lock);
+#endif
+  atomic_fetch_add(&l->readers, 1);
+}
+
+/* readers aren't tracked per thread, so this only catches an unlock with no
+   reader at all */
+int mt_rwlock_read_unlock(mt_rwlock_t *l) {
+  long readers = atomic_load(&l->readers);
+  do {
+    if (readers <= 0)
+      return -1;
+  } while (!atomic_compare_exchange_weak(&l->readers, &readers, readers - 1));
+#ifdef _WIN32
+  ReleaseSRWLockShared(&l->lock);
+#else
+  pthread_rwlock_unlock(&l->lock);
+#endif
+  return 0;
+}
+
+void mt_rwlock_write_lock(mt_rwlock_t *l) {
+#ifdef _WIN32
+  AcquireSRWLockExclusive(&l->lock);
+#else
+  pthread_rwlock_wrlock(&l->lock);
+#endif
+  atomic_store_explicit(&l->writer, mt_thread_current_id(),
+                        memory_order_relaxed);
+}
+
+int mt_rwlock_write_held(mt_rwlock_t *l) {
+  return atomic_load_explicit(&l->writer, memory_order_relaxed) ==
+         mt_thread_current_id();
+}
+
+int mt_rwlock_write_unlock(mt_rwlock_t *l) {
+  if (!mt_rwlock_write_held(l))
+    return -1;
+  atomic_store_explicit(&l->writer, 0, memory_order_relaxed);
+#ifdef _WIN32
+  ReleaseSRWLockExclusive(&l->lock);
+#else
+  pthread_rwlock_unlock(&l->lock);
+#endif
+  return 0;
+}
+
+void mt_rwlock_destroy(mt_rwlock_t *l) {
+#ifndef _WIN32
+  /* SRW locks hold no resources */
+  pthread_rwlock_destroy(&l->lock);
+#endif
+  free(l);
+}
+
+/* =========================
+   Condition variable
+   ========================= */
+
+int64_t mt_now_ms(void) {
+#ifdef _WIN32
+  return (int64_t)GetTickCount64();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#endif
+}
+
+mt_cond_t *mt_cond_create(void) {
+  mt_cond_t *c = calloc(1, sizeof(*c));
+  if (!c)
+    return NULL;
+
+#ifdef _WIN32
+  InitializeConditionVariable(&c->cond);
+#else
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+#ifndef __APPLE__
+  /* timed waits measure against the monotonic clock, so moving the wall
+     clock doesn't stretch or cut them short */
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+#endif
+  int failed = pthread_cond_init(&c->cond, &attr);
+  pthread_condattr_destroy(&attr);
+  if (failed) {
+    free(c);
+    return NULL;
+  }
+#endif
+  return c;
+}
+
+static int cond_wait(mt_cond_t *c, mt_mutex_t *m, int64_t timeout_ms) {
+#ifdef _WIN32
+  DWORD wait = timeout_ms < 0            ? INFINITE
+               : timeout_ms >= INFINITE ? INFINITE - 1
+                                        : (DWORD)timeout_ms;
+  if (SleepConditionVariableCS(&c->cond, &m->cs, wait))
+    return 0;
+  return GetLastError() == ERROR_TIMEOUT ? 1 : 0;
+#else
+  if (timeout_ms < 0) {
+    pthread_cond_wait(&c->cond, &m->mutex);
+    return 0;
+  }
+
+  struct timespec ts;
+#ifdef __APPLE__
+  ts.tv_sec = (time_t)(timeout_ms / 1000);
+  ts.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+  return pthread_cond_timedwait_relative_np(&c->cond, &m->mutex, &ts) ==
+         ETIMEDOUT;
+#else
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  ts.tv_sec += (time_t)(timeout_ms / 1000);
+  ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+  if (ts.tv_nsec >= 1000000000L) {
+    ts.tv_sec++;
+    ts.tv_nsec -= 1000000000L;
+  }
+  return pthread_cond_timedwait(&c->cond, &m->mutex, &ts) == ETIMEDOUT;
+#endif
+#endif
+}
+
+/* the mutex is released while waiting, so other threads can take it and
+   record themselves as its holder */
+int mt_cond_wait(mt_cond_t *c, mt_mutex_t *m, int64_t timeout_ms) {
+  atomic_store_explicit(&m->owner, 0, memory_order_relaxed);
+  int timed_out = cond_wait(c, m, timeout_ms);
+  atomic_store_explicit(&m->owner, mt_thread_current_id(),
+                        memory_order_relaxed);
+  return timed_out;
+}
+
+void mt_cond_signal(mt_cond_t *c) {
+#ifdef _WIN32
+  WakeConditionVariable(&c->cond);
+#else
+  pthread_cond_signal(&c->cond);
+#endif
+}
+
+void mt_cond_broadcast(mt_cond_t *c) {
+#ifdef _WIN32
+  WakeAllConditionVariable(&c->cond);
+#else
+  pthread_cond_broadcast(&c->cond);
+#endif
+}
+
+void mt_cond_destroy(mt_cond_t *c) {
+#ifndef _WIN32
+  pthread_cond_destroy(&c->cond);
+#endif
+  free(c);
+}
+
+/* =========================
+   Semaphore
+   ========================= */
+
+struct mt_sem {
+  mt_mutex_t *mutex;
+  mt_cond_t *cond;
+  int64_t count;
+};
+
+mt_sem_t *mt_sem_create(int64_t count) {
+  mt_sem_t *s = calloc(1, sizeof(*s));
+  if (!s)
+    return NULL;
+  s->mutex = mt_mutex_create();
+  s->cond = mt_cond_create();
+  if (!s->mutex || !s->cond) {
+    if (s->mutex)
+      mt_mutex_destroy(s->mutex);
+    if (s->cond)
+      mt_cond_destroy(s->cond);
+    free(s);
+    return NULL;
+  }
+  s->count = count;
+  return s;
+}
+
+int mt_sem_acquire(mt_sem_t *s, int64_t timeout_ms) {
+  int64_t deadline = timeout_ms < 0 ? -1 : mt_now_ms() + timeout_ms;
+  mt_mutex_lock(s->mutex);
+  while (s->count <= 0) {
+    int64_t remaining = -1;
+    if (deadline >= 0) {
+      remaining = deadline - mt_now_ms();
+      if (remaining <= 0) {
+        mt_mutex_unlock(s->mutex);
+        return 0;
+      }
+    }
+    mt_cond_wait(s->cond, s->mutex, remaining);
+  }
+  s->count--;
+  mt_mutex_unlock(s->mutex);
+  return 1;
+}
+
+void mt_sem_release(mt_sem_t *s, int64_t n) {
+  mt_mutex_lock(s->mutex);
+  s->count += n;
+  if (n == 1)
+    mt_cond_signal(s->cond);
+  else
+    mt_cond_broadcast(s->cond);
+  mt_mutex_unlock(s->mutex);
+}
+
+int64_t mt_sem_value(mt_sem_t *s) {
+  mt_mutex_lock(s->mutex);
+  int64_t count = s->count;
+  mt_mutex_unlock(s->mutex);
+  return count;
+}
+
+void mt_sem_destroy(mt_sem_t *s) {
+  mt_cond_destroy(s->cond);
+  mt_mutex_destroy(s->mutex);
+  free(s);
+}
+
+/* =========================
+   Barrier
+   ========================= */
+
+struct mt_barrier {
+  mt_mutex_t *mutex;
+  mt_cond_t *cond;
+  int64_t parties;
+  int64_t waiting;
+  /* bumped each time the barrier opens, so a thread can tell a real release
+     from a spurious wakeup even if the next round has already started */
+  uint64_t generation;
+};
+
+mt_barrier_t *mt_barrier_create(int64_t parties) {
+  mt_barrier_t *b = calloc(1, sizeof(*b));
+  if (!b)
+    return NULL;
+  b->mutex = mt_mutex_create();
+  b->cond = mt_cond_create();
+  if (!b->mutex || !b->cond) {
+    if (b->mutex)
+      mt_mutex_destroy(b->mutex);
+    if (b->cond)
+      mt_cond_destroy(b->cond);
+    free(b);
+    return NULL;
+  }
+  b->parties = parties;
+  return b;
+}
+
+int64_t mt_barrier_wait(mt_barrier_t *b) {
+  mt_mutex_lock(b->mutex);
+  int64_t index = b->waiting++;
+  if (b->waiting == b->parties) {
+    b->waiting = 0;
+    b->generation++;
+    mt_cond_broadcast(b->cond);
+  } else {
+    uint64_t generation = b->generation;
+    while (generation == b->generation)
+      mt_cond_wait(b->cond, b->mutex, -1);
+  }
+  mt_mutex_unlock(b->mutex);
+  return index;
+}
+
+void mt_barrier_destroy(mt_barrier_t *b) {
+  mt_cond_destroy(b->cond);
+  mt_mutex_destroy(b->mutex);
+  free(b);
+}
+
 /* =========================
    TLS
    ========================= */
 
-mt_tls_t *mt_tls_create(void) {
+mt_tls_t *mt_tls_create(mt_tls_destructor destructor) {
   mt_tls_t *t = calloc(1, sizeof(*t));
   if (!t)
     return NULL;
 
 #ifdef _WIN32
-  t->key = TlsAlloc();
-  if (t->key == TLS_OUT_OF_INDEXES) {
+  /* fiber local storage, unlike TlsAlloc, runs a callback at thread exit */
+  t->key = FlsAlloc(destructor);
+  if (t->key == FLS_OUT_OF_INDEXES) {
     free(t);
     return NULL;
   }
 #else
-  if (pthread_key_create(&t->key, NULL) != 0) {
+  if (pthread_key_create(&t->key, destructor) != 0) {
     free(t);
     return NULL;
   }
@@ -136,7 +493,7 @@ mt_tls_t *mt_tls_create(void) {
 
 void mt_tls_set(mt_tls_t *t, void *value) {
 #ifdef _WIN32
-  TlsSetValue(t->key, value);
+  FlsSetValue(t->key, value);
 #else
   pthread_setspecific(t->key, value);
 #endif
@@ -144,7 +501,7 @@ void mt_tls_set(mt_tls_t *t, void *value) {
 
 void *mt_tls_get(mt_tls_t *t) {
 #ifdef _WIN32
-  return TlsGetValue(t->key);
+  return FlsGetValue(t->key);
 #else
   return pthread_getspecific(t->key);
 #endif
@@ -152,7 +509,7 @@ void *mt_tls_get(mt_tls_t *t) {
 
 void mt_tls_destroy(mt_tls_t *t) {
 #ifdef _WIN32
-  TlsFree(t->key);
+  FlsFree(t->key);
 #else
   pthread_key_delete(t->key);
 #endif
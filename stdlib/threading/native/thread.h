@@ -37,6 +37,7 @@ struct mt_mutex {
 #else
   pthread_mutex_t mutex;
 #endif
+  atomic_int_fast64_t owner; /* mt_thread_current_id of the holder, or 0 */
 };
 
 struct mt_tls {
@@ -47,12 +48,32 @@ struct mt_tls {
 #endif
 };
 
+struct mt_rwlock {
+#ifdef _WIN32
+  SRWLOCK lock;
+#else
+  pthread_rwlock_t lock;
+#endif
+  atomic_int_fast64_t writer; /* the thread holding it to write, or 0 */
+  atomic_long readers;
+};
+
+struct mt_cond {
+#ifdef _WIN32
+  CONDITION_VARIABLE cond;
+#else
+  pthread_cond_t cond;
+#endif
+};
+
 /* =========================
    Thread types
    ========================= */
 
 typedef struct mt_thread mt_thread_t;
 typedef struct mt_mutex mt_mutex_t;
+typedef struct mt_rwlock mt_rwlock_t;
+typedef struct mt_cond mt_cond_t;
 
 /* Opaque thread ID */
 typedef struct {
@@ -73,22 +94,92 @@ int mt_thread_detach(mt_thread_t *t);
 
 int64_t mt_thread_current_id(void);
 
+/* Processors online, at least 1 */
+int mt_cpu_count(void);
+
 /* =========================
    Mutex API
    ========================= */
 
 mt_mutex_t *mt_mutex_create(void);
 void mt_mutex_lock(mt_mutex_t *m);
-void mt_mutex_unlock(mt_mutex_t *m);
+/* Returns 1 if the mutex was taken, 0 if another thread holds it */
+int mt_mutex_trylock(mt_mutex_t *m);
+/* Returns 0, or -1 without touching the mutex if the calling thread doesn't
+   hold it */
+int mt_mutex_unlock(mt_mutex_t *m);
+/* Whether the calling thread holds the mutex */
+int mt_mutex_held(mt_mutex_t *m);
 void mt_mutex_destroy(mt_mutex_t *m);
 
+/* =========================
+   Reader/writer lock API
+   ========================= */
+
+mt_rwlock_t *mt_rwlock_create(void);
+void mt_rwlock_read_lock(mt_rwlock_t *l);
+/* The unlocks return 0, or -1 without touching the lock if it isn't held
+   that way (to write: by the calling thread) */
+int mt_rwlock_read_unlock(mt_rwlock_t *l);
+void mt_rwlock_write_lock(mt_rwlock_t *l);
+int mt_rwlock_write_unlock(mt_rwlock_t *l);
+/* Whether the calling thread holds the lock to write */
+int mt_rwlock_write_held(mt_rwlock_t *l);
+void mt_rwlock_destroy(mt_rwlock_t *l);
+
+/* =========================
+   Condition variable API
+   ========================= */
+
+mt_cond_t *mt_cond_create(void);
+/* timeout_ms < 0 waits forever. Returns 0 when woken, 1 on timeout.
+   Wakeups may be spurious, so callers recheck what they wait for. */
+int mt_cond_wait(mt_cond_t *c, mt_mutex_t *m, int64_t timeout_ms);
+void mt_cond_signal(mt_cond_t *c);
+void mt_cond_broadcast(mt_cond_t *c);
+void mt_cond_destroy(mt_cond_t *c);
+
+/* Monotonic milliseconds, for deadlines across repeated waits */
+int64_t mt_now_ms(void);
+
+/* =========================
+   Semaphore and barrier API
+   (built on a mutex and condition, so they behave the same everywhere)
+   ========================= */
+
+typedef struct mt_sem mt_sem_t;
+typedef struct mt_barrier mt_barrier_t;
+
+mt_sem_t *mt_sem_create(int64_t count);
+/* timeout_ms < 0 waits forever. Returns 1 if a unit was taken, 0 on timeout */
+int mt_sem_acquire(mt_sem_t *s, int64_t timeout_ms);
+void mt_sem_release(mt_sem_t *s, int64_t n);
+int64_t mt_sem_value(mt_sem_t *s);
+void mt_sem_destroy(mt_sem_t *s);
+
+mt_barrier_t *mt_barrier_create(int64_t parties);
+/* Blocks until parties threads are waiting. Returns this thread's arrival
+   index, 0 to parties - 1, so exactly one caller sees parties - 1 */
+int64_t mt_barrier_wait(mt_barrier_t *b);
+void mt_barrier_destroy(mt_barrier_t *b);
+
 /* =========================
    TLS (thread-local storage)
    ========================= */
 
 typedef struct mt_tls mt_tls_t;
 
-mt_tls_t *mt_tls_create(void);
+#ifdef _WIN32
+#define MT_TLS_CALLBACK WINAPI
+#else
+#define MT_TLS_CALLBACK
+#endif
+
+/* Called with a thread's non-NULL value when that thread exits */
+typedef void(MT_TLS_CALLBACK *mt_tls_destructor)(void *value);
+
+/* destructor may be NULL */
+mt_tls_t *mt_tls_create(mt_tls_destructor destructor);
 void mt_tls_set(mt_tls_t *tls, void *value);
 void *mt_tls_get(mt_tls_t *tls);
 void mt_tls_destroy(mt_tls_t *tls);